@@ -1,23 +1,46 @@
 #ifndef POINT_H
 #define POINT_H
+#include <cstdint>
+#include "distance_metric.hpp"
+
+// Representação das coordenadas, escolhida na compilação (make COORDS=...):
+//   padrão          double (8 bytes)
+//   POINT_FLOAT32   float (4 bytes), lido de volta arredondado ao centímetro. Exato para entradas com até 2 casas decimais
+//                   e |c| < 131072 (meio ulp do float abaixo de 0.005); erro <= 0.005 + |c|*2^-24 por coordenada nas demais
+//   POINT_FIXED32   inteiro de 32 bits em centímetros. Exato para entradas com até 2 casas decimais (erro <= 0.005
+//                   por coordenada nas demais) e |c| <= 21474836.47
+// O ponto é trivialmente copiável (cópia e atribuição implícitas), podendo ser movido em bloco com memcpy.
+// Nos dois modos compactos o ponto ocupa 8 bytes em vez de 16. As distâncias continuam calculadas em double a partir
+// das coordenadas armazenadas, então o erro de uma distância é limitado pelo erro das coordenadas (<= 2*sqrt(2) vezes o erro de uma coordenada)
+// Os limites acima são nas unidades da entrada: para a métrica haversine (graus), 0.005° chega a cerca de 556 m por
+// coordenada, então DistanceMetric::Use (e o -m haversine de main) recusa essa métrica nos modos compactos.
+#if defined(POINT_FIXED32)
+typedef int32_t coord_t;
+#elif defined(POINT_FLOAT32)
+typedef float coord_t;
+#else
+typedef double coord_t;
+#endif
 
 class Point2D {
     private:
         // Atributos: coordenadas
-        double x;
-        double y;
+        coord_t x;
+        coord_t y;
 
     public:
         // Construtores
         Point2D() : Point2D(0.0, 0.0) { };      // Construtor padrão: incializa as coordenadas zeradas
         Point2D(double x, double y);            // Construtor completo
-        Point2D(const Point2D& other);          // Construtor de cópia: usa as coordenadas do ponto passado
 
         // Operações/Métodos
-        void operator=(const Point2D& other);   // Sobrecarga de atribuição: copia as coordenadas desse ponto com base em um passado como referência
-        double Distance(Point2D& other);        // Retorna a distância entre esse ponto e outro
-        double GetX();                          // Retorna X
-        double GetY();                          // Retorna Y
+        double Distance(const Point2D& other) const;        // Retorna a distância entre esse ponto e outro, pela métrica ativa (DistanceMetric)
+        template<class Metric>
+        double DistanceWith(const Point2D& other) const {   // Retorna a distância entre esse ponto e outro pela métrica passada
+            return Metric::Distance(GetX(), GetY(), other.GetX(), other.GetY());
+        }
+        double GetX() const;                    // Retorna X
+        double GetY() const;                    // Retorna Y
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef BATCHGROUPER_H
+#define BATCHGROUPER_H
+#include <vector>
+#include "demand_group.hpp"
+
+struct GroupSearch;     // Estado da busca de uma thread de trabalho (batch_grouper.cpp)
+
+// Agrupamento em lote com janela deslizante (modo opcional do Manager)
+// As demandas são acumuladas enquanto couberem em uma janela de duração min(delta, atraso máximo) a partir da primeira;
+// quando a janela fecha, o agrupamento é resolvido para todas de uma vez:
+//   - um índice espacial (grade com lado alpha sobre as origens) gera os pares compatíveis por alpha e beta;
+//   - as componentes conexas desse grafo são independentes e resolvidas em paralelo pelas threads de trabalho;
+//   - em cada componente, a partir da demanda mais antiga ainda livre, uma busca limitada escolhe o grupo com mais
+//     demandas (menos veículos) e, no empate, a maior economia de distância, respeitando eta e lambda.
+// Nenhuma demanda espera mais que a duração da janela para ter seu grupo decidido.
+class BatchGrouper {
+    private:
+        // Parâmetros
+        int capacity;           // eta
+        double alpha;
+        double beta;
+        double lambda;
+        double window;          // Duração máxima da janela
+        int threads;            // Threads de trabalho
+
+        // Janela atual (em ordem de chegada; Solve a reorganiza por tempo)
+        std::vector<Demand> pending;
+
+        // Funções auxiliares
+        void BuildNeighbors(std::vector<std::vector<int> >& neighbors);     // Pares compatíveis por alpha e beta
+        void SolveComponent(const std::vector<int>& members, GroupSearch& search, std::vector<char>& assigned, std::vector<std::vector<int> >& groups);
+
+    public:
+        BatchGrouper(int eta, double delta, double alpha, double beta, double lambda, double max_delay, int threads);
+
+        bool Fits(Demand& demand);                                  // Se a demanda cabe na janela atual
+        void Add(Demand& demand);                                   // Acrescenta a demanda na janela
+        int PendingAmount();                                        // Demandas na janela
+        Demand& GetPending(int index);                              // Demanda da janela (depois de Solve, na ordem de tempo)
+        void Solve(std::vector<std::vector<int> >& groups);         // Resolve a janela: grupos (índices da janela, em ordem de tempo), ordenados pela primeira demanda
+        void Clear();                                               // Esvazia a janela
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef CLASSSCALER_H
+#define CLASSSCALER_H
+#include <vector>
+#include "event_scaler.hpp"
+
+const static int MAX_SERVICE_CLASSES = 1 << (63 - HANDLE_SLOT_BITS - HANDLE_GENERATION_BITS);  // Identificador local * k + classe cabe no EventHandle
+
+// Escalonador por classe de serviço: uma fila (EventScaler) por classe e um min-heap indexado das classes pela cabeça
+// da fila, na ordem (tempo, prioridade, classe) - no mesmo instante, a classe de menor valor de prioridade vai antes.
+// Recuperar ou agendar custa O(log n) na fila da classe mais O(log k) para reposicionar a classe no heap de classes.
+// Os identificadores são os da fila da classe intercalados: identificador local * k + classe. Com uma só classe, os
+// identificadores e a ordem dos eventos são exatamente os do EventScaler.
+class ClassScaler {
+    private:
+        std::vector<EventScaler*> queues;   // Fila de cada classe
+        std::vector<int> priorities;        // Prioridade de cada classe (menor vai antes no empate)
+        std::vector<double> heads;          // Tempo da cabeça de cada fila (cache de PeekTime)
+        std::vector<int> sizes;             // Eventos de cada fila (cache de GetSize)
+        int size;                           // Total de eventos agendados
+        std::vector<int> class_heap;        // Min-heap das classes com eventos, pela cabeça
+        std::vector<int> positions;         // Posição de cada classe no heap de classes (-1 se a fila está vazia)
+        Event nextevent;
+        TraceLog* trace;
+
+        // Funções auxiliares
+        bool Before(int a, int b);          // Ordem (tempo da cabeça, prioridade, classe)
+        void SwapClasses(int i, int j);
+        void SiftUp(int i);
+        void SiftDown(int i);
+        void Update(int service_class);     // Relê a cabeça da fila e reposiciona (insere ou retira) a classe no heap
+
+    public:
+        // Construtor e destrutor
+        ClassScaler();      // Uma classe, de prioridade 0
+        ~ClassScaler();
+
+        // Classes: somente com o escalonador vazio
+        int AddClass(int priority);                     // Acrescenta uma classe e retorna seu índice (até MAX_SERVICE_CLASSES)
+        void SetPriority(int service_class, int priority);
+        int GetClassAmount();
+
+        // Operações/Métodos (ver EventScaler)
+        EventHandle ScheduleEvent(int service_class, int id, double time, EventType type);
+        EventHandle ScheduleBatch(int service_class, Event* events, int amount);   // Retorna o identificador do primeiro evento (ver BatchHandle)
+        EventHandle BatchHandle(EventHandle first, int index);                      // Identificador do evento index de um lote
+        bool Cancel(EventHandle handle);
+        bool Reschedule(EventHandle handle, double time);
+        Event& GetNextEvent();      // Lança runtime_error se não houver eventos
+        int GetSize();
+        void Clear();
+        void SetTraceLog(TraceLog* trace);
+
+        // Controle de memória
+        int GetMemoryUsage();
+};
+
+#endif
@@ -4,33 +4,30 @@
 
 class Demand {
     private:
-        // Atributos gerais
-        int id;                 // Identificador
+        // Atributos gerais (campos de 4 bytes no fim, para evitar preenchimento)
         double time;            // Marcador de tempo de solicitação da demanda
         Point2D origin;         // Ponto de origem
         Point2D destination;    // Ponto de destino
-
-        // Controle de memória
-        int mem_usage;          // Quantidade de memória consumida pelo objeto
+        int id;                 // Identificador
+        int service_class;      // Classe de serviço (0: padrão; ver Manager::AddServiceClass)
 
     public:
-        // Construtores
+        // Construtores (cópia e atribuição implícitas: a demanda é trivialmente copiável)
         Demand() : Demand(-1, -1, 0.0, 0.0, 0.0, 0.0) { };                      // Demanda "nula" (por definição)
-        Demand(int id, double t, double ox, double oy, double dx, double dy);   // Construtor completo
-        Demand(const Demand& other);                                            // Construtor de cópia
+        Demand(int id, double t, double ox, double oy, double dx, double dy, int service_class = 0);   // Construtor completo
 
         // Getters para acesso aos atributos
-        int GetID();                                    // Retorna o id da demanda
-        double GetTime();                               // Retorna o tempo de solicitação
-        Point2D& GetOrigin();                           // Retorna referência para o ponto de origem
-        Point2D& GetDestination();                      // Retorna referência para o ponto de destino
-        double OriginDistance(Demand& other);           // Calcula distância entre origens desta demanda e outra demanda
-        double DestinationDistance(Demand& other);      // Calcula distância entre destinos desta demanda e outra demanda
-        double GetDistance();                           // Calcula a distância entre a origem e o destino desta demanda
-        void operator=(const Demand& other);            // Sobrecarga de atribuição: copia os atributos desta demanda com base em outra
+        int GetID() const;                                      // Retorna o id da demanda
+        int GetClass() const;                                   // Retorna a classe de serviço
+        double GetTime() const;                                 // Retorna o tempo de solicitação
+        const Point2D& GetOrigin() const;                       // Retorna referência para o ponto de origem
+        const Point2D& GetDestination() const;                  // Retorna referência para o ponto de destino
+        double OriginDistance(const Demand& other) const;       // Calcula distância entre origens desta demanda e outra demanda
+        double DestinationDistance(const Demand& other) const;  // Calcula distância entre destinos desta demanda e outra demanda
+        double GetDistance() const;                             // Calcula a distância entre a origem e o destino desta demanda
 
-        // Controle de memória
-        int GetMemoryUsage();           // Retorna a quantidade de memória usada pelo objeto
+        // Controle de memória: igual para toda demanda, não é guardado em cada objeto
+        static int GetMemoryUsage();    // Retorna a quantidade de memória usada por uma demanda
 };
 
 #endif
\ No newline at end of file
@@ -3,20 +3,40 @@
 #include <stdexcept>
 #include "demand.hpp"
 
+// Resultado da checagem de distâncias (alpha/beta) de uma demanda contra todo o grupo
+enum class DistanceCheck {
+    COMPATIBLE,             // Todas as origens e destinos dentro dos limites
+    ORIGIN_TOO_FAR,         // Alguma origem a mais de alpha
+    DESTINATION_TOO_FAR     // Algum destino a mais de beta
+};
+
 class DemandGroup {
-    private:
+    protected:
         // Atributos gerais
-        Demand* group;                  // Grupo de demandas em pilha no heap
+        Demand* group;                  // Grupo de demandas em pilha no heap (ou armazenamento embutido de FixedDemandGroup)
         int max_size;                   // Tamanho máximo do grupo
         int item_counter;               // Controle de tamanho do vetor
+        bool owns_group;                // Marca se o vetor foi alocado por este objeto
+        int stable;                     // Demandas iniciais não substituídas desde que FixedDemandGroup guardou as distâncias delas
+
+        // Caixas (min_x, min_y, max_x, max_y) das origens e dos destinos do grupo, mantidas a cada Insert/Remove/Clear
+        // Com métricas planas, CheckDistances decide pelas caixas em O(1) quando o item está perto de todas as demandas
+        // (canto mais distante dentro do limite) ou longe de alguma (extremo da caixa fora do limite)
+        double origin_box[4];
+        double destination_box[4];
+        void RecomputeBoxes();          // Refaz as caixas a partir das demandas atuais
+        bool CheckBoxes(Demand& item, double alpha, double beta, DistanceCheck& result);  // Decide pelas caixas, se possível (compartilhado com FixedDemandGroup)
         
         // Controle de memória
         int mem_usage;                  // Total de memória usada pelo objeto
 
+        // Construtor para armazenamento externo (usado pelas variantes de capacidade fixa)
+        DemandGroup(Demand* storage, int max_size);
+
     public:
         // Construtor e Destrutor
         DemandGroup(int max_size);
-        ~DemandGroup();
+        virtual ~DemandGroup();
 
         // Operações/Métodos
         int Insert(Demand& item);       // Retorna o índice ou -1 se estiver cheio
@@ -24,8 +44,15 @@ class DemandGroup {
         Demand* Get(int index);         // Retorna ponteiro para o item no índice passado
         int Size();                     // Retorna o tamanho da pilha
         bool IsFull();                  // Retorna se o grupo está cheio
+        int Capacity();                 // Retorna o tamanho máximo do grupo
         void Clear();                   // Limpa a pilha
 
+        // Critérios de compartilhamento (especializados em FixedDemandGroup)
+        virtual DistanceCheck CheckDistances(Demand& item, double alpha, double beta);     // Confere a distância entre origens e destinos do item e de cada demanda do grupo
+        virtual double Efficiency();                                                        // Eficiência da corrida que seria criada com o grupo atual (mesma conta de Ride)
+        virtual double SegmentDistance(int index);                                          // Comprimento do segmento index da corrida do grupo (coletas em ordem, depois entregas em ordem)
+        virtual double IndividualDistance();                                                // Soma das distâncias entre origem e destino de cada demanda
+
         // Controle de memória: detalhamento em demand_group.cpp
         int GetMemoryUsage();
 };
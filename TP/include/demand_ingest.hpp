@@ -0,0 +1,78 @@
+#ifndef DEMANDINGEST_H
+#define DEMANDINGEST_H
+#include <atomic>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include "simulation_manager.hpp"
+
+// Entrada concorrente de demandas: várias fontes (uma thread por fonte) enviam demandas ao mesmo Manager, que continua
+// sendo usado por uma única thread, a de despacho.
+//   - cada fonte tem a própria fila circular sem trava (um produtor, o despacho como consumidor), então as fontes não
+//     disputam nenhuma trava entre si;
+//   - cada fonte publica a sua marca d'água: o tempo da última demanda enviada (ou o passado em Advance, para uma
+//     fonte ociosa); as demandas de uma fonte devem chegar em ordem de tempo;
+//   - o despacho junta as filas em um buffer de reordenação (min-heap por tempo e id) e entrega ao Manager, em ordem,
+//     as demandas com tempo até a menor marca d'água das fontes abertas;
+//   - para limitar a espera por uma fonte atrasada, também são entregues as demandas max_lag mais antigas que a mais
+//     recente já recebida (max_lag < 0: sem limite). Uma demanda que chega com tempo anterior ao da última entregue é
+//     entregue na hora, fora de ordem, e contada como atrasada.
+class DemandIngest {
+    private:
+        // Fila e marca d'água de uma fonte (contadores em linhas de cache separadas)
+        struct Source {
+            std::vector<Demand> slots;                  // Capacidade potência de 2
+            uint64_t mask;
+            alignas(64) std::atomic<uint64_t> head;     // Demandas já retiradas pelo despacho
+            alignas(64) std::atomic<uint64_t> tail;     // Demandas já enviadas pela fonte
+            std::atomic<double> watermark;              // A fonte não enviará mais demandas antes deste tempo
+            std::atomic<bool> closed;
+        };
+
+        // Ordem do buffer de reordenação: (tempo, id)
+        struct Later {
+            bool operator()(const Demand& a, const Demand& b) const {
+                if(a.GetTime() != b.GetTime()) {
+                    return a.GetTime() > b.GetTime();
+                }
+                return a.GetID() > b.GetID();
+            }
+        };
+
+        Manager& manager;
+        double max_lag;
+        std::vector<Source*> sources;
+
+        // Estado do despacho (somente a thread de despacho)
+        std::priority_queue<Demand, std::vector<Demand>, Later> reorder;
+        double newest;                  // Maior tempo já recebido
+        double released;                // Tempo da última demanda entregue ao Manager
+        int late_demands;
+        int rejected_demands;           // Demandas recusadas pelo Manager (MakeDemand retornou -1)
+        std::thread dispatcher;
+        std::string error;              // Erro do Manager durante o despacho (vazio se não houve)
+
+        void Deliver(const Demand& demand);     // Entrega ao Manager (se não houve erro), contando as recusadas
+        bool Drain(Source& source);     // Move as demandas publicadas da fonte para o buffer; false se não havia nenhuma
+        void Run();                     // Laço da thread de despacho, até todas as fontes fecharem
+
+    public:
+        // Construtor e destrutor
+        DemandIngest(Manager& manager, int producers, double max_lag, size_t queue_capacity = 1 << 14);
+        ~DemandIngest();    // Aguarda o despacho (as fontes já devem ter sido fechadas)
+
+        // Fontes: cada índice de 0 a producers - 1 só pode ser usado por uma thread de cada vez
+        void Submit(int producer, const Demand& demand);    // Bloqueia enquanto a fila da fonte estiver cheia
+        void Advance(int producer, double time);            // A fonte não enviará demandas antes de time
+        void Close(int producer);                           // A fonte não enviará mais demandas
+
+        // Despacho
+        void Start();               // Inicia a thread de despacho
+        void Finish();              // Aguarda todas as fontes fecharem e o buffer esvaziar. Lança runtime_error se o Manager falhou
+        int GetLateDemands();       // Demandas entregues fora de ordem (válido depois de Finish)
+        int GetRejectedDemands();   // Demandas recusadas pelo Manager, por exemplo de classe desconhecida (válido depois de Finish)
+        int GetProducers();
+};
+
+#endif
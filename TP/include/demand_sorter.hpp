@@ -0,0 +1,64 @@
+#ifndef DEMANDSORTER_H
+#define DEMANDSORTER_H
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "demand.hpp"
+
+// Ordenação externa das demandas por (tempo, id), para entradas fora de ordem e maiores que a memória disponível
+// As demandas são acumuladas em um vetor de até memory_limit bytes; quando ele enche, é ordenado e gravado como uma
+// sequência (run) em um arquivo temporário no diretório passado (apagado ao fechar). No fim, as sequências são
+// intercaladas (k-way) por um min-heap das cabeças, lendo cada uma em blocos que dividem o mesmo limite de memória;
+// se houver sequências demais para blocos de tamanho razoável, elas são intercaladas antes em passadas intermediárias.
+// Entradas que já chegam em ordem e cabem na memória são devolvidas como estão, sem ordenar nem gravar nada.
+class DemandSorter {
+    private:
+        // Sequência gravada em disco e seu leitor em blocos
+        struct Run {
+            FILE* file;
+            long amount;                // Demandas na sequência
+            long consumed;              // Demandas já lidas do arquivo
+            std::vector<Demand> block;  // Bloco atual
+            size_t head;                // Próxima demanda do bloco
+        };
+
+        // Parâmetros
+        size_t memory_limit;            // Memória máxima (bytes) para o vetor de acumulação e para os blocos de leitura
+        std::string temp_dir;           // Diretório dos arquivos temporários
+
+        // Acumulação
+        std::vector<Demand> buffer;
+        size_t buffer_capacity;         // Demandas que cabem no limite de memória
+        bool in_order;                  // Se toda a entrada vista até agora está em ordem de (tempo, id)
+        bool has_last;
+        Demand last;                    // Última demanda recebida (para detectar a ordem)
+
+        // Intercalação
+        std::vector<Run> runs;
+        std::vector<int> heap;          // Min-heap de índices de runs pela demanda na cabeça
+        size_t block_size;              // Demandas por bloco de leitura na intercalação final
+        bool finished;
+        size_t position;                // Próxima demanda do vetor (quando não houve gravação em disco)
+
+        // Funções auxiliares
+        static bool Less(const Demand& a, const Demand& b);     // Ordem (tempo, id)
+        FILE* OpenTemp();                                       // Cria um arquivo temporário já desvinculado do diretório
+        void Spill();                                           // Ordena o vetor e o grava como uma nova sequência
+        void MergeRuns(size_t first, size_t amount);            // Intercala amount sequências a partir de first em uma nova
+        bool Fill(Run& run, size_t block_size);                 // Lê o próximo bloco da sequência; false se ela acabou
+        void HeapifyDown(size_t i);
+
+    public:
+        // Construtor e destrutor
+        DemandSorter(size_t memory_limit, const std::string& temp_dir);
+        ~DemandSorter();
+
+        // Operações/Métodos
+        void Add(const Demand& demand);     // Recebe uma demanda (em qualquer ordem)
+        void Finish();                      // Encerra a entrada e prepara a leitura ordenada
+        bool Next(Demand& demand);          // Próxima demanda em ordem de (tempo, id); false no fim
+        bool WasInOrder();                  // Se a entrada já estava em ordem
+        int GetRunAmount();                 // Sequências gravadas em disco
+};
+
+#endif
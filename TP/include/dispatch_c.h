@@ -0,0 +1,94 @@
+#ifndef DISPATCH_C_H
+#define DISPATCH_C_H
+
+/*
+ * Interface C estável para embutir o despachante em outro processo (bin/libdispatch.so)
+ * Fluxo: dispatch_create -> dispatch_submit (um lote por chamada, quantas vezes for preciso)
+ *        -> dispatch_poll ou dispatch_run (corridas concluídas, em ordem de fim) -> dispatch_destroy
+ * Com várias threads de ingestão: dispatch_ingest_start -> dispatch_ingest_submit/advance/close (uma thread por fonte)
+ *        -> dispatch_poll ou dispatch_run, que aguardam todas as fontes fecharem antes da primeira coleta
+ *        (dispatch_cancel e dispatch_delay também aguardam)
+ * Todas as funções que retornam int devolvem -1 em caso de erro; a mensagem fica em dispatch_last_error.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DISPATCH_ABI_VERSION 4
+
+/* Simulação opaca (Manager) */
+typedef struct DispatchManager DispatchManager;
+
+/* Corrida concluída */
+typedef struct {
+    int ride;               /* Índice da corrida (usado em dispatch_ride_stop) */
+    int stop_count;         /* Quantidade de paradas */
+    double start;           /* Tempo de início */
+    double end;             /* Tempo de fim */
+    double distance;        /* Distância total */
+    double efficiency;      /* Eficiência do compartilhamento */
+} DispatchRide;
+
+/* Chamada para cada corrida concluída em dispatch_run; o ponteiro só vale durante a chamada */
+typedef void (*DispatchRideCallback)(const DispatchRide* ride, void* user_data);
+
+/* Versão da interface com que a biblioteca foi compilada */
+int dispatch_abi_version(void);
+
+/* Cria a simulação com os parâmetros da entrada padrão (eta, gamma, delta, alpha, beta, lambda)
+ * demands: total de demandas, ou 0 se desconhecido (o último grupo é fechado na primeira coleta de corridas) */
+DispatchManager* dispatch_create(int eta, double gamma, double delta, double alpha, double beta, float lambda, int demands);
+void dispatch_destroy(DispatchManager* manager);
+
+/* Envia um lote de demandas em ordem de tempo, lidas diretamente dos vetores por coluna do chamador (não guardados depois da chamada)
+ * As demandas são aplicadas em ordem até a primeira recusada; retorna quantas foram aplicadas (amount se todas). Se o
+ * retorno for menor que amount, dispatch_last_error diz por quê e as demandas a partir da posição retornada não entraram
+ * (as anteriores continuam na simulação). -1 se o lote for inválido ou a simulação falhar (nesse caso, nada se sabe do
+ * lote). Só é permitido antes da primeira coleta de corridas */
+int dispatch_submit(DispatchManager* manager, int amount, const int* ids, const double* times,
+                    const double* origin_x, const double* origin_y, const double* destination_x, const double* destination_y);
+
+/* Avança a simulação e preenche até capacity corridas concluídas no vetor do chamador; retorna quantas (0 no fim) */
+int dispatch_poll(DispatchManager* manager, DispatchRide* buffer, int capacity);
+
+/* Executa a simulação até o fim chamando callback para cada corrida; retorna quantas corridas foram entregues */
+int dispatch_run(DispatchManager* manager, DispatchRideCallback callback, void* user_data);
+
+/* Parada index de uma corrida (coletas e depois entregas); qualquer ponteiro de saída pode ser NULL */
+int dispatch_ride_stop(DispatchManager* manager, int ride, int index, int* demand_id, double* x, double* y);
+
+/* Corridas ativas em algum instante de [from, to] (use from == to para um instante): preenche até capacity índices de
+ * corrida no vetor do chamador e retorna o total encontrado, que pode passar de capacity (com capacity 0 só conta)
+ * Disponível a partir da versão 2; o índice é construído na primeira consulta e vale até a simulação mudar */
+int dispatch_active_rides(DispatchManager* manager, double from, double to, int* rides, int capacity);
+
+/* Pico de corridas simultâneas e o primeiro tempo em que ocorre (time pode ser NULL); versão 2 */
+int dispatch_max_concurrent(DispatchManager* manager, double* time);
+
+/* Cancela a demanda demand_id no tempo time, se a corrida dela ainda não tiver começado; versão 3
+ * Pode ser chamada a qualquer momento antes de a simulação passar de time */
+int dispatch_cancel(DispatchManager* manager, int demand_id, double time);
+
+/* Atrasa em delay o restante da corrida ride no tempo time, se ela ainda não tiver terminado; versão 3
+ * Depois do início, só as paradas seguintes e o fim mudam. delay negativo é recusado (-1, ver dispatch_last_error) */
+int dispatch_delay(DispatchManager* manager, int ride, double time, double delay);
+
+/* Entrada concorrente (versão 4): producers fontes, cada uma usada por uma única thread de cada vez, enviam demandas em
+ * ordem de tempo; uma thread de despacho as entrega à simulação na ordem global de tempo, esperando no máximo max_lag
+ * por uma fonte atrasada (max_lag < 0: espera sempre). Substitui dispatch_submit até a primeira coleta de corridas.
+ * As funções das fontes não alteram dispatch_last_error (são chamadas por várias threads ao mesmo tempo) */
+int dispatch_ingest_start(DispatchManager* manager, int producers, double max_lag);
+int dispatch_ingest_submit(DispatchManager* manager, int producer, int amount, const int* ids, const double* times,
+                           const double* origin_x, const double* origin_y, const double* destination_x, const double* destination_y);
+int dispatch_ingest_advance(DispatchManager* manager, int producer, double time);   /* A fonte não enviará demandas antes de time */
+int dispatch_ingest_close(DispatchManager* manager, int producer);                  /* A fonte não enviará mais demandas */
+
+/* Mensagem do último erro (string vazia se não houve), válida até a próxima chamada na mesma simulação */
+const char* dispatch_last_error(DispatchManager* manager);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef DISTANCEMETRIC_H
+#define DISTANCEMETRIC_H
+#include <cmath>
+
+class RoadOracle;
+
+// Métricas de distância (políticas): cada uma expõe Distance(ax, ay, bx, by)
+// Point2D::DistanceWith<Métrica> usa a política diretamente; Point2D::Distance usa a métrica ativa (ver DistanceMetric)
+
+// Euclidiana: distância em linha reta (padrão)
+struct EuclideanMetric {
+    static double Distance(double ax, double ay, double bx, double by) {
+        double dx = ax - bx;
+        double dy = ay - by;
+        return sqrt((dx*dx) + (dy*dy));
+    }
+};
+
+// Manhattan: soma dos deslocamentos em cada eixo (malha viária retangular)
+struct ManhattanMetric {
+    static double Distance(double ax, double ay, double bx, double by) {
+        return fabs(ax - bx) + fabs(ay - by);
+    }
+};
+
+// Haversine: distância em metros sobre a esfera terrestre, com X como longitude e Y como latitude em graus
+struct HaversineMetric {
+    static double Distance(double ax, double ay, double bx, double by) {
+        const double earth_radius = 6371008.8;
+        const double to_rad = M_PI/180.0;
+        double dlat = (by - ay)*to_rad;
+        double dlon = (bx - ax)*to_rad;
+        double h = sin(dlat/2)*sin(dlat/2) + cos(ay*to_rad)*cos(by*to_rad)*sin(dlon/2)*sin(dlon/2);
+        return 2*earth_radius*asin(sqrt(h < 1 ? h : 1));
+    }
+};
+
+enum class MetricType {
+    EUCLIDEAN,
+    MANHATTAN,
+    HAVERSINE,
+    ROAD        // Distância pela malha viária (RoadOracle)
+};
+
+// Seleção da métrica ativa (global ao processo, definida antes da simulação)
+class DistanceMetric {
+    private:
+        static MetricType active;       // Métrica usada por Point2D::Distance
+        static RoadOracle* oracle;      // Oráculo usado pela métrica ROAD
+
+    public:
+        static void Use(MetricType type);               // Seleciona a métrica (ROAD exige um oráculo registrado)
+        static void UseRoadOracle(RoadOracle* oracle);  // Registra o oráculo e seleciona a métrica ROAD
+        static MetricType Active() { return active; }
+        static RoadOracle* Oracle() { return oracle; }
+        static bool IsPlanar();                         // Se a métrica ativa é limitada por caixas alinhadas aos eixos (euclidiana ou Manhattan)
+};
+
+#endif
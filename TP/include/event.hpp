@@ -3,33 +3,32 @@
 
 enum class EventType {
     RIDESTART,
-    RIDEEND
+    RIDEEND,
+    RIDESTOP,       // Chegada em uma parada intermediária (somente com o registro de paradas ativo)
+    DEMANDCANCEL,   // Cancelamento de uma demanda (id: índice do pedido de mudança no Manager)
+    RIDEDELAY       // Atraso de uma corrida (id: índice do pedido de mudança no Manager)
 };
 
+// Evento trivialmente copiável (16 bytes): o min-heap e as sequências do escalonador o movem com memcpy
 class Event {
     private:
         // Atributos
-        int id;             // Identificador do evento - referência à corrida associada (eventos da mesma corrida tem mesmo id)
         double time;        // Marcador de tempo do evento
-        EventType type;     // Tipo de evento (início ou fim de uma corrida)
-
-        // Controle de memória
-        int mem_usage;
+        int id;             // Identificador do evento - referência à corrida associada (eventos da mesma corrida tem mesmo id)
+        EventType type;     // Tipo de evento (início, fim ou parada de uma corrida)
 
     public:
-        // Construtores
+        // Construtores (cópia e atribuição implícitas)
         Event() : Event(-1, -1, EventType::RIDESTART) { };  // Constrturor padrão
         Event(int id, double time, EventType type);         // Construtor regular
-        Event(Event& other);                                // Construtor de cópia
 
         // Métodos
-        int GetID();                            // Retorna id
-        double GetTime();                       // Retorna tempo
-        EventType GetType();                    // Retorna tipo
-        void operator=(const Event& other);     // Sobrecarga de atribuição para cópias
+        int GetID() const;                      // Retorna id
+        double GetTime() const;                 // Retorna tempo
+        EventType GetType() const;              // Retorna tipo
 
-        // Controle de memória
-        int GetMemoryUsage();
+        // Controle de memória: igual para todo evento
+        static int GetMemoryUsage();
 };
 
-#endif
\ No newline at end of file
+#endif
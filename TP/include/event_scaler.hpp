@@ -1,37 +1,93 @@
 #ifndef EVENTSCALER_H
 #define EVENTSCALER_H
+#include <vector>
 #include "event.hpp"
 
-const static int MAX_HEAP_SIZE = 511;   // 8 níveis
+class TraceLog;
+
+const static int MAX_HEAP_SIZE = 511;   // Capacidade inicial do min-heap (8 níveis); dobra quando cheio
+const static int MIN_SORTED_RUN = 64;   // Tamanho mínimo de uma sequência ordenada para ser guardada à parte em ScheduleBatch
+
+// Identificador de um evento agendado, válido até o evento ser recuperado ou cancelado (ou até Clear)
+// Os eventos de um lote recebem identificadores consecutivos, na ordem do lote
+// Internamente é geração << HANDLE_SLOT_BITS | vaga: a vaga é reaproveitada depois que o evento sai, com a geração
+// seguinte, então um identificador antigo nunca alcança o evento que passou a ocupar a vaga
+typedef long long EventHandle;
+
+const static int HANDLE_SLOT_BITS = 32;         // Bits da vaga no identificador
+const static int HANDLE_GENERATION_BITS = 24;   // Bits da geração (a vaga é aposentada quando a geração se esgota)
 
 class EventScaler {
     private:
+        // Sequência ordenada recebida em lote: consumida da cabeça, sem passar pelo min-heap
+        struct SortedRun {
+            Event* events;
+            int head;
+            int size;
+            int first_slot;     // Vaga do primeiro evento (os demais seguem em ordem)
+        };
+
         // Atributos
-        Event minheap[511];
+        Event* minheap;
+        int capacity;
         Event nextevent;
         int size;
+        int* heap_slots;                // Vaga de cada evento do min-heap (mesma posição)
+        std::vector<int> positions;     // Posição de cada vaga no min-heap, IN_RUN ou GONE (posições só valem com tracking)
+        std::vector<int> generations;   // Geração atual de cada vaga
+        std::vector<int> free_slots;    // Vagas liberadas, reaproveitadas por ScheduleEvent
+        int fresh_generation;           // Geração das vagas novas (acima de todas as já usadas desde o último Clear)
+        bool tracking;                  // Posições do min-heap mantidas a cada troca (ligado no primeiro Cancel/Reschedule)
+        TraceLog* trace;    // Trace opcional de agendamentos e recuperações (nullptr se desativado)
+
+        // Sequências ordenadas: run_heap é um min-heap de índices de runs pelo tempo da cabeça
+        std::vector<SortedRun> runs;
+        std::vector<int> run_heap;
+        int run_events;     // Eventos ainda não consumidos nem cancelados nas sequências
 
         // Funções auxiliares
-        int GetAncestral(int i);        // Retorna o ancestral de um nó 
+        int GetAncestral(int i);        // Retorna o ancestral de um nó
         int GetLeftSuccessor(int i);    // Retorna o sucessor à esquerda de um nó
         int GetRightSuccessor(int i);   // Retorna o sucessor à direita de um nó
         void HeapifyDown(int i);        // Restaura a propriedade de min-heap a partir de um nó i para baixo
         void HeapifyUp(int i);          // Restaura a propriedade de min-heap a partir de um nó i para cima
+        void Swap(int i, int j);        // Troca dois nós do min-heap, junto com suas vagas
+        void RemoveAt(int i);           // Retira o nó i do min-heap
+        void Track();                   // Reconstrói as posições do min-heap e passa a mantê-las
+        void Grow(int needed);          // Garante capacidade para needed eventos no min-heap
+        double RunHead(int run);        // Tempo do próximo evento de uma sequência
+        void RunHeapifyDown(int i);     // Restaura o heap de sequências a partir de i
+        void AddRun(Event* events, int amount, int first_slot);     // Copia uma sequência ordenada e a insere no heap de sequências
+        void PopRunHead();              // Avança a cabeça da sequência mais adiantada (liberando-a se esgotar)
+        void ClearRuns();               // Libera todas as sequências
+        int AcquireSlot();              // Vaga para um evento avulso: uma liberada, se houver, ou uma nova
+        void ReleaseSlot(int slot);     // O evento da vaga saiu: a geração avança e a vaga volta para a lista livre
+        void Compact();                 // Sem eventos pendentes: descarta as vagas (as novas começam em uma geração acima)
+        int FindSlot(EventHandle handle);                           // Vaga de um identificador ainda pendente (-1 se não for)
+        EventHandle MakeHandle(int slot);                           // Identificador da vaga na geração atual
 
         // Controle de memória
         int mem_usage;
 
     public:
-        // Construtor
+        // Construtor e destrutor
         EventScaler();  // Inicia o min-heap e os atributos de acordo
+        ~EventScaler();
 
         // Operações/Métodos
-        void ScheduleEvent(int id, double time, EventType type);    // Agenda um evento e insere-o no min-heap
-        Event& GetNextEvent();                                      // Recupera o evento de menor tempo e o retira do min-heap
-        int GetSize();                                              // Retorna o tamanho do min-heap
+        EventHandle ScheduleEvent(int id, double time, EventType type);     // Agenda um evento e insere-o no min-heap
+        EventHandle ScheduleBatch(Event* events, int amount);               // Agenda um lote: sequências ordenadas longas ficam à parte, o resto entra no min-heap (construção linear se for grande). Retorna o identificador do primeiro evento
+        bool Cancel(EventHandle handle);                                    // Desagenda o evento; O(log n). Retorna false se ele já foi recuperado ou cancelado
+        bool Reschedule(EventHandle handle, double time);                   // Muda o tempo do evento (para antes ou depois); O(log n). Retorna false se ele já foi recuperado ou cancelado
+        Event& GetNextEvent();                                      // Recupera o evento de menor tempo (min-heap ou cabeça de sequência) e o retira
+        double PeekTime();                                          // Tempo do próximo evento sem retirá-lo (INFINITY se não houver); O(1) amortizado
+        int GetSize();                                              // Retorna a quantidade de eventos agendados
+        int GetSlotAmount();                                        // Vagas de identificador alocadas (acompanha o pico de eventos pendentes, não o total agendado)
+        void Clear();                                               // Descarta todos os eventos agendados (min-heap e sequências)
+        void SetTraceLog(TraceLog* trace);                          // Ativa (ou desativa, com nullptr) o registro de eventos no trace
 
         // Controle de memória
         int GetMemoryUsage();
 };
 
-#endif
\ No newline at end of file
+#endif
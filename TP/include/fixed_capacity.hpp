@@ -0,0 +1,107 @@
+#ifndef FIXEDCAPACITY_H
+#define FIXEDCAPACITY_H
+#include "demand_group.hpp"
+#include "ride.hpp"
+
+// Variantes de DemandGroup e Ride especializadas em tempo de compilação para a capacidade N do veículo.
+// As demandas, paradas e segmentos ficam embutidos no próprio objeto (sem alocação separada). O grupo guarda as
+// distâncias de cada demanda e entre demandas consecutivas, então Efficiency e a corrida criada por FixedRide calculam
+// só a distância que liga a última coleta à primeira entrega, em vez de 3*Size()-1 distâncias (as guardadas valem
+// enquanto a métrica ativa não muda).
+// Instanciadas para as capacidades mais comuns (2, 3, 4 e 6); as demais usam as classes dinâmicas.
+
+// Grupo de demandas com armazenamento embutido para N demandas
+template<int N>
+class FixedDemandGroup : public DemandGroup {
+    private:
+        Demand storage[N];              // Demandas do grupo (embutidas)
+        double origin_steps[N];         // origin_steps[i]: distância entre as origens i e i+1
+        double destination_steps[N];    // destination_steps[i]: distância entre os destinos i e i+1
+        double individual_sums[N];      // individual_sums[i]: soma das distâncias individuais das demandas 0..i
+
+        // Refresh: calcula as distâncias das demandas inseridas depois das que continuam estáveis
+        void Refresh() {
+            for(int i = this->stable; i < this->item_counter; i++) {
+                individual_sums[i] = (i > 0 ? individual_sums[i - 1] : 0) + storage[i].GetDistance();
+                if(i > 0) {
+                    origin_steps[i - 1] = storage[i - 1].GetOrigin().Distance(storage[i].GetOrigin());
+                    destination_steps[i - 1] = storage[i - 1].GetDestination().Distance(storage[i].GetDestination());
+                }
+            }
+            this->stable = this->item_counter;
+        }
+
+    public:
+        FixedDemandGroup() : DemandGroup(storage, N) { };
+
+        // CheckDistances: mesmo critério (e mesmas caixas) de DemandGroup
+        DistanceCheck CheckDistances(Demand& item, double alpha, double beta) override {
+            DistanceCheck result;
+            if(this->CheckBoxes(item, alpha, beta, result)) {
+                return result;
+            }
+            for(int i = 0; i < this->item_counter; i++) {
+                if(this->storage[i].OriginDistance(item) > alpha) {
+                    return DistanceCheck::ORIGIN_TOO_FAR;
+                }
+                if(this->storage[i].DestinationDistance(item) > beta) {
+                    return DistanceCheck::DESTINATION_TOO_FAR;
+                }
+            }
+            return DistanceCheck::COMPATIBLE;
+        }
+
+        // Efficiency: mesma conta (e mesma ordem das somas) de DemandGroup::Efficiency, a partir das distâncias guardadas
+        double Efficiency() override {
+            Refresh();
+            int size = this->item_counter;
+            double dist = 0;
+            for(int i = 0; i + 1 < size; i++) {
+                dist += origin_steps[i];
+            }
+            dist += this->storage[size - 1].GetOrigin().Distance(this->storage[0].GetDestination());
+            for(int i = 0; i + 1 < size; i++) {
+                dist += destination_steps[i];
+            }
+            return individual_sums[size - 1]/dist;
+        }
+
+        // SegmentDistance/IndividualDistance: as distâncias guardadas (FixedRide não recalcula as do grupo)
+        double SegmentDistance(int index) override {
+            Refresh();
+            int size = this->item_counter;
+            if(index < size - 1) {
+                return origin_steps[index];
+            }
+            if(index == size - 1) {
+                return this->storage[size - 1].GetOrigin().Distance(this->storage[0].GetDestination());
+            }
+            return destination_steps[index - size];
+        }
+
+        double IndividualDistance() override {
+            Refresh();
+            return individual_sums[this->item_counter - 1];
+        }
+};
+
+// Armazenamento de FixedRide: classe base separada para ser construída antes de Ride
+template<int N>
+struct FixedRideStorage {
+    Stop stop_slots[2*N];
+    Segment segment_slots[2*N - 1];
+};
+
+// Corrida com paradas e segmentos embutidos para um grupo de até N demandas
+template<int N>
+class FixedRide : private FixedRideStorage<N>, public Ride {
+    public:
+        FixedRide(DemandGroup& group, double min_efficiency)
+            : FixedRideStorage<N>(), Ride(group, min_efficiency, this->stop_slots, this->segment_slots) { };
+};
+
+// Fábricas: escolhem a instanciação correspondente à capacidade eta (ou a classe dinâmica, caso não haja)
+DemandGroup* NewDemandGroup(int eta);                       // Cria um grupo vazio com capacidade eta
+Ride* NewRide(DemandGroup& group, double min_efficiency);   // Cria a corrida de um grupo com base na capacidade dele. Lança low_efficiency como Ride
+
+#endif
@@ -4,6 +4,8 @@
 #include <stdexcept>
 #include <iomanip>
 #include <fstream>
+#include <utility>
+#include <vector>
 #include "segment.hpp"
 #include "demand_group.hpp"
 #include "event_scaler.hpp"
@@ -13,33 +15,57 @@ const static int MAX_SEGMENTS = 40;
 class Ride {
     private:
         // Atributos gerais
-        Stop** stops;           // Vetor de paradas da corrida
+        Stop* stops;            // Vetor de paradas da corrida
         Segment* segments;      // Vetor de segmentos da corrida
         int stop_amount;        // Quantidade de paradas da corrida
         int segment_amount;     // Quantidade de segmentos da corrida
+        bool owns_storage;      // Marca se os vetores foram alocados por este objeto
         
         // Atributos de simulação
         bool ongoing;           // Marca se a corrida está em andamento
         bool done;              // Marca se a corrida foi concluída
+        bool cancelled;         // Marca se todas as demandas da corrida foram canceladas
         double distance;        // Distância total da corrida
         double efficiency;      // Eficiência da corrida
         double start;           // Tempo do início da corrida
         double duration;        // Duração da corrida
         double end;             // Tempo do fim da corrida
+        int stop_cursor;        // Próxima parada a ser visitada (registro de paradas)
+        double traveled;        // Distância percorrida até a última parada visitada
+        double delay_offset;    // Soma dos atrasos recebidos depois do início (deslocam as paradas seguintes e o fim, não o início)
+        std::vector<std::pair<double, double> > delays;    // Atrasos depois do início: (distância percorrida quando ocorreu, atraso)
 
         // Controle de memória
         int mem_usage;
 
+        // Função auxiliar: preenche paradas e segmentos e calcula distância e eficiência
+        void Build(DemandGroup& group, double min_efficiency);
+
+    protected:
+        // Construtor para armazenamento externo (usado por FixedRide): os vetores precisam comportar 2*Size() paradas e 2*Size()-1 segmentos
+        Ride(DemandGroup& group, double min_efficiency, Stop* stop_storage, Segment* segment_storage);
+
     public:
         // Construtor e Destrutor
         Ride(DemandGroup& group, double min_efficiency);    // Construtor: inicializa as paradas, segmentos e outros atributos com base em um grupo de demandas. Lança low_efficiency caso a eficiência não seja atingida
-        ~Ride();                                            // Destrutor: apaga o conteúdo dos vetores
+        virtual ~Ride();                                    // Destrutor: apaga o conteúdo dos vetores
 
         // Operações/Métodos
         void Start();                                   // Assinala início desta corrida
+        void Reset();                                   // Volta ao estado anterior ao início (para simular de novo)
         void MarkDone();                                // Assinala conclusão desta corrida
         void CalculateDuration(double veh_speed);       // Calcula a duração desta corrida com base na velocidade dos veículos
         void PrintStops(std::ostream& out);             // Imprime a coordenada das paradas em ordem
+        int VisitNextStop(double veh_speed);            // Chega na próxima parada (completa o segmento até ela) e retorna seu índice
+        int GetRemainingStops();                        // Quantidade de paradas ainda não visitadas
+        double NextStopTime(double veh_speed);          // Tempo previsto de chegada na próxima parada (somente depois da primeira visita)
+        double MaxWait(double veh_speed);               // Maior espera prevista entre a solicitação e a coleta, entre as demandas da corrida
+        bool DropDemand(int demand_id);                 // Retira a coleta e a entrega de uma demanda (antes do início; a corrida precisa ficar com alguma demanda). Retorna false se a demanda não está na corrida
+        void Postpone(double delay, double time, double veh_speed);    // Atrasa, a partir de time, o restante da corrida: início (se ainda não começou) ou paradas seguintes, e fim
+        double DelayBefore(double distance);            // Atraso acumulado depois do início até a distância percorrida passada
+        void Cancel();                                  // Assinala que a corrida não vai mais acontecer
+        bool HasStarted();                              // Se a corrida já começou (ou terminou)
+        bool IsCancelled();
 
         // Getters
         double GetEfficiency();
@@ -48,6 +74,9 @@ class Ride {
         double GetDuration();
         double GetEnd();
         int GetStopAmount();
+        Stop& GetStop(int index);       // Paradas em ordem: as coletas (uma por demanda) e depois as entregas
+        int GetSegmentAmount();
+        Segment& GetSegment(int index); // Segmento index liga as paradas index e index + 1
 
         // Controle de Memória
         int GetMemoryUsage();
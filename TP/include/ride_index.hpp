@@ -0,0 +1,56 @@
+#ifndef RIDEINDEX_H
+#define RIDEINDEX_H
+#include <vector>
+
+// Índice de intervalos [início, fim] das corridas, para consultas do tipo "quais corridas estavam ativas no tempo t"
+// Construído uma vez (Add + Build) e só consultado depois:
+//   - árvore de intervalos centrada, achatada em vetores: cada nó guarda as corridas que contêm seu centro, ordenadas
+//     por início e por fim; uma consulta pontual desce um caminho de O(log n) nós e só percorre corridas que respondem,
+//     O(log n + k);
+//   - consulta de janela [a, b]: corridas ativas em a mais as que começam em (a, b], sem repetição, O(log n + k);
+//   - contagens por busca binária nos vetores ordenados de inícios e fins, O(log n), sem listar as corridas;
+//   - pico de corridas simultâneas calculado na construção por varredura dos extremos.
+class RideIndex {
+    private:
+        struct Node {
+            double center;
+            int first;          // Início do trecho do nó em by_start/by_end
+            int amount;         // Corridas que contêm o centro
+            int left;           // Subárvore com as corridas que terminam antes do centro (-1 se vazia)
+            int right;          // Subárvore com as corridas que começam depois do centro (-1 se vazia)
+        };
+
+        std::vector<int> ids;               // Corridas em ordem de início
+        std::vector<double> starts;         // Inícios em ordem crescente (alinhado com ids)
+        std::vector<double> ends;           // Fins em ordem crescente (para contagem)
+        std::vector<Node> nodes;
+        std::vector<int> by_start;          // Posições (em ids) das corridas de cada nó, por início crescente
+        std::vector<int> by_end;            // Posições (em ids) das corridas de cada nó, por fim decrescente
+        std::vector<double> end_of;         // Fim de cada corrida, por posição
+        int root;
+        bool built;
+        int max_concurrent;
+        double max_concurrent_time;
+
+        int BuildNode(std::vector<int>& members);   // Constrói a subárvore das posições passadas (em ordem de início)
+
+    public:
+        RideIndex();
+
+        void Clear();                                               // Esvazia o índice
+        void Add(int id, double start, double end);                 // Acrescenta uma corrida (antes de Build)
+        void Build();                                               // Constrói o índice; O(n log n)
+        bool IsBuilt();
+
+        void QueryPoint(double t, std::vector<int>& rides);                 // Corridas ativas em t (início <= t <= fim)
+        void QueryRange(double from, double to, std::vector<int>& rides);   // Corridas que se sobrepõem a [from, to]
+        int CountActive(double t);                                          // Quantidade de corridas ativas em t
+        int CountOverlapping(double from, double to);                       // Quantidade de corridas que se sobrepõem a [from, to]
+        int GetMaxConcurrent();                                             // Pico de corridas simultâneas
+        double GetMaxConcurrentTime();                                      // Primeiro tempo em que o pico ocorre
+        int GetRideAmount();
+
+        int GetMemoryUsage();
+};
+
+#endif
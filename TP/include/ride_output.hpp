@@ -0,0 +1,74 @@
+#ifndef RIDEOUTPUT_H
+#define RIDEOUTPUT_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include "ride.hpp"
+
+// Saída binária das corridas, em colunas
+// Arquivo:
+//   cabeçalho   "DSRIDES1", flags (uint32; bit 0: coordenadas em delta) e 4 bytes reservados
+//   paradas     coluna contígua das coordenadas de todas as corridas, em ordem de conclusão
+//               - padrão: pares de double (x, y)
+//               - delta: diferenças em centímetros para a parada anterior da mesma corrida (a primeira parte de 0),
+//                 em zigzag + varint; exato para coordenadas com até 2 casas decimais
+//   corridas    registros de tamanho fixo (RideRecord), em ordem de conclusão
+//   índice      deslocamento (uint64) do início das paradas de cada corrida na coluna de paradas, mais o fim da coluna
+//   rodapé      quantidade de corridas e deslocamentos das seções (uint64) e "DSRIDES1"
+// As paradas são gravadas à medida que as corridas terminam, por um buffer sequencial grande; registros e índice
+// (pequenos em relação às paradas) ficam em memória até o fechamento.
+
+// Registro de tamanho fixo de uma corrida
+struct RideRecord {
+    int32_t id;             // Índice da corrida
+    int32_t stop_count;     // Quantidade de paradas
+    double start;           // Tempo de início
+    double end;             // Tempo de fim
+    double distance;        // Distância total
+    double efficiency;      // Eficiência
+};
+
+// Gravador do arquivo binário
+class RideWriter {
+    private:
+        std::ofstream file;
+        bool delta;                             // Coordenadas em delta
+        std::vector<unsigned char> buffer;      // Buffer da coluna de paradas
+        size_t buffer_size;
+        uint64_t stop_bytes;                    // Bytes já acumulados na coluna de paradas
+        std::vector<RideRecord> records;
+        std::vector<uint64_t> offsets;
+        bool closed;
+
+        void Flush();                           // Grava o buffer da coluna de paradas
+
+    public:
+        RideWriter(const std::string& path, bool delta, size_t buffer_size = 1 << 20);
+        ~RideWriter();                          // Fecha o arquivo, se ainda não foi fechado
+
+        void Write(int id, Ride& ride);         // Acrescenta uma corrida concluída
+        void Close();                           // Grava registros, índice e rodapé e fecha o arquivo
+};
+
+// Leitor sequencial do arquivo binário: percorre as corridas em ordem com dois fluxos (registros e paradas)
+class RideReader {
+    private:
+        std::ifstream records_in;
+        std::ifstream stops_in;
+        bool delta;
+        uint64_t ride_amount;
+        uint64_t stops_offset;
+        uint64_t current;                       // Próxima corrida
+        std::vector<uint64_t> offsets;
+
+    public:
+        RideReader(const std::string& path);    // Lança runtime_error se o arquivo for inválido
+
+        uint64_t GetRideAmount();
+        bool IsDelta();
+        bool Next(RideRecord& record, std::vector<double>& coords);    // Próxima corrida e suas coordenadas (x, y intercalados); false no fim
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef RIDESTATS_H
+#define RIDESTATS_H
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include "ride.hpp"
+
+struct JsonValue;
+
+// Sketch de quantis com memória constante (baldes logarítmicos, como no DDSketch)
+// Cada valor cai no balde ceil(log_gamma(|v|)), com gamma = (1+a)/(1-a); o quantil devolvido tem erro relativo <= a
+// Sketches com a mesma configuração são somados balde a balde, então o resultado não depende de como os dados foram divididos
+class QuantileSketch {
+    public:
+        static const int BUCKETS = 2048;    // Baldes por sinal: cobre magnitudes de ~1e-6 a ~6e11 (fora disso o valor é saturado)
+        static const int MIN_KEY = -690;    // Chave do primeiro balde
+        static const double ACCURACY;       // Erro relativo a (0.01)
+        static const double MIN_VALUE;      // Magnitudes menores contam como zero
+
+    private:
+        uint64_t positive[BUCKETS];     // Baldes dos valores positivos
+        uint64_t negative[BUCKETS];     // Baldes dos valores negativos (por magnitude)
+        uint64_t zero;                  // Valores com magnitude abaixo de MIN_VALUE
+        uint64_t count;
+        double sum;
+        double min;
+        double max;
+
+        // Funções auxiliares
+        static int Bucket(double magnitude);    // Índice do balde de uma magnitude
+        static double Value(int bucket);        // Valor representativo de um balde
+
+    public:
+        QuantileSketch();
+
+        // Operações/Métodos
+        void Add(double value);                         // Registra um valor
+        void Merge(const QuantileSketch& other);        // Soma outro sketch a este
+        double Quantile(double q);                      // Quantil q (0 a 1); 0 se vazio
+        uint64_t Count();
+        double Mean();
+        double Min();
+        double Max();
+
+        // Serialização (resumo e baldes não vazios)
+        void WriteJSON(std::ostream& out);
+        bool ReadJSON(const JsonValue& value);          // false se o objeto não tiver o formato de WriteJSON
+};
+
+// Agregador das estatísticas das corridas concluídas, alimentado a cada RIDEEND
+class RideStats {
+    public:
+        static const int METRICS = 5;
+
+    private:
+        QuantileSketch metrics[METRICS];    // Eficiência, distância, duração, paradas e espera (nesta ordem)
+        uint64_t rides;                     // Quantidade de corridas registradas
+
+    public:
+        RideStats();
+
+        void Add(Ride& ride);                       // Registra uma corrida concluída (a espera é registrada por demanda: início da corrida - tempo da demanda)
+        void Merge(const RideStats& other);         // Soma as estatísticas de outra execução
+        uint64_t GetRideAmount();
+        QuantileSketch& GetMetric(int index);
+        static const char* MetricName(int index);
+
+        // Resumo em JSON: contagem, média, mínimo, máximo, p50/p90/p99 e os baldes (para combinar execuções)
+        void WriteJSON(std::ostream& out);
+        bool ReadJSON(std::istream& in);            // Lê um resumo escrito por WriteJSON; false se inválido
+};
+
+#endif
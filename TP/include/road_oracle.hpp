@@ -0,0 +1,92 @@
+#ifndef ROADORACLE_H
+#define ROADORACLE_H
+#include <atomic>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+// Oráculo de distâncias pela malha viária, carregado de um arquivo local
+// Formato do arquivo:
+//   n m
+//   x y        (n linhas: coordenadas dos nós)
+//   u v w      (m linhas: arestas não direcionadas entre os nós u e v, com comprimento w)
+// Os pontos são alinhados a uma grade de lado cell_size; a distância entre duas células é a do nó mais próximo de
+// cada centro, pelo menor caminho (Dijkstra), mais os trechos em linha reta entre os centros e esses nós.
+// Os resultados ficam em um cache dividido em fatias (shards), cada uma com seu próprio mutex. Cada fatia é uma tabela
+// plana associativa por conjuntos de SHARD_WAYS entradas (sem nós de lista ou de tabela de dispersão): um par novo
+// substitui o menos recentemente usado do seu conjunto.
+// À frente das fatias, cada thread tem um cache sem trava de mapeamento direto (FRONT_SIZE entradas), indexado pelas
+// coordenadas exatas consultadas, esvaziado quando a thread passa a consultar outro oráculo. Os pontos repetidos das
+// demandas (agrupamento, eficiência, segmentos) acertam esse cache sem alinhar à grade nem travar; pontos novos em
+// células já vistas acertam a fatia. Como a distância não muda, uma entrada continua válida depois de sair da fatia.
+class RoadOracle {
+    private:
+        // Chave do cache: par de células (ordenado, a distância é simétrica)
+        struct CellPair {
+            int32_t ax, ay, bx, by;
+            bool operator==(const CellPair& other) const {
+                return ax == other.ax && ay == other.ay && bx == other.bx && by == other.by;
+            }
+        };
+        struct CellPairHash {
+            size_t operator()(const CellPair& key) const;
+        };
+
+    public:
+        // Entrada do cache da thread: coordenadas consultadas e distância
+        struct FrontEntry {
+            double ax, ay, bx, by;
+            double value;
+        };
+        static const int FRONT_SIZE = 1024;     // Potência de 2
+        static const int SHARD_WAYS = 4;
+
+    private:
+        // Fatia do cache: conjuntos de SHARD_WAYS entradas (último uso em stamps; 0 marca uma entrada vazia) e contador
+        // de usos (relógio da substituição)
+        struct ShardSet {
+            CellPair keys[SHARD_WAYS];
+            double values[SHARD_WAYS];
+            uint64_t stamps[SHARD_WAYS];
+        };
+        struct Shard {
+            std::mutex lock;
+            std::vector<ShardSet> sets;     // Quantidade potência de 2, zerados
+            uint64_t clock;
+        };
+
+        static std::atomic<int> serials;        // Último serial atribuído (começa em 1); identifica o dono do cache da thread
+        int serial;
+
+        // Grafo (listas de adjacência em vetores contíguos)
+        std::vector<double> node_x;
+        std::vector<double> node_y;
+        std::vector<int> adj_begin;     // Início das arestas de cada nó em adj_to/adj_len (n+1 posições)
+        std::vector<int> adj_to;
+        std::vector<double> adj_len;
+
+        // Índice espacial dos nós: nós agrupados por célula da grade
+        std::unordered_map<int64_t, std::vector<int> > node_cells;
+
+        // Cache
+        double cell_size;
+        std::vector<Shard*> shards;
+
+        // Funções auxiliares
+        int64_t CellKey(int32_t cx, int32_t cy);
+        int NearestNode(double x, double y);            // Nó mais próximo do ponto (busca em anéis de células)
+        double ShortestPath(int from, int to);          // Dijkstra com parada antecipada; -1 se não houver caminho
+        double Compute(const CellPair& key);            // Distância entre os centros das células (sem cache)
+        double CellDistance(double ax, double ay, double bx, double by);    // Distância pelas células dos pontos, pela fatia do par
+
+    public:
+        // Construtor e destrutor
+        RoadOracle(const std::string& path, double cell_size, int shard_amount = 16, size_t shard_capacity = 1 << 14);  // Capacidade de cada fatia arredondada para potência de 2. Lança runtime_error se o arquivo for inválido
+        ~RoadOracle();
+
+        double Distance(double ax, double ay, double bx, double by);   // Distância pela malha entre dois pontos (thread-safe)
+};
+
+#endif
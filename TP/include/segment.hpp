@@ -12,31 +12,28 @@ enum class SegmentType {
 class Segment {
     private:
         // Atributos gerais
-        SegmentType type;               // Tipo de segmento: coleta (entre duas origens), deslocamento (entre uma origem e um destino) ou entrega (entre dois destinos)
         Stop* beg;                      // Início do segmento: ponteiro para uma parada
         Stop* end;                      // Fim do segmento: ponteiro para uma parada
 
         // Atributos de simulação
         double total_distance;          // Distância total do segmento
+        SegmentType type;               // Tipo de segmento: coleta (entre duas origens), deslocamento (entre uma origem e um destino) ou entrega (entre dois destinos)
         bool complete;                  // Marca se o trecho foi completo durante a simulação ou não
 
-        // Controle de memória
-        int static_mem_usage;           // Quantidade de memória consumida pelo objeto
-
     public:
-        // Construtores
+        // Construtores (cópia e atribuição implícitas: o segmento é trivialmente copiável)
         // Não há destrutor, é responsabilidade de ride.cpp apagar as paradas
         Segment();                      // Construtor padrão pra um segmento "nulo" (por definição)
         Segment(Stop& beg, Stop& end);  // Construtor da classe
+        Segment(Stop& beg, Stop& end, double distance);    // Com a distância já calculada (a mesma de beg.Distance(end))
 
         // Operações/Métodos
-        void operator=(Segment& other);         // Sobrecarga de atribuição para cópias
         void MarkComplete();                    // Marca o segmento como completo
-        double GetDistance();                   // Retorna o comprimento do segmento
-        SegmentType GetType();                  // Retorna o tipo do segmento
+        double GetDistance() const;             // Retorna o comprimento do segmento
+        SegmentType GetType() const;            // Retorna o tipo do segmento
 
-        // Controle de memória
-        int GetMemoryUsage();           // Retorna a quantidade de memória usada pelo objeto
+        // Controle de memória: igual para todo segmento (as paradas pertencem à corrida)
+        static int GetMemoryUsage();    // Retorna a quantidade de memória usada por um segmento
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef SEGMENTINDEX_H
+#define SEGMENTINDEX_H
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "ride.hpp"
+
+const static int SEGMENT_NODE_CAPACITY = 16;    // Filhos por nó da R-tree
+
+// Trecho indexado: segmento reto entre duas paradas consecutivas de uma corrida, com o intervalo de tempo em que foi percorrido
+struct SegmentEntry {
+    double x0, y0;          // Parada de partida
+    double x1, y1;          // Parada de chegada
+    double t0, t1;          // Tempos de passagem pelas duas paradas
+    int32_t ride;           // Índice da corrida
+    int32_t segment;        // Posição do segmento na corrida (da parada segment à parada segment + 1)
+};
+
+// Índice espacial dos trechos das corridas: R-tree empacotada (STR, Sort-Tile-Recursive) construída de uma vez
+//   - AddRide acumula os trechos de cada corrida concluída; Build empacota as folhas ordenando por x em fatias verticais
+//     e, em cada fatia, por y, e repete o processo nível a nível até a raiz;
+//   - cada nó guarda a caixa de seus trechos e o intervalo de tempo coberto, então as consultas podam por espaço e por tempo;
+//   - a geometria é a reta entre as coordenadas das paradas (para as métricas haversine e road, uma aproximação do trajeto);
+//   - Save/Load gravam e leem os vetores como estão, sem reconstrução.
+// Todos os intervalos de consulta são fechados.
+class SegmentIndex {
+    private:
+        struct Node {
+            double min_x, min_y, max_x, max_y;
+            double t0, t1;
+            int32_t first;      // Primeiro filho (trecho, nas folhas, ou nó do nível de baixo)
+            int32_t amount;     // Quantidade de filhos
+        };
+
+        std::vector<SegmentEntry> entries;  // Trechos (em ordem de folha depois de Build)
+        std::vector<Node> nodes;            // Nós de todos os níveis, das folhas até a raiz (último)
+        int32_t leaf_amount;                // Nós [0, leaf_amount) são folhas
+        bool built;
+
+        // Funções auxiliares
+        void Pack(int32_t first, int32_t amount, bool leaves);     // Empacota um trecho do nível de baixo (trechos ou nós) em novos nós (STR)
+
+    public:
+        SegmentIndex();
+
+        void Clear();
+        void AddRide(int id, Ride& ride, double veh_speed);     // Acrescenta os trechos de uma corrida (antes de Build)
+        void Build();                                           // Constrói a árvore; O(n log n)
+        bool IsBuilt();
+
+        // Consultas (depois de Build ou Load): preenchem hits com posições de trechos (ver GetEntry)
+        void QueryBox(double min_x, double min_y, double max_x, double max_y, double t0, double t1, std::vector<int>& hits);  // Trechos que cruzam a caixa
+        void QueryNear(double x, double y, double radius, double t0, double t1, std::vector<int>& hits);                      // Trechos a no máximo radius do ponto
+        void Nearest(double x, double y, int k, double t0, double t1, std::vector<int>& hits);                                 // k trechos mais próximos, do mais próximo ao mais distante
+        const SegmentEntry& GetEntry(int index);
+        int GetEntryAmount();
+        static double Distance(const SegmentEntry& entry, double x, double y);    // Distância (plana) do ponto ao trecho
+
+        // Serialização
+        void Save(const std::string& path);     // Lança runtime_error se não conseguir gravar
+        void Load(const std::string& path);     // Lança runtime_error se o arquivo for inválido
+
+        int64_t GetMemoryUsage();
+};
+
+#endif
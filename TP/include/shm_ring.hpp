@@ -0,0 +1,51 @@
+#ifndef SHMRING_H
+#define SHMRING_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+// Buffer circular de bytes em memória compartilhada POSIX, com um único produtor e um único consumidor, que podem
+// estar em processos diferentes (criado antes do fork; o filho herda o mapeamento). O nome do segmento é removido
+// logo após o mapeamento, então a memória é liberada quando o último processo termina, mesmo em caso de falha.
+//   - as posições de leitura e escrita são contadores atômicos no próprio segmento (publicados com release);
+//   - o conteúdo é um fluxo de bytes: registros maiores que o buffer são passados em partes;
+//   - quem espera (buffer cheio ou vazio) gira um pouco e depois cede o processador;
+//   - com Watch, o processo pai confere a cada espera longa se o filho do outro lado terminou, e a operação falha em
+//     vez de esperar para sempre por um processo que não vai mais escrever nem ler.
+class ShmRing {
+    private:
+        // Cabeçalho no início do segmento (cada contador na própria linha de cache)
+        struct Header {
+            alignas(64) std::atomic<uint64_t> head;     // Bytes já lidos
+            alignas(64) std::atomic<uint64_t> tail;     // Bytes já escritos
+            alignas(64) std::atomic<int> closed;        // Produtor encerrou a escrita
+        };
+
+        Header* header;
+        unsigned char* data;
+        uint64_t capacity;      // Potência de 2
+        size_t mapped;          // Tamanho do mapeamento (cabeçalho + dados)
+        pid_t peer;             // Filho do outro lado, conferido nas esperas (0 se nenhum)
+
+        bool Wait(int& spins);  // true se o filho observado tiver terminado
+
+    public:
+        // Construtor e destrutor
+        ShmRing(size_t capacity);      // Lança runtime_error se não for possível criar o segmento
+        ~ShmRing();                    // Desfaz o mapeamento deste processo
+        ShmRing(const ShmRing&) = delete;
+        ShmRing& operator=(const ShmRing&) = delete;
+
+        void Watch(pid_t peer);                         // Passa a conferir, nas esperas, se o filho peer terminou
+
+        // Produtor
+        void Write(const void* bytes, size_t size);     // Bloqueia enquanto o buffer estiver cheio (e o filho vivo)
+        void Close();                                   // Encerra a escrita (o consumidor ainda lê o que restou)
+
+        // Consumidor
+        bool Read(void* bytes, size_t size);            // Bloqueia até ler size bytes; false se a escrita terminou antes
+                                                        // (lança runtime_error se o filho terminou sem fechar)
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef SIMSNAPSHOT_H
+#define SIMSNAPSHOT_H
+#include <atomic>
+#include <cstdint>
+
+// Retrato compacto e imutável do estado da simulação, publicado pelo Manager durante StartSimulation
+struct SimSnapshot {
+    uint64_t version;           // Publicações até este retrato (a primeira é 1)
+    double global_time;         // Tempo do último evento processado
+    int32_t demands;            // Demandas recebidas
+    int32_t groups;             // Grupos de demandas
+    int32_t rides;              // Corridas criadas
+    int32_t waiting_rides;      // Corridas ainda não iniciadas (sem as canceladas)
+    int32_t active_rides;       // Corridas em andamento
+    int32_t finished_rides;     // Corridas concluídas
+    int32_t cancelled_rides;    // Corridas canceladas durante a simulação
+    int32_t pending_events;     // Eventos ainda no escalonador
+    int32_t memory;             // Memória extra atual do Manager
+    int32_t max_memory;         // Pico da memória extra
+};
+
+// Quadro de publicação com seqlock: uma thread (a da simulação) publica, qualquer quantidade de threads lê.
+//   - quem publica nunca espera: incrementa a sequência (ímpar durante a escrita), grava as palavras e a incrementa de novo;
+//   - quem lê copia as palavras entre duas leituras da sequência e repete se ela mudou ou estava ímpar;
+//   - o retrato é guardado em palavras atômicas de 64 bits (acessos relaxados), então a cópia concorrente não é uma
+//     condição de corrida; as barreiras ficam só nas leituras e escritas da sequência.
+class SnapshotBoard {
+    private:
+        static const int WORDS = (sizeof(SimSnapshot) + 7)/8;
+
+        alignas(64) std::atomic<uint64_t> sequence;     // Par: retrato estável; ímpar: publicação em andamento
+        alignas(64) std::atomic<uint64_t> words[WORDS];
+
+    public:
+        SnapshotBoard();
+
+        void Publish(const SimSnapshot& snapshot);  // Somente a thread que publica
+        bool Read(SimSnapshot& snapshot);           // Qualquer thread; false se nada foi publicado ainda
+};
+
+#endif
@@ -1,10 +1,22 @@
 #ifndef MANAGER_H
 #define MANAGER_H
+#include <chrono>
+#include <unordered_map>
 #include "ride.hpp"
 #include "demand_group.hpp"
-#include "event_scaler.hpp"
+#include "class_scaler.hpp"
+#include "trace_log.hpp"
+#include "ride_stats.hpp"
+#include "batch_grouper.hpp"
+#include "ride_output.hpp"
+#include "ride_index.hpp"
+#include "segment_index.hpp"
+#include "span_trace.hpp"
+#include "sim_snapshot.hpp"
 
-const static int MAX_GROUPS = 200;
+const static int MAX_GROUPS = 200;    // Capacidade inicial dos vetores de grupos e corridas (dobra quando cheia)
+const static int EVENT_CHUNK = 4096;  // Eventos retirados do escalonador por rodada na simulação paralela
+const static int SNAPSHOT_CLOCK_EVENTS = 64;    // Eventos entre consultas ao relógio na publicação de retratos por tempo
 
 class Manager {
     private:
@@ -15,22 +27,93 @@ class Manager {
         double origin_max_distance;     // alpha - Distância máxima entre origem de corridas compartilhadas
         double destin_max_distance;     // beta - Distância máxima entre destino de corridas compartilhadas
         float min_efficiency;           // lambda - Eficiência mínima da corrida compartilhada
-        int demand_amount;              // quantas demandas serão feitas
+        int demand_amount;              // quantas demandas serão feitas (0 se desconhecido: o último grupo é fechado ao iniciar a simulação)
 
         // Objetos de simulação e variáveis de controle
-        EventScaler scaler;                         // Escalonador
+        ClassScaler scaler;                         // Escalonador (uma fila por classe de serviço)
         double global_time;                         // Tempo global da simulação
         DemandGroup** demand_groups;                // Grupos de demandas (grupo contém demandas elegíveis para compartilhamento)
         int group_count;                            // Quantidade de grupos de demandas atualmente
         Ride** rides;                               // Corridas geradas com base nos grupos de demandas
         int ride_count;                             // Quantidade de corridas já geradas atualmente
         int demand_count;                           // Quantidade de demandas já recebidas
+        int slot_capacity;                          // Capacidade atual dos vetores de grupos e corridas
+        TraceLog* trace;                            // Trace opcional de decisões e eventos (nullptr se desativado)
+        RideStats* stats;                           // Agregador opcional de estatísticas das corridas (nullptr se desativado)
+        SegmentIndex* segment_index;                // Índice espacial que recebe os trechos de cada corrida concluída (nullptr se desativado)
+        std::ostream* stop_out;                     // Saída dos tempos de coleta e entrega de cada passageiro (nullptr se desativado)
+        int event_threads;                          // Threads da simulação paralela (1: laço serial)
+        bool scheduled;                             // Marca se as corridas já foram agendadas (primeira chamada de NextFinishedRide)
+        // Re-simulação incremental: registro da execução base (somente com EnableResimulation)
+        bool recording;                             // Marca se o registro está ativo
+        std::vector<char> checked;                  // Se cada demanda chegou à checagem de eficiência
+        std::vector<double> checked_efficiency;     // Eficiência do grupo com a demanda nessa checagem
+        std::vector<int> group_rides;               // Corrida de cada grupo (-1 se a criação falhou)
+
+        RideIndex ride_index;                       // Índice de intervalos das corridas (reconstruído sob demanda em GetRideIndex)
+        bool ride_index_ready;                      // Marca se o índice reflete as corridas e durações atuais
+
+        // Cancelamentos e atrasos: cada pedido vira um evento; as corridas guardam os identificadores dos seus eventos
+        struct RideChange {
+            int target;                             // Demanda (cancelamento) ou corrida (atraso)
+            double delay;                           // Atraso (somente RIDEDELAY)
+        };
+        std::vector<RideChange> changes;            // Pedidos de mudança (o id do evento é a posição aqui)
+        std::vector<EventHandle> start_handles;     // RIDESTART de cada corrida
+        std::vector<EventHandle> end_handles;       // RIDEEND de cada corrida
+        std::vector<EventHandle> stop_handles;      // RIDESTOP pendente de cada corrida (registro de paradas)
+        std::unordered_map<int, int> demand_rides;  // Corrida de cada demanda (montado no primeiro cancelamento)
+        int late_changes;                           // Pedidos que chegaram tarde demais (corrida já iniciada ou concluída)
+
+        BatchGrouper* batch;                        // Agrupamento em lote com janela (nullptr no modo guloso padrão)
+
+        // Classes de serviço: cada uma agrupa só as próprias demandas, com os próprios critérios (a classe 0 usa os do construtor)
+        struct ServiceClass {
+            int capacity;                           // eta
+            double delta;
+            double alpha;
+            double beta;
+            float lambda;
+            double max_wait;                        // Espera máxima entre solicitação e coleta (SLA; INFINITY se não houver)
+            int open_group;                         // Grupo aberto da classe (-1 se nenhum; com uma classe, é sempre o mais recente)
+            int sla_breaches;                       // Corridas iniciadas com alguma espera acima de max_wait
+        };
+        std::vector<ServiceClass> classes;
+        std::vector<int> ride_classes;              // Classe de cada corrida
+
+        // Retratos publicados durante a simulação (somente com SetSnapshotBoard)
+        SnapshotBoard* snapshots;                   // Quadro de publicação (nullptr se desativado)
+        uint64_t snapshot_version;                  // Publicações já feitas
+        int snapshot_period;                        // Eventos entre publicações
+        double snapshot_interval;                   // Milissegundos entre publicações (0: só por eventos)
+        int snapshot_events;                        // Eventos desde a última publicação
+        std::chrono::steady_clock::time_point snapshot_clock;   // Momento da última publicação
+        int started_rides;                          // Corridas iniciadas na simulação atual
+        int finished_rides;                         // Corridas concluídas na simulação atual
+        int cancelled_rides;                        // Corridas canceladas na simulação atual
 
         // Funções auxiliares (não acessíveis externamente - ver uso em state_manager.cpp)
         void UpdateMemory();                        // O(1)
-        DemandGroup* CreateDemandGroup();           // O(1)
-        bool MakeRide(DemandGroup* group);          // O(n)
-        bool CheckEfficiency(DemandGroup& group);   // O(n)
+        void GrowSlots(int needed);                 // O(n) amortizado O(1)
+        void ScheduleRides();                       // O(n)
+        void CloseDemands();                        // O(n)
+        void ResetSimulation();                     // O(n)
+        void StartParallelSimulation(std::ostream& out);    // O(n log n)
+        void RecordRide(int index_ride);            // O(1) amortizado
+        int ProcessDemand(Demand& demand);          // O(n)
+        DemandGroup* CreateDemandGroup(int service_class = 0);             // O(1)
+        bool MakeRide(DemandGroup* group, int service_class = 0);          // O(n)
+        bool CheckEfficiency(DemandGroup& group, float lambda);            // O(n)
+        int OpenGroup(int service_class);           // O(1)
+        void CloseOpenGroups();                     // O(k)
+        void CheckServiceLevel(int index_ride);     // O(tamanho da corrida)
+        void LogRide(DemandGroup* group, bool created, double start, double end);  // O(n)
+        void VisitStop(int index_ride);             // O(1)
+        void ApplyCancel(int change);               // O(log n) (O(n) no primeiro)
+        void ApplyDelay(int change);                // O(log n)
+        void FlushBatch();                          // Resolve a janela do agrupamento em lote e cria as corridas
+        void TickSnapshot();                        // O(1): conta um evento e publica um retrato se o período venceu
+        void PublishSnapshot();                     // O(1)
 
         // Controle de memória e depuração
         int static_mem_usage;           // Memória estática usada pelo objeto (imprescindível)
@@ -43,8 +126,33 @@ class Manager {
         ~Manager();
 
         // Simulação (pré, durante e pós)
-        int MakeDemand(int id, double t, double ox, double oy, double dx, double dy);  // Registra uma nova demanda e processa ela
+        int MakeDemand(int id, double t, double ox, double oy, double dx, double dy, int service_class = 0);  // Registra uma nova demanda e processa ela
+        int MakeDemands(int amount, const int* ids, const double* times, const double* ox, const double* oy, const double* dx, const double* dy);  // Registra um lote de demandas a partir de vetores por coluna, até a primeira recusada. Retorna quantas foram aceitas
         void StartSimulation(std::ostream& out);                                       // Inicia a simulação e imprime as estatísticas de cada corrida
+        void StartSimulation(RideWriter& writer);                                      // Inicia a simulação e grava cada corrida no arquivo binário em colunas
+        void SetEventThreads(int threads);                                             // Processa os eventos de StartSimulation em paralelo, com saída idêntica à serial
+        int NextFinishedRide();                                                        // Avança a simulação até a próxima corrida concluída e retorna seu índice (-1 no fim)
+        Ride* GetRide(int index);                                                      // Retorna a corrida pelo índice
+        void CancelDemand(int demand_id, double time);                                 // Agenda o cancelamento de uma demanda no tempo passado (só tem efeito se a corrida ainda não começou)
+        void DelayRide(int ride, double time, double delay);                           // Agenda um atraso de delay na corrida no tempo passado (sem efeito se ela já terminou). Lança invalid_argument se delay < 0
+        int GetLateChanges();                                                          // Cancelamentos e atrasos que chegaram tarde demais
+        RideIndex& GetRideIndex();                                                     // Índice das corridas por intervalo [início, fim], construído na primeira consulta
+
+        // Re-simulação incremental (depois de uma simulação completa ou antes da primeira)
+        void EnableResimulation();                                                     // Registra a execução base (chamar antes da primeira demanda)
+        void ChangeSpeed(double gamma);                                                // Novo gamma: recalcula durações e reagenda, sem reagrupar
+        int ChangeMinEfficiency(float lambda);                                         // Novo lambda: reagrupa só onde alguma decisão muda. Retorna as demandas reprocessadas
+        void SetTraceLog(TraceLog* trace);                                             // Ativa o registro de decisões, corridas e eventos no trace passado
+        void SetRideStats(RideStats* stats);                                           // Passa a registrar cada corrida concluída no agregador passado
+        void SetSegmentIndex(SegmentIndex* index);                                     // Passa a acrescentar os trechos de cada corrida concluída no índice passado (Build fica com o chamador)
+        void SetStopLog(std::ostream* out);                                            // Passa a simular cada parada (RIDESTOP) e a imprimir os tempos de coleta e entrega por passageiro
+        void EnableBatchMode(double max_delay, int threads);                           // Troca o agrupamento guloso pelo agrupamento em lote (antes da primeira demanda)
+        int AddServiceClass(int eta, double delta, double alpha, double beta, float lambda);   // Nova classe de serviço com critérios próprios (antes da primeira demanda). Retorna seu índice
+        void SetServiceLevel(int service_class, double max_wait, int priority);        // SLA de espera da classe e prioridade no empate de tempo (menor vai antes)
+        int GetClassAmount();
+        int GetRideClass(int ride);
+        int GetSlaBreaches(int service_class);                                         // Corridas da classe que estouraram o SLA na última simulação
+        void SetSnapshotBoard(SnapshotBoard* board, int events, double milliseconds);  // Publica um retrato no quadro a cada events eventos ou a cada milliseconds ms (o que vencer antes)
 
         // Controle de memória
         int GetStaticMemUsage();    // Retorna a memória imprescindível usada pelo manager
@@ -0,0 +1,132 @@
+#ifndef SPANTRACE_H
+#define SPANTRACE_H
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Linha do tempo da execução em spans (intervalos com nome), gravada no formato JSON de eventos do Chrome
+// (abre no Perfetto e em chrome://tracing). Complementa o trace binário de decisões (TraceLog) mostrando *quando*
+// o tempo foi gasto: fases longas (leitura, simulação) e as etapas de cada demanda (agrupamento, eficiência, corrida).
+//   - cada thread escreve só no próprio buffer circular, sem trava; quando o buffer enche, os spans mais antigos
+//     são sobrescritos (e contados como descartados);
+//   - quando uma thread termina, o buffer dela é devolvido e passa para a próxima thread nova (mesma trilha no trace),
+//     então a memória e as trilhas acompanham as threads simultâneas, não as criadas ao longo da execução;
+//   - spans de fase (PHASE) são sempre registrados; spans amostrados (SAMPLED) são registrados para 1 em cada
+//     sample_period spans de nível mais alto, e os spans amostrados aninhados seguem a decisão do que os contém
+//     (uma demanda sorteada aparece com todas as etapas);
+//   - sem trace ativo, um span custa uma leitura de ponteiro e um desvio.
+
+enum class SpanKind {
+    PHASE,      // Sempre registrado
+    SAMPLED     // Registrado por amostragem
+};
+
+// Span concluído (tempos em nanossegundos desde a criação do trace)
+struct SpanRecord {
+    const char* name;           // Literal com duração estática
+    const char* arg_name;       // Nome do argumento (nullptr se não houver)
+    int64_t arg;
+    uint64_t start;
+    uint64_t duration;
+};
+
+// Buffer circular de uma thread: somente a thread dona escreve; a posição de escrita é publicada com release
+class SpanBuffer {
+    private:
+        std::vector<SpanRecord> slots;      // Capacidade potência de 2
+        uint64_t mask;
+        std::atomic<uint64_t> head;         // Spans já escritos (o slot é head & mask)
+        std::atomic<bool> released;         // A thread dona terminou: o buffer pode ser assumido por outra
+        int thread;                         // Identificador da trilha no trace (ordem de criação do buffer)
+
+    public:
+        SpanBuffer(int thread, size_t capacity);
+
+        void Push(const SpanRecord& record);                // Thread dona
+        uint64_t Collect(std::vector<SpanRecord>& out);     // Acrescenta os spans retidos em ordem e retorna os sobrescritos
+        void Release();                                     // Thread dona, ao terminar
+        bool Acquire();                                     // Assume um buffer devolvido; false se ele ainda tem dona
+        int GetThread();
+};
+
+class SpanTrace {
+    private:
+        static std::atomic<SpanTrace*> active;      // Trace que recebe os spans (nullptr se desativado)
+        static std::atomic<int> serials;            // Identificadores das instâncias (o estado por thread guarda o da sua)
+
+        std::string path;
+        int sample_period;
+        size_t buffer_capacity;
+        int serial;
+        std::chrono::steady_clock::time_point origin;
+
+        // Buffers das threads (a trava só é usada no registro de uma thread nova e na escrita). Compartilhados com o
+        // estado da thread dona, que pode terminar depois do trace
+        std::mutex lock;
+        std::vector<std::shared_ptr<SpanBuffer> > buffers;
+
+    public:
+        // Estado de cada thread (ver span_trace.cpp)
+        struct ThreadState {
+            int owner;              // Instância dona do buffer (serial)
+            SpanBuffer* buffer;
+            int countdown;          // Spans amostrados de nível mais alto até o próximo registrado
+            int sampled_depth;      // Spans amostrados abertos
+            bool sampled_on;        // Decisão do span amostrado mais externo aberto
+        };
+
+        // Construtor e destrutor
+        SpanTrace(const std::string& path, int sample_period = 64, size_t buffer_capacity = 1 << 16);
+        ~SpanTrace();       // Desativa o trace se for o ativo (não escreve o arquivo)
+
+        // Ativação (global ao processo)
+        static void Start(SpanTrace* trace);        // Passa a registrar os spans em trace (nullptr desativa)
+        static SpanTrace* Active() { return active.load(std::memory_order_relaxed); }
+
+        ThreadState& State();                       // Estado da thread atual, assumindo um buffer devolvido ou criando um se necessário
+        uint64_t Now();                             // Nanossegundos desde a criação do trace
+        int GetSamplePeriod();
+
+        void Write();       // Grava o JSON com os spans retidos. Lança runtime_error se não for possível abrir o arquivo
+};
+
+// Span com escopo: registra do construtor ao destrutor
+class TraceSpan {
+    private:
+        SpanTrace* trace;           // nullptr se o span não será registrado
+        SpanTrace::ThreadState* state;
+        SpanKind kind;
+        SpanRecord record;
+
+        void Begin(SpanTrace* trace);
+        void End();
+
+    public:
+        TraceSpan(const char* name, SpanKind kind = SpanKind::PHASE) : trace(nullptr), state(nullptr), kind(kind) {
+            SpanTrace* active = SpanTrace::Active();
+            if(active != nullptr) {
+                this->record.name = name;
+                this->record.arg_name = nullptr;
+                Begin(active);
+            }
+        }
+        ~TraceSpan() {
+            if(this->state != nullptr) {
+                End();
+            }
+        }
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan& operator=(const TraceSpan&) = delete;
+
+        // Argumento mostrado junto com o span (o último valor passado vale)
+        void SetArg(const char* name, int64_t value) {
+            this->record.arg_name = name;
+            this->record.arg = value;
+        }
+};
+
+#endif
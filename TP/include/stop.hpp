@@ -12,22 +12,26 @@ class Stop {
         // Atributos gerais
         StopType type;          // Tipo de parada: coleta ou desembarque
         int demand_id;          // ID da demanda associada à parada
+        double request_time;    // Tempo de solicitação da demanda associada
+        double visit_time;      // Tempo de chegada do veículo na parada (-1 enquanto não visitada)
         Point2D stop;           // Ponto da parada (mesmo da demanda)
-
-        // Controle de memória
-        int static_mem_usage;   // Quantidade de memória consumida pelo objeto
     
     public:
-        // Construtor
-        Stop(Demand& demand, StopType type);
+        // Construtores (cópia e atribuição implícitas: a parada é trivialmente copiável)
+        Stop();                                     // Parada "nula" (por definição), usada para pré-alocar vetores de paradas
+        Stop(const Demand& demand, StopType type);
 
         // Operações/Métodos
-        Point2D& GetPoint();                // Retorna referência para o ponto da parada
-        StopType GetType();                 // Retorna o tipo desta parada
-        double Distance(Stop& other);       // Retorna a distância entre esta parada e outra
+        const Point2D& GetPoint() const;        // Retorna referência para o ponto da parada
+        StopType GetType() const;               // Retorna o tipo desta parada
+        int GetDemandID() const;                // Retorna o id da demanda associada
+        double GetRequestTime() const;          // Retorna o tempo de solicitação da demanda associada
+        void MarkVisited(double time);          // Registra a chegada do veículo na parada
+        double GetVisitTime() const;            // Retorna o tempo de chegada (-1 se ainda não visitada)
+        double Distance(const Stop& other) const;   // Retorna a distância entre esta parada e outra
 
-        // Controle de memória
-        int GetMemoryUsage();               // Retorna a quantidade de memória usada pelo objeto
+        // Controle de memória: igual para toda parada
+        static int GetMemoryUsage();            // Retorna a quantidade de memória usada por uma parada
 };
 
 #endif
\ No newline at end of file
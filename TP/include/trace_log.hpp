@@ -0,0 +1,95 @@
+#ifndef TRACELOG_H
+#define TRACELOG_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "event.hpp"
+
+// Tipos de registro do trace: eventos do escalonador, decisões de agrupamento e criação de corridas
+enum class TraceRecordType : unsigned char {
+    SCHEDULE,           // ScheduleEvent
+    NEXTEVENT,          // GetNextEvent
+    INSERTED,           // Demanda inserida em um grupo
+    REJECT_CAPACITY,    // Demanda rejeitada: grupo cheio
+    REJECT_TIME,        // Demanda rejeitada: intervalo de tempo maior que delta
+    REJECT_ALPHA,       // Demanda rejeitada: distância entre origens maior que alpha
+    REJECT_BETA,        // Demanda rejeitada: distância entre destinos maior que beta
+    REJECT_LAMBDA,      // Demanda rejeitada: eficiência abaixo de lambda
+    RIDE,               // MakeRide
+    CHANGE              // CancelDemand/DelayRide: alvo do pedido de mudança
+};
+
+// Registro decodificado (os campos não usados pelo tipo ficam com o valor padrão)
+struct TraceRecord {
+    TraceRecordType type;
+    int id;                     // Corrida (eventos e RIDE), demanda (decisões) ou pedido de mudança (CHANGE e eventos DEMANDCANCEL/RIDEDELAY)
+    int group;                  // Grupo da decisão ou da corrida; alvo do pedido em CHANGE (demanda ou corrida)
+    double time;                // Tempo do evento, da demanda ou início da corrida
+    double end;                 // Fim da corrida (somente RIDE)
+    EventType event_type;       // Tipo do evento (somente SCHEDULE, NEXTEVENT e CHANGE)
+    bool created;               // Se a corrida foi criada ou descartada por eficiência (somente RIDE)
+    std::vector<int> demands;   // Demandas da corrida (somente RIDE)
+};
+
+// Estado de codificação delta compartilhado entre escrita e leitura
+// Ids são gravados como diferença (zigzag + varint) para o último id do mesmo campo, tempos como XOR dos bits com o último tempo (varint)
+struct TraceCodec {
+    int last_id;
+    int last_group;
+    uint64_t last_time;
+
+    TraceCodec() : last_id(0), last_group(0), last_time(0) { };
+
+    void Encode(const TraceRecord& record, std::vector<unsigned char>& out);                        // Acrescenta o registro codificado em out
+    bool Decode(const unsigned char*& pos, const unsigned char* end, TraceRecord& record);          // Decodifica um registro e avança pos; false se os dados acabaram
+};
+
+// Gravador de trace: acumula registros em um buffer e entrega buffers cheios a uma thread de escrita em segundo plano
+class TraceLog {
+    private:
+        // Arquivo e buffers (o buffer ativo recebe registros, o pendente é escrito pela thread)
+        std::ofstream file;
+        std::vector<unsigned char> active;
+        std::vector<unsigned char> pending;
+        size_t buffer_size;
+        TraceCodec codec;
+        TraceRecord scratch;
+
+        // Sincronização com a thread de escrita
+        std::thread flusher;
+        std::mutex lock;
+        std::condition_variable cond;
+        bool has_pending;
+        bool closing;
+
+        // Funções auxiliares
+        void FlusherLoop();             // Laço da thread de escrita
+        void HandOff();                 // Entrega o buffer ativo para a thread de escrita
+        void Append(TraceRecord& rec);  // Codifica um registro no buffer ativo
+
+    public:
+        // Construtor e destrutor
+        TraceLog(const std::string& path, size_t buffer_size = 1 << 16);   // Abre o arquivo e inicia a thread de escrita. Lança runtime_error se não for possível abrir
+        ~TraceLog();                                                        // Fecha o log
+
+        // Registro
+        void LogEvent(TraceRecordType type, int ride_id, double time, EventType event_type);   // SCHEDULE ou NEXTEVENT
+        void LogDecision(TraceRecordType type, int demand_id, int group, double time);         // Decisão de agrupamento de uma demanda
+        void LogRide(int ride_id, int group, bool created, double start, double end, const int* demands, int demand_amount);  // MakeRide
+        void LogChange(int change, int target, double time, EventType event_type);             // Pedido de mudança e seu alvo
+
+        void Close();   // Escreve o que restou e encerra a thread de escrita
+};
+
+// Leitura de um trace completo (usado pela ferramenta de replay)
+bool ReadTrace(const std::string& path, std::vector<TraceRecord>& records);
+
+// Nome textual de cada tipo de registro
+const char* TraceRecordName(TraceRecordType type);
+
+#endif
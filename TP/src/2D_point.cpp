@@ -1,37 +1,68 @@
 #include "2D_point.hpp"
+#include "road_oracle.hpp"
 #include <cmath>
+#include <type_traits>
 
-// CONSTRUTOR COMPLETO
-Point2D::Point2D(double x, double y) {
-    this->x = x;
-    this->y = y;
+static_assert(std::is_trivially_copyable<Point2D>::value, "Point2D must be trivially copyable");
+
+// Conversão entre double e a representação armazenada (ver 2D_point.hpp)
+#if defined(POINT_FIXED32)
+static inline coord_t ToCoord(double value) {
+    return (coord_t)llround(value*100.0);
+}
+
+static inline double FromCoord(coord_t value) {
+    return value/100.0;
+}
+#elif defined(POINT_FLOAT32)
+static inline coord_t ToCoord(double value) {
+    return (coord_t)value;
+}
+
+// A leitura arredonda para o centímetro mais próximo: recupera exatamente o double de uma entrada com 2 casas decimais,
+// de modo que as distâncias (e a saída) sejam as mesmas do modo padrão
+static inline double FromCoord(coord_t value) {
+    return nearbyint(value*100.0)/100.0;
+}
+#else
+static inline coord_t ToCoord(double value) {
+    return value;
 }
 
-// CONSTRUTOR DE CÓPIA
-Point2D::Point2D(const Point2D& other) {
-    this->x = other.x;
-    this->y = other.y;
+static inline double FromCoord(coord_t value) {
+    return value;
 }
+#endif
 
-// Sobrecarga de atribuição - copia para este objeto as coordenadas do outro
-void Point2D::operator=(const Point2D& other) {
-    this->x = other.x;
-    this->y = other.y;
+// CONSTRUTOR COMPLETO
+Point2D::Point2D(double x, double y) {
+    this->x = ToCoord(x);
+    this->y = ToCoord(y);
 }
 
 // GetX: retorna a coordenada deste ponto no eixo X
-double Point2D::GetX() {
-    return this->x;
+double Point2D::GetX() const {
+    return FromCoord(this->x);
 }
 
 // GetY: retorna a coordenada deste ponto no eixo Y
-double Point2D::GetY() {
-    return this->y;
+double Point2D::GetY() const {
+    return FromCoord(this->y);
 }
 
-// Distance: calcula a distância (double) entre esse e outro ponto passado por referência
-double Point2D::Distance(Point2D& other) {
-    double dx = this->x - other.GetX();
-    double dy = this->y - other.GetY();
-    return sqrt((dx*dx) + (dy*dy));
+// Distance: calcula a distância (double) entre esse e outro ponto passado por referência, pela métrica ativa
+double Point2D::Distance(const Point2D& other) const {
+    switch(DistanceMetric::Active()) {
+        case MetricType::MANHATTAN:
+            return DistanceWith<ManhattanMetric>(other);
+
+        case MetricType::HAVERSINE:
+            return DistanceWith<HaversineMetric>(other);
+
+        case MetricType::ROAD:
+            return DistanceMetric::Oracle()->Distance(GetX(), GetY(), other.GetX(), other.GetY());
+
+        default:
+            return DistanceWith<EuclideanMetric>(other);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <unordered_map>
+#include <cmath>
+#include <cstdint>
+#include "batch_grouper.hpp"
+#include "distance_metric.hpp"
+
+static const int MIN_PARALLEL_WINDOW = 64;      // Janelas menores são resolvidas na própria thread
+static const int SEARCH_BUDGET = 2048;          // Nós visitados pela busca a partir de cada semente
+
+//-------------------------------------------------------------------------------
+// BUSCA DO MELHOR GRUPO
+//-------------------------------------------------------------------------------
+
+// Estado da busca a partir de uma semente (uma por thread)
+struct GroupSearch {
+    std::vector<Demand*> demands;       // Demandas da janela em ordem de tempo
+    const std::vector<std::vector<int> >* neighbors;
+    DemandGroup* scratch;               // Grupo auxiliar para calcular a eficiência
+    double lambda;
+    int capacity;
+    int budget;
+
+    std::vector<int> best;
+    double best_saved;
+
+    // Evaluate: confere lambda para o grupo atual e devolve a distância economizada em saved
+    bool Evaluate(const std::vector<int>& current, double& saved) {
+        this->scratch->Clear();
+        double individual = 0;
+        for(size_t i = 0; i < current.size(); i++) {
+            this->scratch->Insert(*this->demands[current[i]]);
+            individual += this->demands[current[i]]->GetDistance();
+        }
+        double efficiency = this->scratch->Efficiency();
+        if(efficiency < this->lambda) {
+            return false;
+        }
+        saved = individual - individual/efficiency;
+        return true;
+    }
+
+    // Extend: registra o grupo atual se for melhor e tenta acrescentar cada candidato compatível com todos os membros
+    void Extend(std::vector<int>& current, double saved, const std::vector<int>& candidates) {
+        if(--this->budget < 0) {
+            return;
+        }
+        if(current.size() > this->best.size() || (current.size() == this->best.size() && saved > this->best_saved)) {
+            this->best = current;
+            this->best_saved = saved;
+        }
+        if((int)current.size() == this->capacity) {
+            return;
+        }
+
+        for(size_t i = 0; i < candidates.size() && this->budget >= 0; i++) {
+            int next = candidates[i];
+
+            // Candidatos restantes: posteriores a next e vizinhos dele (a lista de candidatos já é vizinha dos membros)
+            const std::vector<int>& adjacent = (*this->neighbors)[next];
+            std::vector<int> remaining;
+            std::set_intersection(candidates.begin() + i + 1, candidates.end(), adjacent.begin(), adjacent.end(), std::back_inserter(remaining));
+
+            // Poda: nem acrescentando todos os restantes o grupo alcança o tamanho do melhor
+            if(current.size() + 1 + remaining.size() < this->best.size()) {
+                continue;
+            }
+
+            current.push_back(next);
+            double next_saved;
+            if(Evaluate(current, next_saved)) {
+                Extend(current, next_saved, remaining);
+            }
+            current.pop_back();
+        }
+    }
+};
+
+//-------------------------------------------------------------------------------
+// CONSTRUTOR
+//-------------------------------------------------------------------------------
+
+BatchGrouper::BatchGrouper(int eta, double delta, double alpha, double beta, double lambda, double max_delay, int threads) {
+    this->capacity = eta;
+    this->alpha = alpha;
+    this->beta = beta;
+    this->lambda = lambda;
+    this->window = std::min(delta, max_delay);
+    this->threads = std::max(threads, 1);
+}
+
+//-------------------------------------------------------------------------------
+// JANELA
+//-------------------------------------------------------------------------------
+
+// Fits: a janela aceita a demanda se ela estiver a no máximo window da primeira
+bool BatchGrouper::Fits(Demand& demand) {
+    return this->pending.empty() || demand.GetTime() - this->pending[0].GetTime() <= this->window;
+}
+
+void BatchGrouper::Add(Demand& demand) {
+    this->pending.push_back(demand);
+}
+
+int BatchGrouper::PendingAmount() {
+    return this->pending.size();
+}
+
+Demand& BatchGrouper::GetPending(int index) {
+    return this->pending[index];
+}
+
+void BatchGrouper::Clear() {
+    this->pending.clear();
+}
+
+//-------------------------------------------------------------------------------
+// RESOLUÇÃO
+//-------------------------------------------------------------------------------
+
+// GridKey: chave da célula (cx, cy) no mapa da grade; o deslocamento é feito sem sinal, definido também para células
+// negativas (colisões entre células distantes só acrescentam candidatos, todos conferidos pela distância)
+static int64_t GridKey(int64_t cx, int64_t cy) {
+    return (int64_t)(((uint64_t)cx << 32) ^ (uint32_t)cy);
+}
+
+// BuildNeighbors: pares (em posições na ordem de tempo) com origens a no máximo alpha e destinos a no máximo beta
+// Com métricas planas, só as 9 células vizinhas na grade de lado alpha podem conter origens a no máximo alpha
+void BatchGrouper::BuildNeighbors(std::vector<std::vector<int> >& neighbors) {
+    int n = this->pending.size();
+    neighbors.assign(n, std::vector<int>());
+
+    if(DistanceMetric::IsPlanar() && this->alpha > 0) {
+        std::unordered_map<int64_t, std::vector<int> > cells;
+        std::vector<int64_t> cx(n), cy(n);
+        for(int p = 0; p < n; p++) {
+            cx[p] = (int64_t)floor(this->pending[p].GetOrigin().GetX()/this->alpha);
+            cy[p] = (int64_t)floor(this->pending[p].GetOrigin().GetY()/this->alpha);
+            cells[GridKey(cx[p], cy[p])].push_back(p);
+        }
+        for(int p = 0; p < n; p++) {
+            for(int64_t dx = -1; dx <= 1; dx++) {
+                for(int64_t dy = -1; dy <= 1; dy++) {
+                    std::unordered_map<int64_t, std::vector<int> >::iterator cell = cells.find(GridKey(cx[p] + dx, cy[p] + dy));
+                    if(cell == cells.end()) {
+                        continue;
+                    }
+                    for(size_t k = 0; k < cell->second.size(); k++) {
+                        int q = cell->second[k];
+                        if(q > p && this->pending[p].OriginDistance(this->pending[q]) <= this->alpha
+                            && this->pending[p].DestinationDistance(this->pending[q]) <= this->beta) {
+                            neighbors[p].push_back(q);
+                            neighbors[q].push_back(p);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    else {
+        for(int p = 0; p < n; p++) {
+            for(int q = p + 1; q < n; q++) {
+                if(this->pending[p].OriginDistance(this->pending[q]) <= this->alpha
+                    && this->pending[p].DestinationDistance(this->pending[q]) <= this->beta) {
+                    neighbors[p].push_back(q);
+                    neighbors[q].push_back(p);
+                }
+            }
+        }
+    }
+
+    for(int p = 0; p < n; p++) {
+        std::sort(neighbors[p].begin(), neighbors[p].end());
+    }
+}
+
+// Solve: ordena a janela por tempo, separa as componentes e resolve cada uma (em paralelo quando vale a pena)
+void BatchGrouper::Solve(std::vector<std::vector<int> >& groups) {
+    int n = this->pending.size();
+    groups.clear();
+    if(n == 0) {
+        return;
+    }
+
+    // Ordem de tempo (empates pela ordem de chegada); a janela é reorganizada nessa ordem
+    std::vector<int> order(n);
+    for(int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return this->pending[a].GetTime() < this->pending[b].GetTime();
+    });
+    std::vector<Demand> sorted;
+    sorted.reserve(n);
+    for(int i = 0; i < n; i++) {
+        sorted.push_back(this->pending[order[i]]);
+    }
+    this->pending.swap(sorted);
+
+    std::vector<std::vector<int> > neighbors;
+    BuildNeighbors(neighbors);
+
+    // Componentes conexas (union-find); membros de cada componente ficam em ordem de tempo
+    std::vector<int> parent(n);
+    for(int p = 0; p < n; p++) {
+        parent[p] = p;
+    }
+    std::function<int(int)> find = [&parent, &find](int p) {
+        return parent[p] == p ? p : (parent[p] = find(parent[p]));
+    };
+    for(int p = 0; p < n; p++) {
+        for(size_t k = 0; k < neighbors[p].size(); k++) {
+            parent[find(p)] = find(neighbors[p][k]);
+        }
+    }
+    std::vector<std::vector<int> > components;
+    std::vector<int> component_of(n, -1);
+    for(int p = 0; p < n; p++) {
+        int root = find(p);
+        if(component_of[root] < 0) {
+            component_of[root] = components.size();
+            components.push_back(std::vector<int>());
+        }
+        components[component_of[root]].push_back(p);
+    }
+
+    // Resolução das componentes: cada thread monta o estado da busca uma vez; as componentes são disjuntas, então
+    // todas marcam as demandas já agrupadas no mesmo vetor sem conflito
+    std::vector<std::vector<std::vector<int> > > results(components.size());
+    std::vector<char> assigned(n, 0);
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        DemandGroup scratch(this->capacity);
+        GroupSearch search;
+        for(int i = 0; i < n; i++) {
+            search.demands.push_back(&this->pending[i]);
+        }
+        search.neighbors = &neighbors;
+        search.scratch = &scratch;
+        search.lambda = this->lambda;
+        search.capacity = this->capacity;
+
+        int component;
+        while((component = next.fetch_add(1)) < (int)components.size()) {
+            SolveComponent(components[component], search, assigned, results[component]);
+        }
+    };
+
+    int workers = std::min<int>(this->threads, components.size());
+    if(workers > 1 && n >= MIN_PARALLEL_WINDOW) {
+        std::vector<std::thread> pool;
+        for(int i = 0; i < workers; i++) {
+            pool.push_back(std::thread(worker));
+        }
+        for(int i = 0; i < workers; i++) {
+            pool[i].join();
+        }
+    }
+    else {
+        worker();
+    }
+
+    // Junção: grupos ordenados pela primeira demanda, independentemente da thread que os resolveu
+    for(size_t c = 0; c < results.size(); c++) {
+        for(size_t g = 0; g < results[c].size(); g++) {
+            groups.push_back(results[c][g]);
+        }
+    }
+    std::sort(groups.begin(), groups.end());
+}
+
+// SolveComponent: sementes em ordem de tempo; cada semente leva o melhor grupo encontrado entre seus vizinhos livres
+// O custo é proporcional à componente (demandas isoladas viram grupos sozinhas, sem busca)
+void BatchGrouper::SolveComponent(const std::vector<int>& members, GroupSearch& search, std::vector<char>& assigned, std::vector<std::vector<int> >& groups) {
+    if(members.size() == 1) {
+        assigned[members[0]] = 1;
+        groups.push_back(members);
+        return;
+    }
+
+    const std::vector<std::vector<int> >& neighbors = *search.neighbors;
+    for(size_t m = 0; m < members.size(); m++) {
+        int seed = members[m];
+        if(assigned[seed]) {
+            continue;
+        }
+
+        // Candidatos: vizinhos livres da semente (todos posteriores a ela, pois a semente é a mais antiga livre)
+        std::vector<int> candidates;
+        for(size_t k = 0; k < neighbors[seed].size(); k++) {
+            if(!assigned[neighbors[seed][k]]) {
+                candidates.push_back(neighbors[seed][k]);
+            }
+        }
+
+        std::vector<int> current(1, seed);
+        search.best.clear();
+        search.best_saved = 0;
+        search.budget = SEARCH_BUDGET;
+        search.Extend(current, 0, candidates);
+
+        for(size_t k = 0; k < search.best.size(); k++) {
+            assigned[search.best[k]] = 1;
+        }
+        groups.push_back(search.best);
+    }
+}
@@ -0,0 +1,113 @@
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include "fixed_capacity.hpp"
+
+// Ferramenta de medição: FixedDemandGroup<N>/FixedRide<N> contra DemandGroup/Ride nas capacidades instanciadas por
+// NewDemandGroup/NewRide (2, 3, 4 e 6), no mesmo laço do agrupamento guloso (checagem de distâncias, inserção,
+// eficiência e criação da corrida ao fechar o grupo).
+// As demandas chegam em rajadas de 8 com origem e destino no mesmo aglomerado, para que os grupos encham. Cada linha é
+// "eta fixo_s dinamico_s aceleracao corridas"; as duas variantes precisam chegar às mesmas corridas e distâncias.
+// Uso: capacity_bench.out [-n demandas] [-r repeticoes] [-s semente]
+
+// Resultado de uma passada: corridas criadas e soma das distâncias (confere que as variantes decidem igual)
+struct Pass {
+    double seconds;
+    long rides;
+    double distance;
+};
+
+// Run: passada gulosa sobre as demandas, com o grupo passado e a fábrica de corridas make_ride
+template<typename MakeRide>
+static Pass Run(std::vector<Demand>& demands, DemandGroup& group, MakeRide make_ride, int repeats) {
+    const double alpha = 2.0, beta = 2.0, lambda = 0.5;
+    Pass pass = {0, 0, 0};
+    auto begin = std::chrono::steady_clock::now();
+    for(int r = 0; r < repeats; r++) {
+        group.Clear();
+        for(size_t i = 0; i < demands.size(); i++) {
+            bool close = group.Size() > 0 && (group.IsFull() || group.CheckDistances(demands[i], alpha, beta) != DistanceCheck::COMPATIBLE);
+            if(!close && group.Size() > 0) {
+                group.Insert(demands[i]);
+                if(group.Efficiency() >= lambda) {
+                    continue;
+                }
+                group.Remove();
+                close = true;
+            }
+            if(close) {
+                Ride* ride = make_ride(group);
+                pass.rides++;
+                pass.distance += ride->GetDistance();
+                delete ride;
+                group.Clear();
+            }
+            group.Insert(demands[i]);
+        }
+    }
+    pass.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return pass;
+}
+
+// Compare: mede as duas variantes para a capacidade N e imprime a linha do relatório
+template<int N>
+static bool Compare(std::vector<Demand>& demands, int repeats) {
+    FixedDemandGroup<N> fixed_group;
+    Pass fixed = Run(demands, fixed_group, [](DemandGroup& group) -> Ride* { return new FixedRide<N>(group, 0); }, repeats);
+    DemandGroup dynamic_group(N);
+    Pass dynamic = Run(demands, dynamic_group, [](DemandGroup& group) -> Ride* { return new Ride(group, 0); }, repeats);
+
+    std::cout << N << " " << std::setprecision(4) << fixed.seconds << " " << dynamic.seconds << " "
+              << std::setprecision(2) << dynamic.seconds/fixed.seconds << "x " << fixed.rides/repeats << std::endl;
+    if(fixed.rides != dynamic.rides || fixed.distance != dynamic.distance) {
+        std::cerr << "Fixed and dynamic groups diverged for eta " << N << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int amount = 1000000;
+    int repeats = 3;
+    unsigned seed = 7;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            amount = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repeats = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = atoi(argv[++i]);
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-n demands] [-r repeats] [-s seed]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Rajadas de 8 demandas, cada uma em um dos 4 aglomerados de origem e 4 de destino
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> spread(0.0, 1.0);
+    std::uniform_int_distribution<int> cluster(0, 3);
+    std::vector<Demand> demands;
+    int o = 0, d = 0;
+    for(int i = 0; i < amount; i++) {
+        if(i % 8 == 0) {
+            o = cluster(random);
+            d = cluster(random);
+        }
+        demands.push_back(Demand(i, i*0.1, 10*o + spread(random), 10*o + spread(random),
+                                 60 + 10*d + spread(random), 10*d + spread(random)));
+    }
+
+    std::cout << std::fixed;
+    std::cout << "eta fixed dynamic speedup rides" << std::endl;
+    bool same = Compare<2>(demands, repeats) && Compare<3>(demands, repeats) && Compare<4>(demands, repeats)
+             && Compare<6>(demands, repeats);
+    return same ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+#include "class_scaler.hpp"
+
+//-------------------------------------------------------------------------------
+// CONSTRUTOR E DESTRUTOR
+//-------------------------------------------------------------------------------
+
+ClassScaler::ClassScaler() {
+    this->trace = nullptr;
+    this->size = 0;
+    AddClass(0);
+}
+
+ClassScaler::~ClassScaler() {
+    for(size_t i = 0; i < this->queues.size(); i++) {
+        delete this->queues[i];
+    }
+}
+
+//-------------------------------------------------------------------------------
+// CLASSES
+//-------------------------------------------------------------------------------
+
+int ClassScaler::AddClass(int priority) {
+    if(GetSize() > 0) {
+        throw std::logic_error("Service classes can't change while events are scheduled.");
+    }
+    if((int)this->queues.size() == MAX_SERVICE_CLASSES) {
+        throw std::logic_error("Too many service classes.");
+    }
+    EventScaler* queue = new EventScaler();
+    queue->SetTraceLog(this->trace);
+    this->queues.push_back(queue);
+    this->priorities.push_back(priority);
+    this->heads.push_back(INFINITY);
+    this->sizes.push_back(0);
+    this->positions.push_back(-1);
+    return this->queues.size() - 1;
+}
+
+void ClassScaler::SetPriority(int service_class, int priority) {
+    if(GetSize() > 0) {
+        throw std::logic_error("Service classes can't change while events are scheduled.");
+    }
+    this->priorities.at(service_class) = priority;
+}
+
+int ClassScaler::GetClassAmount() {
+    return this->queues.size();
+}
+
+//-------------------------------------------------------------------------------
+// HEAP DE CLASSES
+//-------------------------------------------------------------------------------
+
+bool ClassScaler::Before(int a, int b) {
+    if(this->heads[a] != this->heads[b]) {
+        return this->heads[a] < this->heads[b];
+    }
+    if(this->priorities[a] != this->priorities[b]) {
+        return this->priorities[a] < this->priorities[b];
+    }
+    return a < b;
+}
+
+void ClassScaler::SwapClasses(int i, int j) {
+    std::swap(this->class_heap[i], this->class_heap[j]);
+    this->positions[this->class_heap[i]] = i;
+    this->positions[this->class_heap[j]] = j;
+}
+
+void ClassScaler::SiftUp(int i) {
+    while(i > 0 && Before(this->class_heap[i], this->class_heap[(i - 1)/2])) {
+        SwapClasses(i, (i - 1)/2);
+        i = (i - 1)/2;
+    }
+}
+
+void ClassScaler::SiftDown(int i) {
+    int amount = this->class_heap.size();
+    while(1) {
+        int earliest = i;
+        int left = 2*i + 1;
+        int right = 2*i + 2;
+        if(left < amount && Before(this->class_heap[left], this->class_heap[earliest])) {
+            earliest = left;
+        }
+        if(right < amount && Before(this->class_heap[right], this->class_heap[earliest])) {
+            earliest = right;
+        }
+        if(earliest == i) {
+            return;
+        }
+        SwapClasses(i, earliest);
+        i = earliest;
+    }
+}
+
+// Update: a cabeça pode ter avançado ou recuado (recuperação, agendamento, cancelamento ou reagendamento)
+void ClassScaler::Update(int service_class) {
+    double head = this->queues[service_class]->PeekTime();
+    this->heads[service_class] = head;
+    int size = this->queues[service_class]->GetSize();
+    this->size += size - this->sizes[service_class];
+    this->sizes[service_class] = size;
+    int position = this->positions[service_class];
+
+    if(head == INFINITY) {
+        // Fila vazia: a classe sai do heap (a última posição ocupa o seu lugar)
+        if(position >= 0) {
+            int last = this->class_heap.size() - 1;
+            SwapClasses(position, last);
+            this->class_heap.pop_back();
+            this->positions[service_class] = -1;
+            if(position < last) {
+                SiftDown(position);
+                SiftUp(position);
+            }
+        }
+        return;
+    }
+
+    if(position < 0) {
+        this->class_heap.push_back(service_class);
+        position = this->class_heap.size() - 1;
+        this->positions[service_class] = position;
+    }
+    SiftDown(position);
+    SiftUp(position);
+}
+
+//-------------------------------------------------------------------------------
+// OPERAÇÕES
+//-------------------------------------------------------------------------------
+
+EventHandle ClassScaler::ScheduleEvent(int service_class, int id, double time, EventType type) {
+    EventHandle local = this->queues.at(service_class)->ScheduleEvent(id, time, type);
+    Update(service_class);
+    return local*(EventHandle)this->queues.size() + service_class;
+}
+
+EventHandle ClassScaler::ScheduleBatch(int service_class, Event* events, int amount) {
+    EventHandle local = this->queues.at(service_class)->ScheduleBatch(events, amount);
+    Update(service_class);
+    return local*(EventHandle)this->queues.size() + service_class;
+}
+
+EventHandle ClassScaler::BatchHandle(EventHandle first, int index) {
+    return first + index*(EventHandle)this->queues.size();
+}
+
+bool ClassScaler::Cancel(EventHandle handle) {
+    if(handle < 0) {
+        return false;
+    }
+    int service_class = handle % (EventHandle)this->queues.size();
+    bool cancelled = this->queues[service_class]->Cancel(handle / (EventHandle)this->queues.size());
+    if(cancelled) {
+        Update(service_class);
+    }
+    return cancelled;
+}
+
+bool ClassScaler::Reschedule(EventHandle handle, double time) {
+    if(handle < 0) {
+        return false;
+    }
+    int service_class = handle % (EventHandle)this->queues.size();
+    bool rescheduled = this->queues[service_class]->Reschedule(handle / (EventHandle)this->queues.size(), time);
+    if(rescheduled) {
+        Update(service_class);
+    }
+    return rescheduled;
+}
+
+// GetNextEvent: próximo evento da classe na raiz do heap de classes
+Event& ClassScaler::GetNextEvent() {
+    if(this->class_heap.empty()) {
+        throw std::runtime_error("Can't recover event: no class has events.");
+    }
+    int service_class = this->class_heap[0];
+    this->nextevent = this->queues[service_class]->GetNextEvent();
+    Update(service_class);
+    return this->nextevent;
+}
+
+int ClassScaler::GetSize() {
+    return this->size;
+}
+
+void ClassScaler::Clear() {
+    for(size_t i = 0; i < this->queues.size(); i++) {
+        this->queues[i]->Clear();
+        this->heads[i] = INFINITY;
+        this->sizes[i] = 0;
+        this->positions[i] = -1;
+    }
+    this->class_heap.clear();
+    this->size = 0;
+}
+
+void ClassScaler::SetTraceLog(TraceLog* trace) {
+    this->trace = trace;
+    for(size_t i = 0; i < this->queues.size(); i++) {
+        this->queues[i]->SetTraceLog(trace);
+    }
+}
+
+int ClassScaler::GetMemoryUsage() {
+    int usage = 0;
+    for(size_t i = 0; i < this->queues.size(); i++) {
+        usage += this->queues[i]->GetMemoryUsage();
+    }
+    return usage;
+}
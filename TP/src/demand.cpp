@@ -1,67 +1,53 @@
+#include <type_traits>
 #include "demand.hpp"
 
+static_assert(std::is_trivially_copyable<Demand>::value, "Demand must be trivially copyable");
+
 // CONSTRUTOR COMPLETO
-Demand::Demand(int id, double time, double ox, double oy, double dx, double dy) {
+Demand::Demand(int id, double time, double ox, double oy, double dx, double dy, int service_class) {
     this->id = id;
+    this->service_class = service_class;
     this->time = time;
     this->origin = Point2D(ox, oy);
     this->destination = Point2D(dx, dy);
-
-    this->mem_usage = 3*sizeof(int) + 2*sizeof(Point2D);
-}
-
-// CONSTRUTOR DE CÓPIA
-Demand::Demand(const Demand& other) {
-    this->id = other.id;
-    this->time = other.time;
-    this->origin = other.origin;
-    this->destination = other.destination;
-
-    this->mem_usage = other.mem_usage; // Memória usada é a mesma
 }
 
 // GETTERS
-int Demand::GetID() {
+int Demand::GetID() const {
     return this->id;
 }
 
-double Demand::GetTime() {
+int Demand::GetClass() const {
+    return this->service_class;
+}
+
+double Demand::GetTime() const {
     return this->time;
 }
 
-Point2D& Demand::GetOrigin() {
+const Point2D& Demand::GetOrigin() const {
     return this->origin;
 }
 
-Point2D& Demand::GetDestination() {
+const Point2D& Demand::GetDestination() const {
     return this->destination;
 }
 
 // Calcula a distância entre as origens desta e de outra demanda
-double Demand::OriginDistance(Demand& other) {
+double Demand::OriginDistance(const Demand& other) const {
     return this->origin.Distance(other.GetOrigin());
 }
 
 // Calcula a distância entre os destinos desta e de outra demanda
-double Demand::DestinationDistance(Demand& other) {
+double Demand::DestinationDistance(const Demand& other) const {
     return this->destination.Distance(other.GetDestination());
 }
 
 // Calcula a distância entre a origem e o destino desta demanda
-double Demand::GetDistance() {
+double Demand::GetDistance() const {
     return this->origin.Distance(this->destination);
 }
 
-// Sobrecarga de atribuição
-void Demand::operator=(const Demand& other) {
-    this->id = other.id;
-    this->time = other.time;
-    this->origin = other.origin;
-    this->destination = other.destination;
-    
-    this->mem_usage = other.mem_usage; // Memória usada é a mesma
-}
-
 int Demand::GetMemoryUsage() {
-    return this->mem_usage;
-}
\ No newline at end of file
+    return sizeof(Demand);
+}
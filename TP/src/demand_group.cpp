@@ -1,28 +1,89 @@
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 #include "demand_group.hpp"
 
+// Resultado da checagem de um ponto contra a caixa de um grupo
+enum class BoxCheck {
+    INSIDE,     // Todas as demandas a no máximo o limite
+    OUTSIDE,    // Alguma demanda além do limite
+    UNKNOWN     // Precisa da checagem exata
+};
+
+// PlanarDistance: mesma conta de Point2D::Distance para as métricas planas
+static double PlanarDistance(double ax, double ay, double bx, double by) {
+    if(DistanceMetric::Active() == MetricType::MANHATTAN) {
+        return ManhattanMetric::Distance(ax, ay, bx, by);
+    }
+    return EuclideanMetric::Distance(ax, ay, bx, by);
+}
+
+// CheckBox: as operações em ponto flutuante são monótonas, então a distância calculada até o canto mais distante limita
+// a de qualquer demanda; e a demanda que define um lado da caixa está pelo menos tão longe quanto o ponto desse lado
+// na mesma linha do item, então basta um lado fora do limite para haver uma demanda fora
+static BoxCheck CheckBox(const double* box, const Point2D& point, double limit) {
+    double x = point.GetX(), y = point.GetY();
+    double far_x = fabs(box[0] - x) >= fabs(box[2] - x) ? box[0] : box[2];
+    double far_y = fabs(box[1] - y) >= fabs(box[3] - y) ? box[1] : box[3];
+    if(PlanarDistance(far_x, far_y, x, y) <= limit) {
+        return BoxCheck::INSIDE;
+    }
+    if(PlanarDistance(box[0], y, x, y) > limit || PlanarDistance(box[2], y, x, y) > limit
+        || PlanarDistance(x, box[1], x, y) > limit || PlanarDistance(x, box[3], x, y) > limit) {
+        return BoxCheck::OUTSIDE;
+    }
+    return BoxCheck::UNKNOWN;
+}
+
+// Expand: acrescenta um ponto à caixa
+static void Expand(double* box, const Point2D& point) {
+    box[0] = std::min(box[0], point.GetX());
+    box[1] = std::min(box[1], point.GetY());
+    box[2] = std::max(box[2], point.GetX());
+    box[3] = std::max(box[3], point.GetY());
+}
+
 // CONSTRUTOR: inicializa o contador como 0 e cria o grupo com o tamanho máximo passado
-DemandGroup::DemandGroup(int max_size) : item_counter(0) {
+DemandGroup::DemandGroup(int max_size) : item_counter(0), stable(0) {
     this->max_size = max_size;
     this->group = new Demand[max_size];
+    this->owns_group = true;
+    RecomputeBoxes();
 
     // Controle de memória
-    this->mem_usage = 4*sizeof(int) + sizeof(Demand*) + sizeof(Demand)*max_size;
+    this->mem_usage = 5*sizeof(int) + sizeof(Demand*) + sizeof(Demand)*max_size + 8*sizeof(double);
+}
+
+// CONSTRUTOR COM ARMAZENAMENTO EXTERNO: usa o vetor passado (que pertence a quem chamou) em vez de alocar um
+DemandGroup::DemandGroup(Demand* storage, int max_size) : item_counter(0), stable(0) {
+    this->max_size = max_size;
+    this->group = storage;
+    this->owns_group = false;
+    RecomputeBoxes();
+
+    // Controle de memória: as demandas estão embutidas no objeto
+    this->mem_usage = 5*sizeof(int) + sizeof(Demand*) + sizeof(Demand)*max_size + 8*sizeof(double);
 }
 
 // DESTRUTOR: apaga todas as demandas alocadas dinamicamente
 DemandGroup::~DemandGroup() {
-    delete[] this->group;
+    if(this->owns_group) {
+        delete[] this->group;
+    }
 }
 
 // Insert: insere um item caso o grupo já não esteja cheio e retorna o índice onde foi inserido
+// (a posição sobrescrita deixa de ser estável, caso ainda guardasse uma demanda anterior a Remove/Clear)
 int DemandGroup::Insert(Demand& item) {
     if(this->item_counter >= this->max_size) {
         throw std::out_of_range("DemandGroup: trying to insert in a full group.");
     }
     else {
+        this->stable = std::min(this->stable, this->item_counter);
         this->group[this->item_counter] = item;
         this->item_counter++;
+        Expand(this->origin_box, item.GetOrigin());
+        Expand(this->destination_box, item.GetDestination());
         return this->item_counter - 1;
     }
 }
@@ -34,6 +95,7 @@ int DemandGroup::Remove() {
     }
     else {
         this->item_counter--;
+        RecomputeBoxes();
         return this->item_counter;
     }
 }
@@ -59,9 +121,111 @@ bool DemandGroup::IsFull() {
     return this->item_counter == this->max_size;
 }
 
+// Capacity: retorna o tamanho máximo do grupo (capacidade do veículo)
+int DemandGroup::Capacity() {
+    return this->max_size;
+}
+
 // Clear: apaga todas as demandas e reinicia o contador
 void DemandGroup::Clear() {
     this->item_counter = 0;
+    RecomputeBoxes();
+}
+
+// RecomputeBoxes: caixas vazias (mínimos em +infinito) quando não há demandas
+void DemandGroup::RecomputeBoxes() {
+    this->origin_box[0] = this->origin_box[1] = this->destination_box[0] = this->destination_box[1] = INFINITY;
+    this->origin_box[2] = this->origin_box[3] = this->destination_box[2] = this->destination_box[3] = -INFINITY;
+    for(int i = 0; i < this->item_counter; i++) {
+        Expand(this->origin_box, this->group[i].GetOrigin());
+        Expand(this->destination_box, this->group[i].GetDestination());
+    }
+}
+
+// CheckBoxes: com métrica plana, as caixas resolvem sem percorrer o grupo quando o resultado não depende da ordem das
+// demandas: tudo compatível, ou só um dos critérios falhando (se os dois falham, o primeiro a falhar no laço decide).
+// Retorna false se for preciso o laço
+bool DemandGroup::CheckBoxes(Demand& item, double alpha, double beta, DistanceCheck& result) {
+    if(this->item_counter == 0 || !DistanceMetric::IsPlanar()) {
+        return false;
+    }
+    BoxCheck origins = CheckBox(this->origin_box, item.GetOrigin(), alpha);
+    BoxCheck destinations = CheckBox(this->destination_box, item.GetDestination(), beta);
+    if(origins == BoxCheck::INSIDE && destinations == BoxCheck::INSIDE) {
+        result = DistanceCheck::COMPATIBLE;
+        return true;
+    }
+    if(origins == BoxCheck::OUTSIDE && destinations == BoxCheck::INSIDE) {
+        result = DistanceCheck::ORIGIN_TOO_FAR;
+        return true;
+    }
+    if(origins == BoxCheck::INSIDE && destinations == BoxCheck::OUTSIDE) {
+        result = DistanceCheck::DESTINATION_TOO_FAR;
+        return true;
+    }
+    return false;
+}
+
+// CheckDistances: confere se o item está a no máximo alpha da origem e beta do destino de cada demanda do grupo
+DistanceCheck DemandGroup::CheckDistances(Demand& item, double alpha, double beta) {
+    DistanceCheck result;
+    if(CheckBoxes(item, alpha, beta, result)) {
+        return result;
+    }
+
+    for(int i = 0; i < this->item_counter; i++) {
+        double orig_dist = this->group[i].OriginDistance(item);
+        double dest_dist = this->group[i].DestinationDistance(item);
+
+        if(orig_dist > alpha) {
+            return DistanceCheck::ORIGIN_TOO_FAR;
+        }
+        if(dest_dist > beta) {
+            return DistanceCheck::DESTINATION_TOO_FAR;
+        }
+    }
+    return DistanceCheck::COMPATIBLE;
+}
+
+// Efficiency: soma das distâncias individuais dividida pela distância da rota (coletas em ordem, depois entregas em ordem)
+// As somas seguem a mesma ordem dos segmentos de Ride, então o resultado é idêntico ao de Ride::GetEfficiency
+double DemandGroup::Efficiency() {
+    int size = this->item_counter;
+    double dist = 0;
+    for(int i = 0; i + 1 < size; i++) {
+        dist += this->group[i].GetOrigin().Distance(this->group[i + 1].GetOrigin());
+    }
+    dist += this->group[size - 1].GetOrigin().Distance(this->group[0].GetDestination());
+    for(int i = 0; i + 1 < size; i++) {
+        dist += this->group[i].GetDestination().Distance(this->group[i + 1].GetDestination());
+    }
+
+    double individual_dist = 0;
+    for(int i = 0; i < size; i++) {
+        individual_dist += this->group[i].GetDistance();
+    }
+    return individual_dist/dist;
+}
+
+// SegmentDistance: mesma distância que Segment calcula entre as paradas correspondentes de Ride
+double DemandGroup::SegmentDistance(int index) {
+    int size = this->item_counter;
+    if(index < size - 1) {
+        return this->group[index].GetOrigin().Distance(this->group[index + 1].GetOrigin());
+    }
+    if(index == size - 1) {
+        return this->group[size - 1].GetOrigin().Distance(this->group[0].GetDestination());
+    }
+    return this->group[index - size].GetDestination().Distance(this->group[index - size + 1].GetDestination());
+}
+
+// IndividualDistance: soma na ordem das demandas (a mesma de Ride)
+double DemandGroup::IndividualDistance() {
+    double individual_dist = 0;
+    for(int i = 0; i < this->item_counter; i++) {
+        individual_dist += this->group[i].GetDistance();
+    }
+    return individual_dist;
 }
 
 // GetMemUsage: retorna quanto de memória este objeto consome, incluindo as demandas alocadas dinamicamente
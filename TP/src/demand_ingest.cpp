@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include "demand_ingest.hpp"
+
+//-------------------------------------------------------------------------------
+// CONSTRUTOR E DESTRUTOR
+//-------------------------------------------------------------------------------
+
+DemandIngest::DemandIngest(Manager& manager, int producers, double max_lag, size_t queue_capacity) : manager(manager) {
+    if(producers < 1) {
+        throw std::invalid_argument("DemandIngest needs at least one producer.");
+    }
+    size_t size = 1;
+    while(size < queue_capacity) {
+        size <<= 1;
+    }
+    for(int i = 0; i < producers; i++) {
+        // Em C++11, new não respeita o alinhamento de 64 bytes dos contadores: memória alinhada e construção no lugar
+        void* memory;
+        if(posix_memalign(&memory, alignof(Source), sizeof(Source)) != 0) {
+            throw std::bad_alloc();
+        }
+        Source* source = new(memory) Source();
+        this->sources.push_back(source);
+        source->slots.resize(size);
+        source->mask = size - 1;
+        source->head.store(0);
+        source->tail.store(0);
+        source->watermark.store(-INFINITY);
+        source->closed.store(false);
+    }
+    this->max_lag = max_lag;
+    this->newest = -INFINITY;
+    this->released = -INFINITY;
+    this->late_demands = 0;
+    this->rejected_demands = 0;
+}
+
+DemandIngest::~DemandIngest() {
+    if(this->dispatcher.joinable()) {
+        this->dispatcher.join();
+    }
+    for(size_t i = 0; i < this->sources.size(); i++) {
+        this->sources[i]->~Source();
+        free(this->sources[i]);
+    }
+}
+
+//-------------------------------------------------------------------------------
+// FONTES
+//-------------------------------------------------------------------------------
+
+// Submit: grava no slot, publica a posição e só então avança a marca d'água (quem vê a marca já vê a demanda)
+void DemandIngest::Submit(int producer, const Demand& demand) {
+    Source& source = *this->sources[producer];
+    uint64_t tail = source.tail.load(std::memory_order_relaxed);
+    while(tail - source.head.load(std::memory_order_acquire) == source.slots.size()) {
+        std::this_thread::yield();
+    }
+    source.slots[tail & source.mask] = demand;
+    source.tail.store(tail + 1, std::memory_order_release);
+    Advance(producer, demand.GetTime());
+}
+
+void DemandIngest::Advance(int producer, double time) {
+    Source& source = *this->sources[producer];
+    if(time > source.watermark.load(std::memory_order_relaxed)) {
+        source.watermark.store(time, std::memory_order_release);
+    }
+}
+
+void DemandIngest::Close(int producer) {
+    this->sources[producer]->closed.store(true, std::memory_order_release);
+}
+
+//-------------------------------------------------------------------------------
+// DESPACHO
+//-------------------------------------------------------------------------------
+
+void DemandIngest::Start() {
+    this->dispatcher = std::thread(&DemandIngest::Run, this);
+}
+
+void DemandIngest::Finish() {
+    if(this->dispatcher.joinable()) {
+        this->dispatcher.join();
+    }
+    if(!this->error.empty()) {
+        throw std::runtime_error("DemandIngest: " + this->error);
+    }
+}
+
+int DemandIngest::GetLateDemands() {
+    return this->late_demands;
+}
+
+int DemandIngest::GetRejectedDemands() {
+    return this->rejected_demands;
+}
+
+int DemandIngest::GetProducers() {
+    return this->sources.size();
+}
+
+// Deliver: depois de um erro do Manager, as demandas são descartadas sem entrega
+void DemandIngest::Deliver(const Demand& demand) {
+    if(!this->error.empty()) {
+        return;
+    }
+    if(this->manager.MakeDemand(demand.GetID(), demand.GetTime(), demand.GetOrigin().GetX(), demand.GetOrigin().GetY(),
+                                demand.GetDestination().GetX(), demand.GetDestination().GetY(), demand.GetClass()) < 0) {
+        this->rejected_demands++;
+    }
+}
+
+// Drain: demandas anteriores à última entregue não podem mais ser reordenadas e seguem direto para o Manager
+bool DemandIngest::Drain(Source& source) {
+    uint64_t head = source.head.load(std::memory_order_relaxed);
+    uint64_t tail = source.tail.load(std::memory_order_acquire);
+    if(head == tail) {
+        return false;
+    }
+    for(; head < tail; head++) {
+        Demand& demand = source.slots[head & source.mask];
+        if(demand.GetTime() < this->released) {
+            this->late_demands++;
+            Deliver(demand);
+        }
+        else {
+            this->newest = std::max(this->newest, demand.GetTime());
+            this->reorder.push(demand);
+        }
+    }
+    source.head.store(tail, std::memory_order_release);
+    return true;
+}
+
+// Run: a cada volta, lê a marca d'água e o fechamento de cada fonte *antes* de esvaziar a fila dela, então toda demanda
+// coberta pela marca (ou enviada antes do fechamento) já está no buffer quando o limite de entrega é calculado.
+// Depois de um erro do Manager, as filas continuam sendo esvaziadas (sem entrega) para as fontes não ficarem bloqueadas
+void DemandIngest::Run() {
+    while(1) {
+        bool open = false;
+        bool moved = false;
+        double limit = INFINITY;
+        try {
+            for(size_t i = 0; i < this->sources.size(); i++) {
+                Source& source = *this->sources[i];
+                bool closed = source.closed.load(std::memory_order_acquire);
+                double watermark = source.watermark.load(std::memory_order_acquire);
+                moved = Drain(source) || moved;
+                if(!closed) {
+                    limit = std::min(limit, watermark);
+                    open = true;
+                }
+            }
+            if(this->max_lag >= 0) {
+                limit = std::max(limit, this->newest - this->max_lag);
+            }
+
+            while(!this->reorder.empty() && (!open || this->reorder.top().GetTime() <= limit)) {
+                const Demand& demand = this->reorder.top();
+                this->released = demand.GetTime();
+                Deliver(demand);
+                this->reorder.pop();
+                moved = true;
+            }
+        }
+        catch(const std::exception& e) {
+            this->error = e.what();
+            continue;
+        }
+
+        if(!open) {
+            return;
+        }
+        if(!moved) {
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+#include <unistd.h>
+#include "demand_sorter.hpp"
+
+static const size_t MIN_BUFFER = 1024;         // Demandas mínimas no vetor de acumulação, mesmo com limite muito baixo
+static const size_t MIN_BLOCK = 256;           // Demandas mínimas por bloco de leitura; abaixo disso a intercalação é feita em passadas
+
+//-------------------------------------------------------------------------------
+// FUNÇÕES AUXILIARES
+//-------------------------------------------------------------------------------
+
+// Less: ordem de (tempo, id)
+bool DemandSorter::Less(const Demand& a, const Demand& b) {
+    if(a.GetTime() != b.GetTime()) {
+        return a.GetTime() < b.GetTime();
+    }
+    return a.GetID() < b.GetID();
+}
+
+// OpenTemp: arquivo temporário no diretório configurado; o nome é removido logo após a criação, então o espaço é
+// liberado ao fechar o arquivo (inclusive se o processo terminar antes)
+FILE* DemandSorter::OpenTemp() {
+    std::string path = this->temp_dir + "/dispatch_sort_XXXXXX";
+    std::vector<char> name(path.begin(), path.end());
+    name.push_back('\0');
+
+    int fd = mkstemp(name.data());
+    if(fd < 0) {
+        throw std::runtime_error("DemandSorter: can't create temporary file in " + this->temp_dir);
+    }
+    unlink(name.data());
+    FILE* file = fdopen(fd, "w+b");
+    if(file == nullptr) {
+        close(fd);
+        throw std::runtime_error("DemandSorter: can't open temporary file.");
+    }
+    return file;
+}
+
+// Spill: ordena o vetor (se a entrada não estiver em ordem) e grava-o como uma sequência
+void DemandSorter::Spill() {
+    if(this->buffer.empty()) {
+        return;
+    }
+    if(!this->in_order) {
+        std::stable_sort(this->buffer.begin(), this->buffer.end(), Less);
+    }
+
+    Run run;
+    run.file = OpenTemp();
+    run.amount = this->buffer.size();
+    run.consumed = 0;
+    run.head = 0;
+    if(fwrite(this->buffer.data(), sizeof(Demand), this->buffer.size(), run.file) != this->buffer.size()) {
+        fclose(run.file);
+        throw std::runtime_error("DemandSorter: can't write temporary file.");
+    }
+    rewind(run.file);
+    this->runs.push_back(run);
+    this->buffer.clear();
+}
+
+// Fill: lê até block_size demandas da sequência para o bloco
+bool DemandSorter::Fill(Run& run, size_t block_size) {
+    size_t amount = std::min<long>(block_size, run.amount - run.consumed);
+    run.block.resize(amount);
+    run.head = 0;
+    if(amount == 0) {
+        return false;
+    }
+    if(fread(run.block.data(), sizeof(Demand), amount, run.file) != amount) {
+        throw std::runtime_error("DemandSorter: can't read temporary file.");
+    }
+    run.consumed += amount;
+    return true;
+}
+
+// HeapifyDown: restaura o min-heap de sequências a partir de i, pela demanda na cabeça
+void DemandSorter::HeapifyDown(size_t i) {
+    while(true) {
+        size_t earliest = i;
+        size_t left = 2*i + 1;
+        size_t right = 2*i + 2;
+        if(left < this->heap.size() && Less(this->runs[heap[left]].block[runs[heap[left]].head], this->runs[heap[earliest]].block[runs[heap[earliest]].head])) {
+            earliest = left;
+        }
+        if(right < this->heap.size() && Less(this->runs[heap[right]].block[runs[heap[right]].head], this->runs[heap[earliest]].block[runs[heap[earliest]].head])) {
+            earliest = right;
+        }
+        if(earliest == i) {
+            return;
+        }
+        std::swap(this->heap[i], this->heap[earliest]);
+        i = earliest;
+    }
+}
+
+// MergeRuns: intercala amount sequências (a partir de first) em uma nova sequência, gravada no fim da lista
+void DemandSorter::MergeRuns(size_t first, size_t amount) {
+    size_t block_size = std::max(MIN_BLOCK, this->memory_limit/sizeof(Demand)/(amount + 1));
+
+    this->heap.clear();
+    for(size_t i = first; i < first + amount; i++) {
+        if(Fill(this->runs[i], block_size)) {
+            this->heap.push_back(i);
+        }
+    }
+    for(size_t i = this->heap.size()/2; i-- > 0; ) {
+        HeapifyDown(i);
+    }
+
+    Run merged;
+    merged.file = OpenTemp();
+    merged.amount = 0;
+    merged.consumed = 0;
+    merged.head = 0;
+    std::vector<Demand> output;
+    output.reserve(block_size);
+
+    while(!this->heap.empty()) {
+        Run& run = this->runs[this->heap[0]];
+        output.push_back(run.block[run.head++]);
+        if(run.head == run.block.size() && !Fill(run, block_size)) {
+            this->heap[0] = this->heap.back();
+            this->heap.pop_back();
+        }
+        if(!this->heap.empty()) {
+            HeapifyDown(0);
+        }
+
+        if(output.size() == block_size || this->heap.empty()) {
+            if(fwrite(output.data(), sizeof(Demand), output.size(), merged.file) != output.size()) {
+                throw std::runtime_error("DemandSorter: can't write temporary file.");
+            }
+            merged.amount += output.size();
+            output.clear();
+        }
+    }
+    rewind(merged.file);
+
+    // As sequências intercaladas são fechadas (e seus arquivos liberados)
+    for(size_t i = first; i < first + amount; i++) {
+        fclose(this->runs[i].file);
+        this->runs[i].file = nullptr;
+        std::vector<Demand>().swap(this->runs[i].block);
+    }
+    this->runs.push_back(merged);
+}
+
+//-------------------------------------------------------------------------------
+// CONSTRUTOR E DESTRUTOR
+//-------------------------------------------------------------------------------
+
+DemandSorter::DemandSorter(size_t memory_limit, const std::string& temp_dir) {
+    this->memory_limit = memory_limit;
+    this->temp_dir = temp_dir;
+    this->buffer_capacity = std::max(MIN_BUFFER, memory_limit/sizeof(Demand));
+    this->in_order = true;
+    this->has_last = false;
+    this->finished = false;
+    this->position = 0;
+    this->block_size = MIN_BLOCK;
+}
+
+DemandSorter::~DemandSorter() {
+    for(size_t i = 0; i < this->runs.size(); i++) {
+        if(this->runs[i].file != nullptr) {
+            fclose(this->runs[i].file);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------
+// OPERAÇÕES/MÉTODOS
+//-------------------------------------------------------------------------------
+
+// Add: acumula a demanda, acompanhando se a entrada continua em ordem; com o vetor cheio, grava uma sequência
+void DemandSorter::Add(const Demand& demand) {
+    if(this->finished) {
+        throw std::logic_error("DemandSorter: input already finished.");
+    }
+    if(this->has_last && Less(demand, this->last)) {
+        this->in_order = false;
+    }
+    this->last = demand;
+    this->has_last = true;
+
+    this->buffer.push_back(demand);
+    if(this->buffer.size() >= this->buffer_capacity) {
+        Spill();
+    }
+}
+
+// Finish: sem gravações, o vetor é ordenado em memória (se preciso); com gravações, o restante vira a última sequência
+// e as sequências são reduzidas por passadas até que todas caibam na intercalação final
+void DemandSorter::Finish() {
+    if(this->finished) {
+        return;
+    }
+    this->finished = true;
+
+    if(this->runs.empty()) {
+        if(!this->in_order) {
+            std::stable_sort(this->buffer.begin(), this->buffer.end(), Less);
+        }
+        return;
+    }
+
+    // Entrada em ordem: cada sequência continua a anterior, então basta lê-las uma após a outra
+    Spill();
+    std::vector<Demand>().swap(this->buffer);
+    if(this->in_order) {
+        this->block_size = std::max(MIN_BLOCK, this->memory_limit/sizeof(Demand));
+        return;
+    }
+
+    size_t fan_in = std::max<size_t>(2, this->memory_limit/sizeof(Demand)/MIN_BLOCK - 1);
+    size_t first = 0;
+    while(this->runs.size() - first > fan_in) {
+        MergeRuns(first, fan_in);
+        first += fan_in;
+    }
+
+    // Intercalação final: as sequências restantes, lidas em blocos, com as cabeças no min-heap
+    size_t active = this->runs.size() - first;
+    this->block_size = std::max(MIN_BLOCK, this->memory_limit/sizeof(Demand)/active);
+    this->heap.clear();
+    for(size_t i = first; i < this->runs.size(); i++) {
+        if(Fill(this->runs[i], this->block_size)) {
+            this->heap.push_back(i);
+        }
+    }
+    for(size_t i = this->heap.size()/2; i-- > 0; ) {
+        HeapifyDown(i);
+    }
+}
+
+// Next: próxima demanda do vetor, das sequências em ordem (entrada ordenada) ou da intercalação
+bool DemandSorter::Next(Demand& demand) {
+    Finish();
+
+    if(this->runs.empty()) {
+        if(this->position == this->buffer.size()) {
+            return false;
+        }
+        demand = this->buffer[this->position++];
+        return true;
+    }
+
+    if(this->in_order) {
+        // Sequências lidas uma após a outra, uma de cada vez
+        while(this->position < this->runs.size()) {
+            Run& run = this->runs[this->position];
+            if(run.head < run.block.size() || Fill(run, this->block_size)) {
+                demand = run.block[run.head++];
+                return true;
+            }
+            fclose(run.file);
+            run.file = nullptr;
+            std::vector<Demand>().swap(run.block);
+            this->position++;
+        }
+        return false;
+    }
+
+    if(this->heap.empty()) {
+        return false;
+    }
+    Run& run = this->runs[this->heap[0]];
+    demand = run.block[run.head++];
+    if(run.head == run.block.size() && !Fill(run, this->block_size)) {
+        this->heap[0] = this->heap.back();
+        this->heap.pop_back();
+    }
+    if(!this->heap.empty()) {
+        HeapifyDown(0);
+    }
+    return true;
+}
+
+bool DemandSorter::WasInOrder() {
+    return this->in_order;
+}
+
+int DemandSorter::GetRunAmount() {
+    return this->runs.size();
+}
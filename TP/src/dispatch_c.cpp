@@ -0,0 +1,337 @@
+#include <string>
+#include <vector>
+#include <exception>
+#include "dispatch_c.h"
+#include "simulation_manager.hpp"
+#include "demand_ingest.hpp"
+
+// Estado de uma simulação embutida: o Manager e a mensagem do último erro
+struct DispatchManager {
+    Manager* manager;
+    DemandIngest* ingest;   // Entrada concorrente ativa (nullptr se não houver)
+    bool started;           // Marca se a coleta de corridas já começou (não se aceitam mais demandas)
+    std::string error;
+};
+
+// FinishIngest: aguarda a entrada concorrente (se houver) terminar, antes de outra thread usar o Manager
+static void FinishIngest(DispatchManager* dm) {
+    if(dm->ingest != nullptr) {
+        DemandIngest* ingest = dm->ingest;
+        dm->ingest = nullptr;
+        try {
+            ingest->Finish();
+        }
+        catch(...) {
+            delete ingest;
+            throw;
+        }
+        delete ingest;
+    }
+}
+
+// Start: marca o início da coleta de corridas
+static void Start(DispatchManager* dm) {
+    dm->started = true;
+    FinishIngest(dm);
+}
+
+// ValidProducer: fonte existente de uma entrada concorrente ativa
+static bool ValidProducer(DispatchManager* dm, int producer) {
+    return dm != nullptr && dm->ingest != nullptr && producer >= 0 && producer < dm->ingest->GetProducers();
+}
+
+// Fill: copia os dados de uma corrida concluída para a estrutura da interface C
+static void Fill(DispatchManager* dm, int index, DispatchRide* out) {
+    Ride* ride = dm->manager->GetRide(index);
+    out->ride = index;
+    out->stop_count = ride->GetStopAmount();
+    out->start = ride->GetStart();
+    out->end = ride->GetEnd();
+    out->distance = ride->GetDistance();
+    out->efficiency = ride->GetEfficiency();
+}
+
+//-------------------------------------------------------------------------------
+// CRIAÇÃO E DESTRUIÇÃO
+//-------------------------------------------------------------------------------
+
+int dispatch_abi_version(void) {
+    return DISPATCH_ABI_VERSION;
+}
+
+DispatchManager* dispatch_create(int eta, double gamma, double delta, double alpha, double beta, float lambda, int demands) {
+    try {
+        DispatchManager* dm = new DispatchManager();
+        dm->manager = new Manager(eta, gamma, delta, alpha, beta, lambda, demands);
+        dm->ingest = nullptr;
+        dm->started = false;
+        return dm;
+    }
+    catch(...) {
+        return nullptr;
+    }
+}
+
+void dispatch_destroy(DispatchManager* dm) {
+    if(dm != nullptr) {
+        delete dm->ingest;
+        delete dm->manager;
+        delete dm;
+    }
+}
+
+//-------------------------------------------------------------------------------
+// DEMANDAS E CORRIDAS
+//-------------------------------------------------------------------------------
+
+int dispatch_submit(DispatchManager* dm, int amount, const int* ids, const double* times,
+                    const double* origin_x, const double* origin_y, const double* destination_x, const double* destination_y) {
+    if(dm == nullptr) {
+        return -1;
+    }
+    dm->error.clear();
+    if(dm->started) {
+        dm->error = "Demands can't be submitted after rides were collected.";
+        return -1;
+    }
+    if(dm->ingest != nullptr) {
+        dm->error = "Demands are being submitted through the concurrent ingest.";
+        return -1;
+    }
+    if(amount < 0 || (amount > 0 && (ids == nullptr || times == nullptr || origin_x == nullptr || origin_y == nullptr
+        || destination_x == nullptr || destination_y == nullptr))) {
+        dm->error = "Invalid demand batch.";
+        return -1;
+    }
+
+    // As demandas anteriores à recusada continuam na simulação: o chamador reenvia a partir da posição retornada
+    try {
+        int accepted = dm->manager->MakeDemands(amount, ids, times, origin_x, origin_y, destination_x, destination_y);
+        if(accepted < amount) {
+            dm->error = "Demand " + std::to_string(ids[accepted]) + " was rejected.";
+        }
+        return accepted;
+    }
+    catch(const std::exception& e) {
+        dm->error = e.what();
+        return -1;
+    }
+}
+
+int dispatch_poll(DispatchManager* dm, DispatchRide* buffer, int capacity) {
+    if(dm == nullptr) {
+        return -1;
+    }
+    dm->error.clear();
+    if(capacity < 0 || (capacity > 0 && buffer == nullptr)) {
+        dm->error = "Invalid ride buffer.";
+        return -1;
+    }
+
+    try {
+        Start(dm);
+        int filled = 0;
+        int index;
+        while(filled < capacity && (index = dm->manager->NextFinishedRide()) >= 0) {
+            Fill(dm, index, &buffer[filled++]);
+        }
+        return filled;
+    }
+    catch(const std::exception& e) {
+        dm->error = e.what();
+        return -1;
+    }
+}
+
+int dispatch_run(DispatchManager* dm, DispatchRideCallback callback, void* user_data) {
+    if(dm == nullptr) {
+        return -1;
+    }
+    dm->error.clear();
+
+    try {
+        Start(dm);
+        int delivered = 0;
+        int index;
+        while((index = dm->manager->NextFinishedRide()) >= 0) {
+            DispatchRide ride;
+            Fill(dm, index, &ride);
+            if(callback != nullptr) {
+                callback(&ride, user_data);
+            }
+            delivered++;
+        }
+        return delivered;
+    }
+    catch(const std::exception& e) {
+        dm->error = e.what();
+        return -1;
+    }
+}
+
+int dispatch_ride_stop(DispatchManager* dm, int ride, int index, int* demand_id, double* x, double* y) {
+    if(dm == nullptr) {
+        return -1;
+    }
+    dm->error.clear();
+
+    try {
+        Stop& stop = dm->manager->GetRide(ride)->GetStop(index);
+        if(demand_id != nullptr) {
+            *demand_id = stop.GetDemandID();
+        }
+        if(x != nullptr) {
+            *x = stop.GetPoint().GetX();
+        }
+        if(y != nullptr) {
+            *y = stop.GetPoint().GetY();
+        }
+        return 0;
+    }
+    catch(const std::exception& e) {
+        dm->error = e.what();
+        return -1;
+    }
+}
+
+int dispatch_active_rides(DispatchManager* dm, double from, double to, int* rides, int capacity) {
+    if(dm == nullptr) {
+        return -1;
+    }
+    dm->error.clear();
+    if(capacity < 0 || (capacity > 0 && rides == nullptr)) {
+        dm->error = "Invalid ride buffer.";
+        return -1;
+    }
+
+    try {
+        Start(dm);
+        RideIndex& index = dm->manager->GetRideIndex();
+        if(capacity == 0) {
+            return index.CountOverlapping(from, to);
+        }
+        std::vector<int> found;
+        index.QueryRange(from, to, found);
+        for(int i = 0; i < capacity && i < (int)found.size(); i++) {
+            rides[i] = found[i];
+        }
+        return found.size();
+    }
+    catch(const std::exception& e) {
+        dm->error = e.what();
+        return -1;
+    }
+}
+
+int dispatch_max_concurrent(DispatchManager* dm, double* time) {
+    if(dm == nullptr) {
+        return -1;
+    }
+    dm->error.clear();
+
+    try {
+        Start(dm);
+        RideIndex& index = dm->manager->GetRideIndex();
+        if(time != nullptr) {
+            *time = index.GetMaxConcurrentTime();
+        }
+        return index.GetMaxConcurrent();
+    }
+    catch(const std::exception& e) {
+        dm->error = e.what();
+        return -1;
+    }
+}
+
+int dispatch_cancel(DispatchManager* dm, int demand_id, double time) {
+    if(dm == nullptr) {
+        return -1;
+    }
+    dm->error.clear();
+
+    try {
+        FinishIngest(dm);
+        dm->manager->CancelDemand(demand_id, time);
+        return 0;
+    }
+    catch(const std::exception& e) {
+        dm->error = e.what();
+        return -1;
+    }
+}
+
+int dispatch_delay(DispatchManager* dm, int ride, double time, double delay) {
+    if(dm == nullptr) {
+        return -1;
+    }
+    dm->error.clear();
+
+    try {
+        FinishIngest(dm);
+        dm->manager->DelayRide(ride, time, delay);
+        return 0;
+    }
+    catch(const std::exception& e) {
+        dm->error = e.what();
+        return -1;
+    }
+}
+
+//-------------------------------------------------------------------------------
+// ENTRADA CONCORRENTE
+//-------------------------------------------------------------------------------
+
+int dispatch_ingest_start(DispatchManager* dm, int producers, double max_lag) {
+    if(dm == nullptr) {
+        return -1;
+    }
+    dm->error.clear();
+    if(dm->started || dm->ingest != nullptr) {
+        dm->error = "The concurrent ingest can only be started once, before rides are collected.";
+        return -1;
+    }
+
+    try {
+        dm->ingest = new DemandIngest(*dm->manager, producers, max_lag);
+        dm->ingest->Start();
+        return 0;
+    }
+    catch(const std::exception& e) {
+        delete dm->ingest;
+        dm->ingest = nullptr;
+        dm->error = e.what();
+        return -1;
+    }
+}
+
+int dispatch_ingest_submit(DispatchManager* dm, int producer, int amount, const int* ids, const double* times,
+                           const double* origin_x, const double* origin_y, const double* destination_x, const double* destination_y) {
+    if(!ValidProducer(dm, producer) || amount < 0 || (amount > 0 && (ids == nullptr || times == nullptr || origin_x == nullptr
+        || origin_y == nullptr || destination_x == nullptr || destination_y == nullptr))) {
+        return -1;
+    }
+    for(int i = 0; i < amount; i++) {
+        dm->ingest->Submit(producer, Demand(ids[i], times[i], origin_x[i], origin_y[i], destination_x[i], destination_y[i]));
+    }
+    return amount;
+}
+
+int dispatch_ingest_advance(DispatchManager* dm, int producer, double time) {
+    if(!ValidProducer(dm, producer)) {
+        return -1;
+    }
+    dm->ingest->Advance(producer, time);
+    return 0;
+}
+
+int dispatch_ingest_close(DispatchManager* dm, int producer) {
+    if(!ValidProducer(dm, producer)) {
+        return -1;
+    }
+    dm->ingest->Close(producer);
+    return 0;
+}
+
+const char* dispatch_last_error(DispatchManager* dm) {
+    return dm == nullptr ? "Null manager." : dm->error.c_str();
+}
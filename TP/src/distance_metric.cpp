@@ -0,0 +1,33 @@
+#include <stdexcept>
+#include "distance_metric.hpp"
+#include "2D_point.hpp"
+
+// Métrica ativa: euclidiana por padrão
+MetricType DistanceMetric::active = MetricType::EUCLIDEAN;
+RoadOracle* DistanceMetric::oracle = nullptr;
+
+// Use: seleciona a métrica usada por Point2D::Distance
+void DistanceMetric::Use(MetricType type) {
+    if(type == MetricType::ROAD && oracle == nullptr) {
+        throw std::logic_error("DistanceMetric: road metric selected without an oracle.");
+    }
+#if defined(POINT_FIXED32) || defined(POINT_FLOAT32)
+    // Os modos compactos guardam as coordenadas ao centésimo da unidade: em graus, erro de até 0.005° (cerca de 556 m)
+    if(type == MetricType::HAVERSINE) {
+        throw std::logic_error("DistanceMetric: haversine needs the default (double) coordinates.");
+    }
+#endif
+    active = type;
+}
+
+// UseRoadOracle: registra o oráculo da malha viária e passa a usá-lo
+void DistanceMetric::UseRoadOracle(RoadOracle* road_oracle) {
+    oracle = road_oracle;
+    active = (road_oracle != nullptr) ? MetricType::ROAD : MetricType::EUCLIDEAN;
+}
+
+// IsPlanar: distâncias euclidianas e de Manhattan nunca são menores que a separação em cada eixo, então caixas
+// delimitadoras alinhadas aos eixos dão limites válidos para elas (mas não para haversine ou para a malha)
+bool DistanceMetric::IsPlanar() {
+    return active == MetricType::EUCLIDEAN || active == MetricType::MANHATTAN;
+}
@@ -1,35 +1,25 @@
+#include <type_traits>
 #include "event.hpp"
 
-// Construtor padrão: inicializa os atributos com os valores fornecidos
-Event::Event(int id, double time, EventType type) : id(id), time(time), type(type) { 
-    this->mem_usage = sizeof(int)*2 + sizeof(double) + sizeof(EventType);
-}
+static_assert(std::is_trivially_copyable<Event>::value, "Event must be trivially copyable");
 
-// Construtor de cópia: inicializa os atributos com os valores do outro objeto
-Event::Event(Event& other) 
-    : id(other.id), time(other.time), type(other.type), mem_usage(other.mem_usage) { }
+// Construtor padrão: inicializa os atributos com os valores fornecidos
+Event::Event(int id, double time, EventType type) : time(time), id(id), type(type) { }
 
 // Getters
-int Event::GetID() {
+int Event::GetID() const {
     return this->id;
 }
 
-double Event::GetTime() {
+double Event::GetTime() const {
     return this->time;
 }
 
-EventType Event::GetType() {
+EventType Event::GetType() const {
     return this->type;
 }
 
-// Sobrecarga de atribuição para cópia
-void Event::operator=(const Event& other) {
-    this->id = other.id;
-    this->time = other.time;
-    this->type = other.type;
-}
-
-// Retorna a memória usada pelo objeto
+// Retorna a memória usada por um evento
 int Event::GetMemoryUsage() {
-    return this->mem_usage;
-}
\ No newline at end of file
+    return sizeof(Event);
+}
@@ -1,7 +1,17 @@
 #include <stdexcept>
 #include <cmath>
 #include <fstream>
+#include <algorithm>
+#include <cstring>
 #include "event_scaler.hpp"
+#include "trace_log.hpp"
+
+// Situação de uma vaga fora do min-heap
+static const int GONE = -1;     // Recuperada ou cancelada (livre)
+static const int IN_RUN = -2;   // Ainda em uma sequência ordenada
+
+static const long long SLOT_MASK = (1LL << HANDLE_SLOT_BITS) - 1;
+static const int MAX_GENERATION = (1 << HANDLE_GENERATION_BITS) - 1;
 
 //-------------------------------------------------------------------------------
 // FUNÇÕES AUXILIARES
@@ -22,29 +32,26 @@ int EventScaler::GetRightSuccessor(int i) {
     return 2 * i + 2;
 }
 
-// HeapifyDown: restaura a propriedade de min-heap a partir de um nó i para baixo
+// HeapifyDown: restaura a propriedade de min-heap a partir de um nó i para baixo, trocando-o com o menor sucessor enquanto necessário
 void EventScaler::HeapifyDown(int i) {
-    int earliest = i;                   // Assume-se inicialmente que o Evento de menor tempo é i
-    int right = GetRightSuccessor(i);   // Filho da direita
-    int left = GetLeftSuccessor(i);     // Filho da esquerda
+    while(true) {
+        int earliest = i;
+        int left = GetLeftSuccessor(i);
+        int right = GetRightSuccessor(i);
 
-    // Caso o filho da esquerda seja menor que o nó atual, troca e chama recursivamente para o filho da esquerda
-    if(left < this->size && minheap[left].GetTime() < minheap[earliest].GetTime()) {
-        Event aux(minheap[i]);
-        minheap[i] = minheap[left];
-        minheap[left] = aux;
-        HeapifyDown(left);
-    }
+        if(left < this->size && minheap[left].GetTime() < minheap[earliest].GetTime()) {
+            earliest = left;
+        }
+        if(right < this->size && minheap[right].GetTime() < minheap[earliest].GetTime()) {
+            earliest = right;
+        }
+        if(earliest == i) {
+            return;
+        }
 
-    // Caso o filho da direita seja menor que o nó atual, troca e chama recursivamente para o filho da direita
-    if(right < this->size && minheap[right].GetTime() < minheap[earliest].GetTime()) {
-        Event aux(minheap[i]);
-        minheap[i] = minheap[right];
-        minheap[right] = aux;
-        HeapifyDown(right);
+        Swap(i, earliest);
+        i = earliest;
     }
-
-    return;
 }
 
 // HeapifyUp: restaura a propriedade de min-heap a partir de um nó i para cima
@@ -53,24 +60,234 @@ void EventScaler::HeapifyUp(int i) {
 
     // Caso o nó seja menor que seu ancestral, troca e chama recursivamente para o ancestral
     if(minheap[i].GetTime() < minheap[anc].GetTime()) {
-        Event aux(minheap[i]);
-        minheap[i] = minheap[anc];
-        minheap[anc] = aux;
+        Swap(i, anc);
         HeapifyUp(anc);
     }
     else return;
 }
 
+// Swap: troca os nós i e j e atualiza a posição de suas vagas
+void EventScaler::Swap(int i, int j) {
+    Event aux(minheap[i]);
+    minheap[i] = minheap[j];
+    minheap[j] = aux;
+
+    int slot = heap_slots[i];
+    heap_slots[i] = heap_slots[j];
+    heap_slots[j] = slot;
+    if(this->tracking) {
+        this->positions[heap_slots[i]] = i;
+        this->positions[heap_slots[j]] = j;
+    }
+}
+
+// RemoveAt: o último nó ocupa o lugar de i e sobe ou desce conforme seu tempo (a raiz só pode descer)
+void EventScaler::RemoveAt(int i) {
+    ReleaseSlot(heap_slots[i]);
+    this->size--;
+    if(i == this->size) {
+        return;
+    }
+    minheap[i] = minheap[this->size];
+    heap_slots[i] = heap_slots[this->size];
+    int moved = heap_slots[i];
+    if(this->tracking) {
+        this->positions[moved] = i;
+    }
+    if(i == 0) {
+        HeapifyDown(0);
+        return;
+    }
+
+    // Fora da raiz só acontece com tracking (Cancel), então a posição do nó movido é conhecida depois de subir
+    HeapifyUp(i);
+    HeapifyDown(this->positions[moved]);
+}
+
+// Track: até o primeiro Cancel/Reschedule, as trocas do min-heap não atualizam as posições (custo fora do caminho comum);
+// aqui as posições são reconstruídas: o que não está no min-heap nem em sequência já foi recuperado
+void EventScaler::Track() {
+    if(this->tracking) {
+        return;
+    }
+    for(size_t s = 0; s < this->positions.size(); s++) {
+        if(this->positions[s] != IN_RUN) {
+            this->positions[s] = GONE;
+        }
+    }
+    for(int i = 0; i < this->size; i++) {
+        this->positions[heap_slots[i]] = i;
+    }
+    this->tracking = true;
+}
+
+// Grow: dobra a capacidade do min-heap até comportar needed eventos
+void EventScaler::Grow(int needed) {
+    if(needed <= this->capacity) {
+        return;
+    }
+
+    int new_capacity = this->capacity;
+    while(new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    Event* bigger = new Event[new_capacity];
+    memcpy(bigger, minheap, sizeof(Event)*this->size);
+    delete[] minheap;
+    this->minheap = bigger;
+
+    int* bigger_slots = new int[new_capacity];
+    memcpy(bigger_slots, heap_slots, sizeof(int)*this->size);
+    delete[] heap_slots;
+    this->heap_slots = bigger_slots;
+
+    this->mem_usage += (Event::GetMemoryUsage() + sizeof(int))*(new_capacity - this->capacity);
+    this->capacity = new_capacity;
+}
+
+// RunHead: tempo do próximo evento da sequência
+double EventScaler::RunHead(int run) {
+    return this->runs[run].events[this->runs[run].head].GetTime();
+}
+
+// RunHeapifyDown: mesmo algoritmo de HeapifyDown, sobre o heap de sequências
+void EventScaler::RunHeapifyDown(int i) {
+    int amount = this->run_heap.size();
+    while(true) {
+        int earliest = i;
+        int left = GetLeftSuccessor(i);
+        int right = GetRightSuccessor(i);
+
+        if(left < amount && RunHead(run_heap[left]) < RunHead(run_heap[earliest])) {
+            earliest = left;
+        }
+        if(right < amount && RunHead(run_heap[right]) < RunHead(run_heap[earliest])) {
+            earliest = right;
+        }
+        if(earliest == i) {
+            return;
+        }
+        std::swap(run_heap[i], run_heap[earliest]);
+        i = earliest;
+    }
+}
+
+// AddRun: guarda uma cópia da sequência e sobe seu índice no heap de sequências
+void EventScaler::AddRun(Event* events, int amount, int first_slot) {
+    SortedRun run;
+    run.events = new Event[amount];
+    run.head = 0;
+    run.size = amount;
+    run.first_slot = first_slot;
+    memcpy(run.events, events, sizeof(Event)*amount);
+    this->runs.push_back(run);
+    this->run_events += amount;
+    this->mem_usage += Event::GetMemoryUsage()*amount;
+
+    int i = this->run_heap.size();
+    this->run_heap.push_back(this->runs.size() - 1);
+    while(i > 0 && RunHead(run_heap[i]) < RunHead(run_heap[GetAncestral(i)])) {
+        std::swap(run_heap[i], run_heap[GetAncestral(i)]);
+        i = GetAncestral(i);
+    }
+}
+
+// ClearRuns: libera as sequências (inclusive as cópias descartáveis que ainda restarem nelas)
+void EventScaler::ClearRuns() {
+    for(size_t i = 0; i < this->runs.size(); i++) {
+        if(this->runs[i].events != nullptr) {
+            this->mem_usage -= Event::GetMemoryUsage()*this->runs[i].size;
+            delete[] this->runs[i].events;
+        }
+    }
+    this->runs.clear();
+    this->run_heap.clear();
+    this->run_events = 0;
+}
+
+// AcquireSlot: reaproveita a vaga liberada mais recente (já com a geração avançada) ou cria uma nova
+int EventScaler::AcquireSlot() {
+    if(!this->free_slots.empty()) {
+        int slot = this->free_slots.back();
+        this->free_slots.pop_back();
+        return slot;
+    }
+    this->positions.push_back(GONE);
+    this->generations.push_back(this->fresh_generation);
+    return this->positions.size() - 1;
+}
+
+// ReleaseSlot: com a geração avançada, os identificadores antigos da vaga deixam de valer; esgotadas as gerações, a
+// vaga é aposentada (fica GONE e não volta para a lista livre)
+void EventScaler::ReleaseSlot(int slot) {
+    this->positions[slot] = GONE;
+    if(this->generations[slot] < MAX_GENERATION) {
+        this->generations[slot]++;
+        this->free_slots.push_back(slot);
+    }
+}
+
+// Compact: sem eventos pendentes, nenhuma vaga está em uso e as sequências só guardam cópias descartáveis; tudo é
+// descartado e as vagas novas recebem uma geração acima de todas as usadas, para os identificadores antigos continuarem
+// inválidos. Se as gerações se esgotarem, as vagas são mantidas (e seguem reaproveitadas pela lista livre)
+void EventScaler::Compact() {
+    int highest = this->fresh_generation;
+    for(size_t s = 0; s < this->generations.size(); s++) {
+        highest = std::max(highest, this->generations[s]);
+    }
+    if(highest >= MAX_GENERATION) {
+        return;
+    }
+    ClearRuns();
+    this->positions.clear();
+    this->generations.clear();
+    this->free_slots.clear();
+    this->fresh_generation = highest + 1;
+}
+
+// FindSlot: a vaga do identificador, se ele ainda se refere a um evento pendente (mesma geração e vaga não liberada)
+int EventScaler::FindSlot(EventHandle handle) {
+    if(handle < 0) {
+        return -1;
+    }
+    long long slot = handle & SLOT_MASK;
+    if(slot >= (long long)this->positions.size() || this->generations[slot] != (handle >> HANDLE_SLOT_BITS)
+       || this->positions[slot] == GONE) {
+        return -1;
+    }
+    return slot;
+}
+
+EventHandle EventScaler::MakeHandle(int slot) {
+    return ((EventHandle)this->generations[slot] << HANDLE_SLOT_BITS) | slot;
+}
+
 //-------------------------------------------------------------------------------
 // CONSTRUTOR
 //-------------------------------------------------------------------------------
 
 // Construtor: inicializa automaticamente o vetor do min-heap e os outros atributos de acordo
 EventScaler::EventScaler() {
+    this->capacity = MAX_HEAP_SIZE;
+    this->minheap = new Event[MAX_HEAP_SIZE];
+    this->heap_slots = new int[MAX_HEAP_SIZE];
     this->size = 0;
+    this->fresh_generation = 0;
+    this->tracking = false;
+    this->trace = nullptr;
+    this->run_events = 0;
 
     // Controle de memória: todo Evento ocupa a mesma quantidade de memória
-    this->mem_usage = sizeof(int) + minheap[0].GetMemoryUsage()*MAX_HEAP_SIZE;
+    this->mem_usage = 2*sizeof(int) + (Event::GetMemoryUsage() + sizeof(int))*MAX_HEAP_SIZE;
+}
+
+// Destrutor: libera o min-heap e as sequências ainda não consumidas
+EventScaler::~EventScaler() {
+    delete[] this->minheap;
+    delete[] this->heap_slots;
+    for(size_t i = 0; i < this->runs.size(); i++) {
+        delete[] this->runs[i].events;
+    }
 }
 
 //-------------------------------------------------------------------------------
@@ -78,42 +295,241 @@ EventScaler::EventScaler() {
 //-------------------------------------------------------------------------------
 
 // ScheduleEvent: agenda um evento - insere-o no min-heap e organiza o min-heap
-void EventScaler::ScheduleEvent(int id, double time, EventType type) {
-    if(this->size == MAX_HEAP_SIZE) {
-        // Min-heap cheio
-        throw std::runtime_error("Can't schedule event: max size reached.");
+EventHandle EventScaler::ScheduleEvent(int id, double time, EventType type) {
+    Grow(this->size + 1);
+    int slot = AcquireSlot();
+    this->positions[slot] = size;
+    minheap[size] = Event(id, time, type);
+    heap_slots[size] = slot;
+    this->size++;
+    HeapifyUp(size-1);
+
+    if(this->trace != nullptr) {
+        this->trace->LogEvent(TraceRecordType::SCHEDULE, id, time, type);
     }
-    else {
-        minheap[size] = Event(id, time, type);
-        this->size++;
-        HeapifyUp(size-1);
+    return MakeHandle(slot);
+}
+
+// ScheduleBatch: divide o lote em sequências não decrescentes; as de pelo menos MIN_SORTED_RUN eventos são guardadas
+// como estão e intercaladas sob demanda em GetNextEvent, as demais vão para o min-heap. Se muitos eventos entrarem
+// no min-heap de uma vez, ele é reconstruído de baixo para cima (O(n)) em vez de subir evento por evento (O(k log n)).
+// Os identificadores precisam ser consecutivos, então o lote sempre ocupa vagas novas, todas na mesma geração; com o
+// escalonador vazio, as vagas antigas são descartadas antes (Compact)
+EventHandle EventScaler::ScheduleBatch(Event* events, int amount) {
+    if(GetSize() == 0) {
+        Compact();
+    }
+    int first_slot = this->positions.size();
+    this->positions.resize(first_slot + amount, IN_RUN);
+    this->generations.resize(first_slot + amount, this->fresh_generation);
+    int first_new = this->size;
+    int i = 0;
+    while(i < amount) {
+        int j = i + 1;
+        while(j < amount && !(events[j].GetTime() < events[j-1].GetTime())) {
+            j++;
+        }
+
+        if(j - i >= MIN_SORTED_RUN) {
+            AddRun(events + i, j - i, first_slot + i);
+        }
+        else {
+            Grow(this->size + (j - i));
+            memcpy(minheap + this->size, events + i, sizeof(Event)*(j - i));
+            for(int k = i; k < j; k++) {
+                heap_slots[this->size] = first_slot + k;
+                this->positions[first_slot + k] = this->size;
+                this->size++;
+            }
+        }
+        i = j;
+    }
+
+    // Restauração do min-heap
+    int added = this->size - first_new;
+    if(added > 0) {
+        int depth = 0;
+        for(int n = this->size; n > 1; n /= 2) {
+            depth++;
+        }
+        if((long long)added*depth > 2LL*this->size) {
+            for(int k = this->size/2 - 1; k >= 0; k--) {
+                HeapifyDown(k);
+            }
+        }
+        else {
+            for(int k = first_new; k < this->size; k++) {
+                HeapifyUp(k);
+            }
+        }
     }
+
+    if(this->trace != nullptr) {
+        for(int k = 0; k < amount; k++) {
+            this->trace->LogEvent(TraceRecordType::SCHEDULE, events[k].GetID(), events[k].GetTime(), events[k].GetType());
+        }
+    }
+    return MakeHandle(first_slot);
 }
 
-// GetNextEvent: recupera o próximo evento na fila de prioridade
-Event& EventScaler::GetNextEvent() {
-    // Caso de min-heap vazio
-    if(this->size == 0) {
-        throw std::runtime_error("Can't recover event: min-heap empty.");
+// PopRunHead: avança a cabeça da sequência mais adiantada; esgotada, ela é liberada e sai do heap de sequências
+void EventScaler::PopRunHead() {
+    SortedRun& run = this->runs[run_heap[0]];
+    run.head++;
+    if(run.head == run.size) {
+        delete[] run.events;
+        run.events = nullptr;
+        this->mem_usage -= Event::GetMemoryUsage()*run.size;
+        run_heap[0] = run_heap.back();
+        run_heap.pop_back();
     }
-    
-    // Caso trivial: somente 1 evento
-    if(this->size == 1) {
-        this->size--;
-        return minheap[0];
+    if(!run_heap.empty()) {
+        RunHeapifyDown(0);
     }
+}
 
-    // Armazena o evento que irá ser retornado, heapify antes de retornar
-    this->nextevent = minheap[0];
-    minheap[0] = minheap[this->size-1];
-    this->size--;
-    HeapifyDown(0);
+// PeekTime: tempo do próximo evento, sem retirá-lo (INFINITY se não houver). As cabeças canceladas das sequências que
+// estiverem na frente são descartadas no caminho, como em GetNextEvent
+double EventScaler::PeekTime() {
+    while(!this->run_heap.empty()) {
+        SortedRun& run = this->runs[run_heap[0]];
+        if(this->positions[run.first_slot + run.head] == IN_RUN) {
+            break;
+        }
+        PopRunHead();
+    }
+
+    double time = INFINITY;
+    if(!this->run_heap.empty()) {
+        time = RunHead(run_heap[0]);
+    }
+    if(this->size > 0 && minheap[0].GetTime() <= time) {
+        time = minheap[0].GetTime();
+    }
+    return time;
+}
+
+// GetNextEvent: recupera o próximo evento, comparando a raiz do min-heap com a cabeça da sequência mais adiantada
+// Eventos cancelados ou reagendados continuam nas sequências e são descartados quando chegam à cabeça
+Event& EventScaler::GetNextEvent() {
+    bool live = false;
+    while(!live) {
+        // Caso de nenhum evento agendado
+        if(this->size == 0 && this->run_events == 0) {
+            throw std::runtime_error("Can't recover event: min-heap empty.");
+        }
+
+        // Próximo evento vem de uma sequência ordenada (empates ficam com o min-heap)
+        if(!this->run_heap.empty() && (this->size == 0 || RunHead(run_heap[0]) < minheap[0].GetTime())) {
+            SortedRun& run = this->runs[run_heap[0]];
+            int slot = run.first_slot + run.head;
+            live = this->positions[slot] == IN_RUN;
+            if(live) {
+                this->nextevent = run.events[run.head];
+                ReleaseSlot(slot);
+                this->run_events--;
+            }
+            PopRunHead();
+        }
+        // Próximo evento vem do min-heap: armazena o evento que irá ser retornado, heapify antes de retornar
+        else {
+            this->nextevent = minheap[0];
+            RemoveAt(0);
+            live = true;
+        }
+    }
+
+    if(this->trace != nullptr) {
+        this->trace->LogEvent(TraceRecordType::NEXTEVENT, nextevent.GetID(), nextevent.GetTime(), nextevent.GetType());
+    }
     return nextevent;
 }
 
 // GetSize: retorna o tamanho atual do min-heap (a quantidade de eventos agendados)
 int EventScaler::GetSize() {
-    return this->size;
+    return this->size + this->run_events;
+}
+
+// GetSlotAmount: vagas alocadas, livres ou não
+int EventScaler::GetSlotAmount() {
+    return this->positions.size();
+}
+
+// Clear: descarta os eventos pendentes e libera as sequências; a capacidade do min-heap é mantida
+void EventScaler::Clear() {
+    ClearRuns();
+    this->size = 0;
+    this->positions.clear();
+    this->generations.clear();
+    this->free_slots.clear();
+    this->fresh_generation = 0;
+    this->tracking = false;
+}
+
+// Cancel: evento no min-heap sai na hora; evento de sequência só é marcado (descartado ao chegar à cabeça)
+bool EventScaler::Cancel(EventHandle handle) {
+    Track();
+    int slot = FindSlot(handle);
+    if(slot < 0) {
+        return false;
+    }
+    if(this->positions[slot] == IN_RUN) {
+        ReleaseSlot(slot);
+        this->run_events--;
+    }
+    else {
+        RemoveAt(this->positions[slot]);
+    }
+    return true;
+}
+
+// Reschedule: no min-heap, o evento sobe ou desce a partir da posição atual; de uma sequência, ele passa para o min-heap
+// com a mesma vaga e o mesmo identificador (a cópia na sequência vira descartável)
+bool EventScaler::Reschedule(EventHandle handle, double time) {
+    Track();
+    int slot = FindSlot(handle);
+    if(slot < 0) {
+        return false;
+    }
+
+    int position = this->positions[slot];
+    if(position == IN_RUN) {
+        // Sequência que contém a vaga: a última criada com first_slot <= slot (os lotes ocupam vagas novas, em ordem)
+        int low = 0, high = this->runs.size() - 1;
+        while(low < high) {
+            int mid = (low + high + 1)/2;
+            if(this->runs[mid].first_slot <= slot) {
+                low = mid;
+            }
+            else {
+                high = mid - 1;
+            }
+        }
+        Event& old = this->runs[low].events[slot - this->runs[low].first_slot];
+        this->run_events--;
+
+        Grow(this->size + 1);
+        position = this->size;
+        minheap[position] = Event(old.GetID(), time, old.GetType());
+        heap_slots[position] = slot;
+        this->positions[slot] = position;
+        this->size++;
+    }
+    else {
+        minheap[position] = Event(minheap[position].GetID(), time, minheap[position].GetType());
+    }
+    HeapifyUp(position);
+    HeapifyDown(this->positions[slot]);
+
+    if(this->trace != nullptr) {
+        this->trace->LogEvent(TraceRecordType::SCHEDULE, minheap[this->positions[slot]].GetID(), time, minheap[this->positions[slot]].GetType());
+    }
+    return true;
+}
+
+// SetTraceLog: passa a registrar (ou deixa de registrar, com nullptr) cada agendamento e recuperação no trace
+void EventScaler::SetTraceLog(TraceLog* trace) {
+    this->trace = trace;
 }
 
 //-------------------------------------------------------------------------------
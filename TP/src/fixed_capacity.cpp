@@ -0,0 +1,23 @@
+#include "fixed_capacity.hpp"
+
+// NewDemandGroup: grupo com armazenamento embutido para as capacidades especializadas, dinâmico para as demais
+DemandGroup* NewDemandGroup(int eta) {
+    switch(eta) {
+        case 2: return new FixedDemandGroup<2>();
+        case 3: return new FixedDemandGroup<3>();
+        case 4: return new FixedDemandGroup<4>();
+        case 6: return new FixedDemandGroup<6>();
+        default: return new DemandGroup(eta);
+    }
+}
+
+// NewRide: corrida com paradas e segmentos embutidos para as capacidades especializadas, dinâmica para as demais
+Ride* NewRide(DemandGroup& group, double min_efficiency) {
+    switch(group.Capacity()) {
+        case 2: return new FixedRide<2>(group, min_efficiency);
+        case 3: return new FixedRide<3>(group, min_efficiency);
+        case 4: return new FixedRide<4>(group, min_efficiency);
+        case 6: return new FixedRide<6>(group, min_efficiency);
+        default: return new Ride(group, min_efficiency);
+    }
+}
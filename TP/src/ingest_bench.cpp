@@ -0,0 +1,157 @@
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "simulation_manager.hpp"
+#include "demand_ingest.hpp"
+
+// Ferramenta de medição: vazão de DemandIngest com várias fontes enviando ao mesmo Manager. A entrada (mesmo formato de
+// tp2.out) é lida para a memória e repartida em rodízio entre as fontes (cada uma em ordem de tempo, cada uma na
+// própria thread). Primeiro as demandas são entregues diretamente ao Manager por uma thread ("direct"); depois, para
+// cada quantidade de fontes, passam por DemandIngest. Mede-se o tempo de parede do primeiro envio até o fim do
+// despacho; a simulação é executada depois, fora da medição, e precisa produzir as mesmas corridas da entrega direta.
+// Com -u n, uma em cada n demandas recebe uma classe de serviço inexistente: o Manager as recusa, e as recusadas contadas
+// por DemandIngest precisam ser as mesmas da entrega direta.
+// Cada linha é "fontes segundos demandas_por_segundo atrasadas recusadas".
+// Uso: ingest_bench.out [-p fontes]... [-l atraso_maximo] [-q capacidade_da_fila] [-u n] < entrada
+
+// Entrada lida para a memória
+struct Input {
+    int eta;
+    double gamma, delta, alpha, beta;
+    float lambda;
+    std::vector<Demand> demands;
+};
+
+// Resultado das corridas: quantidade e soma de fim e distância (confere que a entrega foi a mesma)
+struct Rides {
+    long count;
+    double checksum;
+};
+
+// Collect: executa a simulação e resume as corridas
+static Rides Collect(Manager& manager) {
+    Rides rides = {0, 0};
+    int index_ride;
+    while((index_ride = manager.NextFinishedRide()) >= 0) {
+        Ride* ride = manager.GetRide(index_ride);
+        rides.count++;
+        rides.checksum += ride->GetEnd() + ride->GetDistance();
+    }
+    return rides;
+}
+
+// Deliver: entrega direta, sem DemandIngest
+static double Deliver(Input& input, int& rejected, Rides& rides) {
+    Manager manager(input.eta, input.gamma, input.delta, input.alpha, input.beta, input.lambda, input.demands.size());
+    rejected = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < input.demands.size(); i++) {
+        Demand& demand = input.demands[i];
+        if(manager.MakeDemand(demand.GetID(), demand.GetTime(), demand.GetOrigin().GetX(), demand.GetOrigin().GetY(),
+                              demand.GetDestination().GetX(), demand.GetDestination().GetY(), demand.GetClass()) < 0) {
+            rejected++;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    rides = Collect(manager);
+    return seconds;
+}
+
+// Ingest: entrega por DemandIngest com producers fontes em rodízio
+static double Ingest(Input& input, int producers, double max_lag, size_t capacity, int& late, int& rejected, Rides& rides) {
+    Manager manager(input.eta, input.gamma, input.delta, input.alpha, input.beta, input.lambda, input.demands.size());
+    DemandIngest ingest(manager, producers, max_lag, capacity);
+    ingest.Start();
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> sources;
+    for(int p = 0; p < producers; p++) {
+        sources.push_back(std::thread([&input, &ingest, p, producers]() {
+            for(size_t i = p; i < input.demands.size(); i += producers) {
+                ingest.Submit(p, input.demands[i]);
+            }
+            ingest.Close(p);
+        }));
+    }
+    for(int p = 0; p < producers; p++) {
+        sources[p].join();
+    }
+    ingest.Finish();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    late = ingest.GetLateDemands();
+    rejected = ingest.GetRejectedDemands();
+    rides = Collect(manager);
+    return seconds;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<int> producer_counts;
+    double max_lag = -1;
+    size_t capacity = 1 << 14;
+    int unknown_every = 0;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            producer_counts.push_back(atoi(argv[++i]));
+        }
+        else if(strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            max_lag = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-q") == 0 && i + 1 < argc) {
+            capacity = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-u") == 0 && i + 1 < argc) {
+            unknown_every = atoi(argv[++i]);
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-p producers]... [-l max_lag] [-q queue_capacity] [-u n]" << std::endl;
+            return 1;
+        }
+    }
+    if(producer_counts.empty()) {
+        producer_counts = {1, 2, 4, 8};
+    }
+
+    Input input;
+    int amount;
+    std::cin >> input.eta >> input.gamma >> input.delta >> input.alpha >> input.beta >> input.lambda >> amount;
+    for(int i = 0; i < amount; i++) {
+        int id;
+        double time, ox, oy, dx, dy;
+        std::cin >> id >> time >> ox >> oy >> dx >> dy;
+        int service_class = unknown_every > 0 && i % unknown_every == 0 ? 1 : 0;
+        input.demands.push_back(Demand(id, time, ox, oy, dx, dy, service_class));
+    }
+
+    std::cout << std::fixed;
+    std::cout << "producers seconds demands_per_second late rejected" << std::endl;
+    Rides expected;
+    int expected_rejected;
+    double base = Deliver(input, expected_rejected, expected);
+    std::cout << "direct " << std::setprecision(4) << base << " " << std::setprecision(0) << amount/base << " 0 "
+              << expected_rejected << std::endl;
+
+    for(size_t p = 0; p < producer_counts.size(); p++) {
+        if(producer_counts[p] < 1) {
+            std::cerr << "Invalid producer count: " << producer_counts[p] << std::endl;
+            return 1;
+        }
+        int late, rejected;
+        Rides rides;
+        double seconds = Ingest(input, producer_counts[p], max_lag, capacity, late, rejected, rides);
+        std::cout << producer_counts[p] << " " << std::setprecision(4) << seconds << " " << std::setprecision(0)
+                  << amount/seconds << " " << late << " " << rejected << std::endl;
+        if(rejected != expected_rejected) {
+            std::cerr << "Rejected demands differ from the direct delivery with " << producer_counts[p] << " producers." << std::endl;
+            return 1;
+        }
+        // Sem atraso máximo, a entrega é sempre em ordem de tempo: as corridas precisam ser as da entrega direta
+        if(max_lag < 0 && (rides.count != expected.count || rides.checksum != expected.checksum)) {
+            std::cerr << "Rides differ from the direct delivery with " << producer_counts[p] << " producers." << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -1,9 +1,129 @@
+#include <cstring>
+#include <string>
+#include <cstdlib>
+#include <vector>
 #include "simulation_manager.hpp"
+#include "road_oracle.hpp"
+#include "demand_sorter.hpp"
 
-int main() {
+int main(int argc, char* argv[]) {
     // Booting
     std::cout << std::fixed << std::setprecision(2);
 
+    // Opções de linha de comando
+    const char* trace_path = nullptr;   // -t <arquivo>: grava o trace binário da execução
+    const char* metric = "euclidean";   // -m <métrica>: euclidean, manhattan, haversine ou road
+    const char* graph_path = nullptr;   // -g <arquivo>: malha viária para a métrica road
+    double cell_size = 1.0;             // -G <lado>: lado da grade de alinhamento do cache da métrica road
+    const char* stats_path = nullptr;   // -s <arquivo>: escreve o resumo estatístico das corridas em JSON
+    double max_delay = -1;              // -b <atraso>: agrupamento em lote com janela de no máximo min(delta, atraso)
+    int threads = 1;                    // -T <threads>: threads de trabalho do agrupamento em lote
+    std::vector<float> rerun_lambda;    // -R <lambda>:<gamma>: repete a simulação com outros parâmetros, incrementalmente (pode ser repetida)
+    std::vector<double> rerun_gamma;
+    double sort_memory = 0;             // -M <MB>: ordena a entrada por (tempo, id) com ordenação externa limitada a MB megabytes
+    int event_threads = 1;              // -j <threads>: threads do processamento de eventos (saída idêntica à serial)
+    const char* stops_path = nullptr;   // -p <arquivo>: simula cada parada e escreve "id solicitação coleta entrega" por passageiro
+    const char* output_path = nullptr;  // -o <arquivo>: grava as corridas no formato binário em colunas (ver ride_export.out)
+    const char* segments_path = nullptr; // -S <arquivo>: grava o índice espacial dos trechos das corridas (ver segment_query.out)
+    const char* changes_path = nullptr; // -c <arquivo>: cancelamentos ("cancel id_demanda tempo") e atrasos ("delay corrida tempo atraso")
+    bool delta_coords = false;          // -D: com -o, grava as coordenadas em delta (exato para até 2 casas decimais)
+    const char* timeline_path = nullptr; // -P <arquivo>: grava a linha do tempo da execução em JSON do Chrome (abre no Perfetto)
+    int sample_period = 64;             // -F <n>: na linha do tempo, registra as etapas de 1 em cada n demandas (1 registra todas)
+    const char* classes_path = nullptr; // -C <arquivo>: classes de serviço; cada demanda ganha um 7º campo com a sua classe
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        }
+        else if(strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            metric = argv[++i];
+        }
+        else if(strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            graph_path = argv[++i];
+        }
+        else if(strcmp(argv[i], "-G") == 0 && i + 1 < argc) {
+            cell_size = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            stats_path = argv[++i];
+        }
+        else if(strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            stops_path = argv[++i];
+        }
+        else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        }
+        else if(strcmp(argv[i], "-S") == 0 && i + 1 < argc) {
+            segments_path = argv[++i];
+        }
+        else if(strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            changes_path = argv[++i];
+        }
+        else if(strcmp(argv[i], "-P") == 0 && i + 1 < argc) {
+            timeline_path = argv[++i];
+        }
+        else if(strcmp(argv[i], "-F") == 0 && i + 1 < argc) {
+            sample_period = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-C") == 0 && i + 1 < argc) {
+            classes_path = argv[++i];
+        }
+        else if(strcmp(argv[i], "-D") == 0) {
+            delta_coords = true;
+        }
+        else if(strcmp(argv[i], "-R") == 0 && i + 1 < argc && strchr(argv[i + 1], ':') != nullptr) {
+            rerun_lambda.push_back(atof(argv[++i]));
+            rerun_gamma.push_back(atof(strchr(argv[i], ':') + 1));
+        }
+        else if(strcmp(argv[i], "-M") == 0 && i + 1 < argc) {
+            sort_memory = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            event_threads = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            max_delay = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-T") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-t trace_file] [-m euclidean|manhattan|haversine|road] [-g graph_file] [-G cell_size] [-s stats_file] [-b max_delay] [-T threads] [-p stops_file] [-R lambda:gamma]... [-j threads] [-M sort_memory_mb] [-o ride_file [-D]] [-S segment_index_file] [-c changes_file] [-P timeline_file [-F sample_period]] [-C classes_file]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Linha do tempo: ativa antes da leitura para cobrir todas as fases
+    SpanTrace* timeline = nullptr;
+    if(timeline_path != nullptr) {
+        timeline = new SpanTrace(timeline_path, sample_period);
+        SpanTrace::Start(timeline);
+    }
+
+    // Métrica de distância
+    RoadOracle* oracle = nullptr;
+    if(strcmp(metric, "road") == 0) {
+        if(graph_path == nullptr) {
+            std::cerr << "The road metric needs a graph file (-g)." << std::endl;
+            return 1;
+        }
+        oracle = new RoadOracle(graph_path, cell_size);
+        DistanceMetric::UseRoadOracle(oracle);
+    }
+    else if(strcmp(metric, "manhattan") == 0) {
+        DistanceMetric::Use(MetricType::MANHATTAN);
+    }
+    else if(strcmp(metric, "haversine") == 0) {
+#if defined(POINT_FIXED32) || defined(POINT_FLOAT32)
+        std::cerr << "The haversine metric needs the default coordinates (build without COORDS=float32/fixed32)." << std::endl;
+        return 1;
+#endif
+        DistanceMetric::Use(MetricType::HAVERSINE);
+    }
+    else if(strcmp(metric, "euclidean") != 0) {
+        std::cerr << "Unknown metric: " << metric << std::endl;
+        return 1;
+    }
+
     // Coleta dos parâmetros de simulação
     int eta;            // Capacidade dos veículos
     double gamma;       // Velocidade dos veículos
@@ -17,19 +137,209 @@ int main() {
 
     // Inicialização do gerente
     Manager manager(eta, gamma, delta, alpha, beta, lambda, demand_amount);
+    if(max_delay >= 0) {
+        if(!rerun_lambda.empty()) {
+            std::cerr << "Incremental reruns (-R) can't be combined with batch mode (-b)." << std::endl;
+            return 1;
+        }
+        manager.EnableBatchMode(max_delay, threads);
+    }
+    if(changes_path != nullptr && !rerun_lambda.empty()) {
+        std::cerr << "Incremental reruns (-R) can't be combined with cancellations and delays (-c)." << std::endl;
+        return 1;
+    }
+    if(output_path != nullptr && !rerun_lambda.empty()) {
+        std::cerr << "Incremental reruns (-R) can't be combined with binary output (-o)." << std::endl;
+        return 1;
+    }
+    if(classes_path != nullptr && (max_delay >= 0 || !rerun_lambda.empty())) {
+        std::cerr << "Service classes (-C) can't be combined with batch mode (-b) or incremental reruns (-R)." << std::endl;
+        return 1;
+    }
+    if(!rerun_lambda.empty()) {
+        manager.EnableResimulation();
+    }
+
+    // Classes de serviço: a classe 0 usa os parâmetros da entrada; "class eta delta alpha beta lambda sla prioridade"
+    // acrescenta as classes 1, 2, ... e "standard sla prioridade" dá SLA e prioridade à classe 0
+    if(classes_path != nullptr) {
+        std::ifstream classes_file(classes_path);
+        if(!classes_file) {
+            std::cerr << "Can't open classes file: " << classes_path << std::endl;
+            return 1;
+        }
+        std::string kind;
+        while(classes_file >> kind) {
+            int class_eta, priority;
+            double class_delta, class_alpha, class_beta, max_wait;
+            float class_lambda;
+            if(kind == "class" && classes_file >> class_eta >> class_delta >> class_alpha >> class_beta >> class_lambda >> max_wait >> priority) {
+                int added = manager.AddServiceClass(class_eta, class_delta, class_alpha, class_beta, class_lambda);
+                manager.SetServiceLevel(added, max_wait, priority);
+            }
+            else if(kind == "standard" && classes_file >> max_wait >> priority) {
+                manager.SetServiceLevel(0, max_wait, priority);
+            }
+            else {
+                std::cerr << "Invalid service class: " << kind << std::endl;
+                return 1;
+            }
+        }
+    }
+    manager.SetEventThreads(event_threads);
+    TraceLog* trace = nullptr;
+    if(trace_path != nullptr) {
+        trace = new TraceLog(trace_path);
+        manager.SetTraceLog(trace);
+    }
+    RideStats* stats = nullptr;
+    if(stats_path != nullptr) {
+        stats = new RideStats();
+        manager.SetRideStats(stats);
+    }
+
+    SegmentIndex* segments = nullptr;
+    if(segments_path != nullptr) {
+        segments = new SegmentIndex();
+        manager.SetSegmentIndex(segments);
+    }
+
+    std::ofstream stops_file;
+    if(stops_path != nullptr) {
+        stops_file.open(stops_path);
+        stops_file << std::fixed << std::setprecision(2);
+        manager.SetStopLog(&stops_file);
+    }
 
     // Coleta de dados para criação de demandas (demand_amount vezes)
-    for(int i = 0; i < demand_amount; i++) {
-        int id;
-        double time;
-        double ox, oy, dx, dy;
-        std::cin >> id >> time >> ox >> oy >> dx >> dy;
+    // Com -M, as demandas passam antes pela ordenação externa (arquivos temporários em $TMPDIR ou /tmp)
+    {
+        TraceSpan parse_span("ParseDemands");
+        parse_span.SetArg("demands", demand_amount);
+        DemandSorter* sorter = nullptr;
+        if(sort_memory > 0) {
+            const char* temp_dir = getenv("TMPDIR");
+            sorter = new DemandSorter((size_t)(sort_memory*1024*1024), temp_dir != nullptr ? temp_dir : "/tmp");
+        }
+        for(int i = 0; i < demand_amount; i++) {
+            int id;
+            double time;
+            double ox, oy, dx, dy;
+            int service_class = 0;
+            std::cin >> id >> time >> ox >> oy >> dx >> dy;
+            if(classes_path != nullptr) {
+                std::cin >> service_class;
+            }
+
+            if(sorter != nullptr) {
+                sorter->Add(Demand(id, time, ox, oy, dx, dy, service_class));
+            }
+            else if(manager.MakeDemand(id, time, ox, oy, dx, dy, service_class) < 0 && classes_path != nullptr) {
+                std::cerr << "Demand " << id << " has an unknown service class: " << service_class << std::endl;
+            }
+        }
+        if(sorter != nullptr) {
+            Demand demand;
+            while(sorter->Next(demand)) {
+                if(manager.MakeDemand(demand.GetID(), demand.GetTime(), demand.GetOrigin().GetX(), demand.GetOrigin().GetY(),
+                                      demand.GetDestination().GetX(), demand.GetDestination().GetY(), demand.GetClass()) < 0
+                    && classes_path != nullptr) {
+                    std::cerr << "Demand " << demand.GetID() << " has an unknown service class: " << demand.GetClass() << std::endl;
+                }
+            }
+            delete sorter;
+        }
+    }
 
-        manager.MakeDemand(id, time, ox, oy, dx, dy);
+    // Cancelamentos e atrasos: agendados como eventos antes da simulação
+    if(changes_path != nullptr) {
+        std::ifstream changes_file(changes_path);
+        if(!changes_file) {
+            std::cerr << "Can't open changes file: " << changes_path << std::endl;
+            return 1;
+        }
+        std::string kind;
+        while(changes_file >> kind) {
+            int target;
+            double time, delay;
+            if(kind == "cancel" && changes_file >> target >> time) {
+                manager.CancelDemand(target, time);
+            }
+            else if(kind == "delay" && changes_file >> target >> time >> delay) {
+                if(!(delay >= 0)) {
+                    std::cerr << "Invalid delay for ride " << target << ": " << delay << " (delays can't be negative)" << std::endl;
+                    return 1;
+                }
+                manager.DelayRide(target, time, delay);
+            }
+            else {
+                std::cerr << "Invalid change: " << kind << std::endl;
+                return 1;
+            }
+        }
     }
 
     // Simulação
-    manager.StartSimulation(std::cout);
+    if(output_path != nullptr) {
+        RideWriter writer(output_path, delta_coords);
+        manager.StartSimulation(writer);
+        writer.Close();
+    }
+    else {
+        manager.StartSimulation(std::cout);
+    }
+
+    // SLA por classe: corridas que começaram com algum passageiro esperando mais que o limite da classe
+    if(classes_path != nullptr) {
+        for(int c = 0; c < manager.GetClassAmount(); c++) {
+            std::cerr << "class " << c << " sla_breaches " << manager.GetSlaBreaches(c) << std::endl;
+        }
+    }
+
+    // Índice espacial: somente os trechos da simulação principal
+    if(segments != nullptr) {
+        manager.SetSegmentIndex(nullptr);
+        segments->Build();
+        segments->Save(segments_path);
+        delete segments;
+    }
+
+    // Resumo estatístico: somente as corridas da simulação principal
+    if(stats != nullptr) {
+        manager.SetRideStats(nullptr);
+    }
+
+    // Re-simulações: cada uma é separada da anterior por uma linha em branco
+    for(size_t i = 0; i < rerun_lambda.size(); i++) {
+        bool regrouped = false;
+        if(rerun_lambda[i] != lambda) {
+            manager.ChangeMinEfficiency(rerun_lambda[i]);
+            lambda = rerun_lambda[i];
+            regrouped = true;
+        }
+        if(rerun_gamma[i] != gamma || !regrouped) {
+            manager.ChangeSpeed(rerun_gamma[i]);
+            gamma = rerun_gamma[i];
+        }
+        std::cout << std::endl;
+        manager.StartSimulation(std::cout);
+    }
+    delete trace;
+
+    // Resumo estatístico
+    if(stats != nullptr) {
+        std::ofstream stats_file(stats_path);
+        stats->WriteJSON(stats_file);
+        delete stats;
+    }
+    delete oracle;
+
+    // Linha do tempo: gravada depois que todas as fases terminaram
+    if(timeline != nullptr) {
+        SpanTrace::Start(nullptr);
+        timeline->Write();
+        delete timeline;
+    }
 
     return 0;
 }
\ No newline at end of file
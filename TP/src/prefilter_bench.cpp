@@ -0,0 +1,208 @@
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include "demand_group.hpp"
+#include "distance_metric.hpp"
+
+// Ferramenta de medição: pré-filtro por caixas de DemandGroup::CheckDistances contra o laço sobre todas as demandas do
+// grupo, com eta de 4 a 512 (-e limita o maior) e métricas euclidiana e Manhattan, no laço do agrupamento guloso
+// (checagem de distâncias, inserção e eficiência a cada demanda). As demandas chegam em rajadas de 2*eta com origem e
+// destino no mesmo aglomerado; o espalhamento de cada aglomerado na rajada é 1 (cabe em alpha = beta = 2, os grupos
+// enchem) ou 3 (atravessa o limite: as caixas rejeitam ou ficam indecisas e caem no laço). Antes da medição, uma
+// passada confere cada checagem das caixas contra o laço e conta as decisões. Cada linha é
+// "metrica eta laco_s caixas_s aceleracao grupos aceitas rejeitadas laco", com as checagens decididas pelas caixas
+// (aceitas e rejeitadas) e as que caíram no laço.
+// Uso: prefilter_bench.out [-n demandas] [-e eta_maximo] [-s semente]
+
+// Grupo sem pré-filtro: a checagem anterior às caixas
+class LoopDemandGroup : public DemandGroup {
+    public:
+        LoopDemandGroup(int max_size) : DemandGroup(max_size) { };
+
+        DistanceCheck CheckDistances(Demand& item, double alpha, double beta) override {
+            for(int i = 0; i < this->item_counter; i++) {
+                if(this->group[i].OriginDistance(item) > alpha) {
+                    return DistanceCheck::ORIGIN_TOO_FAR;
+                }
+                if(this->group[i].DestinationDistance(item) > beta) {
+                    return DistanceCheck::DESTINATION_TOO_FAR;
+                }
+            }
+            return DistanceCheck::COMPATIBLE;
+        }
+};
+
+// Grupo com pré-filtro que também expõe a decisão das caixas, para a contagem da conferência
+class ProbeDemandGroup : public DemandGroup {
+    public:
+        ProbeDemandGroup(int max_size) : DemandGroup(max_size) { };
+
+        bool Decide(Demand& item, double alpha, double beta, DistanceCheck& result) {
+            return CheckBoxes(item, alpha, beta, result);
+        }
+};
+
+// Checagens da conferência: decididas pelas caixas (aceitas ou rejeitadas) e resolvidas pelo laço
+struct Decisions {
+    long accepted;
+    long rejected;
+    long fallback;
+};
+
+// Resultado de uma passada: grupos fechados e soma dos tamanhos (confere que as variantes decidem igual)
+struct Pass {
+    double seconds;
+    long groups;
+    long members;
+};
+
+// Run: passada gulosa sobre as demandas; o grupo fecha ao encher, ao receber uma demanda distante ou ao perder eficiência
+static const double ALPHA = 2.0, BETA = 2.0, LAMBDA = 0.5;
+
+static Pass Run(std::vector<Demand>& demands, DemandGroup& group) {
+    const double alpha = ALPHA, beta = BETA, lambda = LAMBDA;
+    Pass pass = {0, 0, 0};
+    auto begin = std::chrono::steady_clock::now();
+    group.Clear();
+    for(size_t i = 0; i < demands.size(); i++) {
+        bool close = group.Size() > 0 && (group.IsFull() || group.CheckDistances(demands[i], alpha, beta) != DistanceCheck::COMPATIBLE);
+        if(!close && group.Size() > 0) {
+            group.Insert(demands[i]);
+            if(group.Efficiency() >= lambda) {
+                continue;
+            }
+            group.Remove();
+            close = true;
+        }
+        if(close) {
+            pass.groups++;
+            pass.members += group.Size();
+            group.Clear();
+        }
+        group.Insert(demands[i]);
+    }
+    pass.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return pass;
+}
+
+// Verify: a mesma passada gulosa com os dois grupos lado a lado; cada checagem das caixas precisa dar o mesmo resultado
+// do laço. Retorna false na primeira divergência
+static bool Verify(std::vector<Demand>& demands, int eta, Decisions& decisions) {
+    LoopDemandGroup loop(eta);
+    ProbeDemandGroup probe(eta);
+    decisions.accepted = decisions.rejected = decisions.fallback = 0;
+    for(size_t i = 0; i < demands.size(); i++) {
+        bool close = probe.Size() > 0 && probe.IsFull();
+        if(!close && probe.Size() > 0) {
+            DistanceCheck expected = loop.CheckDistances(demands[i], ALPHA, BETA);
+            DistanceCheck boxed;
+            if(!probe.Decide(demands[i], ALPHA, BETA, boxed)) {
+                decisions.fallback++;
+            }
+            else if(boxed == DistanceCheck::COMPATIBLE) {
+                decisions.accepted++;
+            }
+            else {
+                decisions.rejected++;
+            }
+            if(probe.CheckDistances(demands[i], ALPHA, BETA) != expected) {
+                return false;
+            }
+            close = expected != DistanceCheck::COMPATIBLE;
+        }
+        if(!close && probe.Size() > 0) {
+            probe.Insert(demands[i]);
+            loop.Insert(demands[i]);
+            if(probe.Efficiency() >= LAMBDA) {
+                continue;
+            }
+            probe.Remove();
+            loop.Remove();
+            close = true;
+        }
+        if(close) {
+            probe.Clear();
+            loop.Clear();
+        }
+        probe.Insert(demands[i]);
+        loop.Insert(demands[i]);
+    }
+    return true;
+}
+
+// Generate: rajadas de 2*eta demandas, cada uma em um dos 4 aglomerados de origem e 4 de destino, com espalhamento 1
+// ou 3 sorteado para a origem e para o destino de cada rajada
+static void Generate(int amount, int eta, unsigned seed, std::vector<Demand>& demands) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> spread(0.0, 1.0);
+    std::uniform_int_distribution<int> cluster(0, 3);
+    std::uniform_int_distribution<int> wide(0, 1);
+    demands.clear();
+    int o = 0, d = 0;
+    double ow = 1, dw = 1;
+    for(int i = 0; i < amount; i++) {
+        if(i % (2*eta) == 0) {
+            o = cluster(random);
+            d = cluster(random);
+            ow = wide(random) ? 3 : 1;
+            dw = wide(random) ? 3 : 1;
+        }
+        demands.push_back(Demand(i, i*0.1, 10*o + ow*spread(random), 10*o + ow*spread(random),
+                                 60 + 10*d + dw*spread(random), 10*d + dw*spread(random)));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int amount = 200000;
+    int max_eta = 512;
+    unsigned seed = 7;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            amount = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            max_eta = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = atoi(argv[++i]);
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-n demands] [-e max_eta] [-s seed]" << std::endl;
+            return 1;
+        }
+    }
+
+    const MetricType metrics[] = {MetricType::EUCLIDEAN, MetricType::MANHATTAN};
+    const char* names[] = {"euclidean", "manhattan"};
+    std::vector<Demand> demands;
+    std::cout << std::fixed;
+    std::cout << "metric eta loop boxes speedup groups accepted rejected fallback" << std::endl;
+    for(int m = 0; m < 2; m++) {
+        DistanceMetric::Use(metrics[m]);
+        for(int eta = 4; eta <= max_eta; eta *= 2) {
+            Generate(amount, eta, seed, demands);
+            Decisions decisions;
+            if(!Verify(demands, eta, decisions)) {
+                std::cerr << "Box check differs from the loop for eta " << eta << "." << std::endl;
+                return 1;
+            }
+            LoopDemandGroup loop_group(eta);
+            Pass loop = Run(demands, loop_group);
+            DemandGroup box_group(eta);
+            Pass boxes = Run(demands, box_group);
+
+            std::cout << names[m] << " " << eta << " " << std::setprecision(4) << loop.seconds << " " << boxes.seconds << " "
+                      << std::setprecision(2) << loop.seconds/boxes.seconds << "x " << boxes.groups << " " << decisions.accepted << " "
+                      << decisions.rejected << " " << decisions.fallback << std::endl;
+            if(loop.groups != boxes.groups || loop.members != boxes.members) {
+                std::cerr << "Loop and box checks diverged for eta " << eta << "." << std::endl;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
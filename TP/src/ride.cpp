@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "ride.hpp"
 #include "demand_group.hpp"
 #include "eff_error.hpp"
@@ -13,51 +14,71 @@ Ride::Ride(DemandGroup& group, double min_efficiency) {
     if(size == 0) {
         throw std::logic_error("Can't create ride: group has no demands.");
     }
-    
-    // Alocação de memória para as paradas (armazenadas em um vetor de ponteiros)
-    this->stop_amount = size*2;
-    this->stops = new Stop*[stop_amount];
 
-    for(int i = 0; i < stop_amount; i++) {
-        this->stops[i] = nullptr;
+    // Alocação de memória para as paradas e segmentos
+    this->stops = new Stop[size*2];
+    this->segments = new Segment[size*2-1];
+    this->owns_storage = true;
+
+    try {
+        Build(group, min_efficiency);
+    }
+    catch(...) {
+        delete[] this->stops;
+        delete[] this->segments;
+        throw;
+    }
+}
+
+// CONSTRUTOR COM ARMAZENAMENTO EXTERNO: mesmo comportamento, mas usando vetores que pertencem a quem chamou
+Ride::Ride(DemandGroup& group, double min_efficiency, Stop* stop_storage, Segment* segment_storage) {
+    if(group.Size() == 0) {
+        throw std::logic_error("Can't create ride: group has no demands.");
     }
 
+    this->stops = stop_storage;
+    this->segments = segment_storage;
+    this->owns_storage = false;
+    Build(group, min_efficiency);
+}
+
+// Build: cria as paradas e segmentos nos vetores já alocados, calcula a distância e a eficiência
+void Ride::Build(DemandGroup& group, double min_efficiency) {
+    int size = group.Size();
+
     // Criação das paradas de coleta e entrega para cada demanda no grupo
+    this->stop_amount = size*2;
     for(int i = 0; i < size; i++) {
-        Stop* new_stop_o = new Stop(*group.Get(i), StopType::PICKUP);
-        Stop* new_stop_d = new Stop(*group.Get(i), StopType::DROPOFF);
-        this->stops[i] = new_stop_o;
-        this->stops[i + size] = new_stop_d;
-
-        this->mem_usage += new_stop_o->GetMemoryUsage() + new_stop_d->GetMemoryUsage();
+        this->stops[i] = Stop(*group.Get(i), StopType::PICKUP);
+        this->stops[i + size] = Stop(*group.Get(i), StopType::DROPOFF);
     }
 
     // Criação dos segmentos + cálculo prévio da distância total
     this->segment_amount = size*2-1;
     double dist = 0;
-    this->segments = new Segment[segment_amount];
 
     for(int i = 0; i < segment_amount; i++) {
-        Segment* new_segment = new Segment(*stops[i], *stops[i + 1]);
-        this->segments[i] = *new_segment;
-        dist += new_segment->GetDistance();
+        Segment new_segment(stops[i], stops[i + 1], group.SegmentDistance(i));
+        this->segments[i] = new_segment;
+        dist += new_segment.GetDistance();
     }
 
     // Inicialização dos atributos de simulação
     this->ongoing = false;
     this->done = false;
+    this->cancelled = false;
     this->distance = dist;
     this->start = group.Get(0)->GetTime();
     this-> duration = 0;
     this->end = 0;
+    this->stop_cursor = 0;
+    this->traveled = 0;
+    this->delay_offset = 0;
     
     // Cálculo da eficiência: lança uma exceção caso a eficiência mínima não tenha sido atingida e cancela a criação desta corrida
     if(this->segments[size-1].GetType() == SegmentType::TRAVEL) {
         // double travel_dist = this->segments[size-1].GetDistance();
-        double individual_dist = 0;
-        for(int i = 0; i < group.Size(); i++) {
-            individual_dist += group.Get(i)->GetDistance();
-        }
+        double individual_dist = group.IndividualDistance();
         this->efficiency = individual_dist/distance;
 
         if(this->efficiency < min_efficiency) {
@@ -69,16 +90,15 @@ Ride::Ride(DemandGroup& group, double min_efficiency) {
     }
 
     // Cálculo da memória usada
-    this->mem_usage = sizeof(Segment)*segment_amount + sizeof(Segment*) + sizeof(Stop*) + sizeof(int)*3 + sizeof(double)*2 + sizeof(bool);
+    this->mem_usage = sizeof(Segment)*segment_amount + sizeof(Stop)*stop_amount + sizeof(Segment*) + sizeof(Stop*) + sizeof(int)*4 + sizeof(double)*3 + sizeof(bool)*3;
 }
 
-// DESTRUTOR: apaga os segmentos (que por sua vez vão apagar as paradas)
+// DESTRUTOR: apaga as paradas e os segmentos (somente se foram alocados por esta corrida)
 Ride::~Ride() {
-    for(int i = 0; i < this->stop_amount; i++) {
-        delete this->stops[i];
+    if(this->owns_storage) {
+        delete[] this->stops;
+        delete[] this->segments;
     }
-    delete[] this->stops;
-    delete[] this->segments;
 }
 
 //-------------------------------------------------------------------------------
@@ -90,6 +110,14 @@ void Ride::Start() {
     this->ongoing = true;
 }
 
+// Volta ao estado anterior ao início: nenhuma parada visitada e corrida não concluída
+void Ride::Reset() {
+    this->ongoing = false;
+    this->done = false;
+    this->stop_cursor = 0;
+    this->traveled = 0;
+}
+
 // Marca tanto esta corrida como todos os segmentos como terminados
 void Ride::MarkDone() {
     for(int i = 0; i < this->segment_amount; i++) {
@@ -100,16 +128,134 @@ void Ride::MarkDone() {
     this->done = true;
 }
 
+// Chega na próxima parada: completa o segmento até ela e registra o tempo de chegada pela distância acumulada
+// A distância é acumulada na mesma ordem da distância total, então a última parada cai exatamente no fim da corrida
+int Ride::VisitNextStop(double veh_speed) {
+    if(this->stop_cursor > 0) {
+        this->segments[this->stop_cursor - 1].MarkComplete();
+        this->traveled += this->segments[this->stop_cursor - 1].GetDistance();
+    }
+    this->stops[this->stop_cursor].MarkVisited(this->start + this->traveled/veh_speed + DelayBefore(this->traveled));
+    return this->stop_cursor++;
+}
+
+// DropDemand: as paradas seguintes são puxadas uma posição (coleta) ou duas (entrega) e os segmentos são refeitos, pois
+// apontam para as paradas. O início continua o mesmo (o veículo já foi despachado para o horário da primeira demanda);
+// distância e eficiência são recalculadas, sem checar lambda, e a duração fica para CalculateDuration
+bool Ride::DropDemand(int demand_id) {
+    if(this->ongoing || this->done) {
+        throw std::logic_error("Can't drop demand: ride already started.");
+    }
+    int size = this->stop_amount/2;
+    int pickup = 0;
+    while(pickup < size && this->stops[pickup].GetDemandID() != demand_id) {
+        pickup++;
+    }
+    if(pickup == size) {
+        return false;
+    }
+    if(size == 1) {
+        throw std::logic_error("Can't drop demand: ride would have no demands.");
+    }
+
+    int dropoff = pickup + size;
+    int kept = 0;
+    for(int i = 0; i < this->stop_amount; i++) {
+        if(i != pickup && i != dropoff) {
+            this->stops[kept++] = this->stops[i];
+        }
+    }
+    this->stop_amount = kept;
+    this->segment_amount = kept - 1;
+    size--;
+
+    double dist = 0;
+    for(int i = 0; i < this->segment_amount; i++) {
+        this->segments[i] = Segment(this->stops[i], this->stops[i + 1]);
+        dist += this->segments[i].GetDistance();
+    }
+    double individual_dist = 0;
+    for(int i = 0; i < size; i++) {
+        individual_dist += this->stops[i].Distance(this->stops[i + size]);
+    }
+    this->distance = dist;
+    this->efficiency = individual_dist/dist;
+    this->mem_usage -= 2*sizeof(Stop) + 2*sizeof(Segment);
+    return true;
+}
+
+// Postpone: o início só muda antes da corrida começar. Depois dele, o veículo fica parado delay no ponto em que está em
+// time: o atraso é registrado nessa distância e desloca só as paradas (e trechos) seguintes e o fim
+void Ride::Postpone(double delay, double time, double veh_speed) {
+    if(!HasStarted()) {
+        this->start += delay;
+    }
+    else {
+        double position = (time - this->start - this->delay_offset)*veh_speed;
+        if(!this->delays.empty()) {
+            position = std::max(position, this->delays.back().first);
+        }
+        position = std::min(std::max(position, 0.0), this->distance);
+        this->delays.push_back(std::make_pair(position, delay));
+        this->delay_offset += delay;
+    }
+    this->end += delay;
+}
+
+// DelayBefore: soma dos atrasos ocorridos antes de a corrida percorrer distance (0 se não houve atraso depois do início)
+double Ride::DelayBefore(double distance) {
+    double delay = 0;
+    for(size_t i = 0; i < this->delays.size() && this->delays[i].first < distance; i++) {
+        delay += this->delays[i].second;
+    }
+    return delay;
+}
+
+void Ride::Cancel() {
+    this->cancelled = true;
+}
+
+bool Ride::HasStarted() {
+    return this->ongoing || this->done;
+}
+
+bool Ride::IsCancelled() {
+    return this->cancelled;
+}
+
+// Retorna a quantidade de paradas ainda não visitadas
+int Ride::GetRemainingStops() {
+    return this->stop_amount - this->stop_cursor;
+}
+
+// Tempo previsto de chegada na próxima parada, a partir da última visitada
+double Ride::NextStopTime(double veh_speed) {
+    double next = this->traveled + this->segments[this->stop_cursor - 1].GetDistance();
+    return this->start + next/veh_speed + DelayBefore(next);
+}
+
 // Calcula a duração total desta corrida
 void Ride::CalculateDuration(double veh_speed) {
     this->duration = this->distance/veh_speed;
-    this->end = this->start + this->duration;
+    this->end = this->start + this->duration + this->delay_offset;
+}
+
+// MaxWait: cada coleta acontece no início mais o percurso até ela (as coletas são as primeiras paradas, em ordem)
+double Ride::MaxWait(double veh_speed) {
+    int demands = this->stop_amount/2;
+    double traveled = 0;
+    double wait = this->start - this->stops[0].GetRequestTime();
+    for(int i = 1; i < demands; i++) {
+        traveled += this->segments[i - 1].GetDistance();
+        wait = std::max(wait, this->start + traveled/veh_speed - this->stops[i].GetRequestTime());
+    }
+    return wait;
 }
 
 // Imprime as coordenadas de cada parada, em ordem, na saída passada
 void Ride::PrintStops(std::ostream& out) {
     for(int i = 0; i < stop_amount; i++) {
-        out << " " << stops[i]->GetPoint().GetX() << " " << stops[i]->GetPoint().GetY();
+        out << " " << stops[i].GetPoint().GetX() << " " << stops[i].GetPoint().GetY();
     }
 }
 
@@ -141,6 +287,24 @@ int Ride::GetStopAmount() {
     return this->stop_amount;
 }
 
+Stop& Ride::GetStop(int index) {
+    if(index < 0 || index >= this->stop_amount) {
+        throw std::out_of_range("Ride: inaccessible stop");
+    }
+    return this->stops[index];
+}
+
+int Ride::GetSegmentAmount() {
+    return this->segment_amount;
+}
+
+Segment& Ride::GetSegment(int index) {
+    if(index < 0 || index >= this->segment_amount) {
+        throw std::out_of_range("Ride: inaccessible segment");
+    }
+    return this->segments[index];
+}
+
 //-------------------------------------------------------------------------------
 // CONTROLE DE MEMÓRIA
 //-------------------------------------------------------------------------------
@@ -0,0 +1,35 @@
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include "ride_output.hpp"
+
+// Ferramenta de exportação: converte o arquivo binário gravado com -o na saída em texto da simulação
+// (uma linha por corrida: fim, distância, quantidade de paradas e coordenadas), lendo uma corrida por vez
+// Uso: ride_export.out <arquivo>
+
+int main(int argc, char* argv[]) {
+    if(argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <ride_file>" << std::endl;
+        return 1;
+    }
+
+    try {
+        RideReader reader(argv[1]);
+        std::cout << std::fixed << std::setprecision(2);
+
+        RideRecord record;
+        std::vector<double> coords;
+        while(reader.Next(record, coords)) {
+            std::cout << record.end << " " << record.distance << " " << record.stop_count;
+            for(size_t i = 0; i < coords.size(); i++) {
+                std::cout << " " << coords[i];
+            }
+            std::cout << "\n";
+        }
+    }
+    catch(std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
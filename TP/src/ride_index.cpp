@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <stdexcept>
+#include "ride_index.hpp"
+
+//-------------------------------------------------------------------------------
+// CONSTRUTOR
+//-------------------------------------------------------------------------------
+
+RideIndex::RideIndex() {
+    Clear();
+}
+
+void RideIndex::Clear() {
+    this->ids.clear();
+    this->starts.clear();
+    this->ends.clear();
+    this->nodes.clear();
+    this->by_start.clear();
+    this->by_end.clear();
+    this->end_of.clear();
+    this->root = -1;
+    this->built = false;
+    this->max_concurrent = 0;
+    this->max_concurrent_time = 0;
+}
+
+void RideIndex::Add(int id, double start, double end) {
+    if(this->built) {
+        throw std::logic_error("RideIndex: can't add rides after Build.");
+    }
+    this->ids.push_back(id);
+    this->starts.push_back(start);
+    this->end_of.push_back(end);
+}
+
+//-------------------------------------------------------------------------------
+// CONSTRUÇÃO
+//-------------------------------------------------------------------------------
+
+// Build: reorganiza as corridas por início, monta a árvore centrada e calcula o pico de simultaneidade
+void RideIndex::Build() {
+    int n = this->ids.size();
+    std::vector<int> order(n);
+    for(int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return this->starts[a] < this->starts[b];
+    });
+
+    std::vector<int> sorted_ids(n);
+    std::vector<double> sorted_starts(n), sorted_ends(n);
+    for(int i = 0; i < n; i++) {
+        sorted_ids[i] = this->ids[order[i]];
+        sorted_starts[i] = this->starts[order[i]];
+        sorted_ends[i] = this->end_of[order[i]];
+    }
+    this->ids.swap(sorted_ids);
+    this->starts.swap(sorted_starts);
+    this->end_of.swap(sorted_ends);
+    this->ends = this->end_of;
+    std::sort(this->ends.begin(), this->ends.end());
+
+    // Árvore: a partir daqui, cada corrida é identificada por sua posição na ordem de início
+    this->by_start.reserve(n);
+    this->by_end.reserve(n);
+    std::vector<int> members(n);
+    for(int i = 0; i < n; i++) {
+        members[i] = i;
+    }
+    this->root = BuildNode(members);
+
+    // Pico: varredura de inícios e fins; no empate, o início vem antes (os intervalos são fechados)
+    int active = 0;
+    size_t e = 0;
+    for(int s = 0; s < n; s++) {
+        while(e < this->ends.size() && this->ends[e] < this->starts[s]) {
+            active--;
+            e++;
+        }
+        active++;
+        if(active > this->max_concurrent) {
+            this->max_concurrent = active;
+            this->max_concurrent_time = this->starts[s];
+        }
+    }
+    this->built = true;
+}
+
+// BuildNode: o centro é o início da corrida mediana, então cada subárvore recebe no máximo metade das corridas
+int RideIndex::BuildNode(std::vector<int>& members) {
+    if(members.empty()) {
+        return -1;
+    }
+
+    Node node;
+    node.center = this->starts[members[members.size()/2]];
+    node.first = this->by_start.size();
+
+    std::vector<int> left, right, here;
+    for(size_t i = 0; i < members.size(); i++) {
+        int p = members[i];
+        if(this->end_of[p] < node.center) {
+            left.push_back(p);
+        }
+        else if(this->starts[p] > node.center) {
+            right.push_back(p);
+        }
+        else {
+            here.push_back(p);
+        }
+    }
+    members.clear();
+    members.shrink_to_fit();
+
+    // here já está em ordem de início (members está); a cópia por fim decrescente é ordenada aqui
+    node.amount = here.size();
+    this->by_start.insert(this->by_start.end(), here.begin(), here.end());
+    std::stable_sort(here.begin(), here.end(), [this](int a, int b) {
+        return this->end_of[a] > this->end_of[b];
+    });
+    this->by_end.insert(this->by_end.end(), here.begin(), here.end());
+
+    int index = this->nodes.size();
+    this->nodes.push_back(node);
+    int left_node = BuildNode(left);
+    int right_node = BuildNode(right);
+    this->nodes[index].left = left_node;
+    this->nodes[index].right = right_node;
+    return index;
+}
+
+bool RideIndex::IsBuilt() {
+    return this->built;
+}
+
+//-------------------------------------------------------------------------------
+// CONSULTAS
+//-------------------------------------------------------------------------------
+
+// QueryPoint: em cada nó, as corridas que contêm o centro e também t são um prefixo de by_start (t antes do centro)
+// ou de by_end (t depois do centro); a descida segue para um único lado
+void RideIndex::QueryPoint(double t, std::vector<int>& rides) {
+    rides.clear();
+    int current = this->root;
+    while(current >= 0) {
+        const Node& node = this->nodes[current];
+        if(t < node.center) {
+            for(int i = node.first; i < node.first + node.amount && this->starts[this->by_start[i]] <= t; i++) {
+                rides.push_back(this->ids[this->by_start[i]]);
+            }
+            current = node.left;
+        }
+        else if(t > node.center) {
+            for(int i = node.first; i < node.first + node.amount && this->end_of[this->by_end[i]] >= t; i++) {
+                rides.push_back(this->ids[this->by_end[i]]);
+            }
+            current = node.right;
+        }
+        else {
+            for(int i = node.first; i < node.first + node.amount; i++) {
+                rides.push_back(this->ids[this->by_start[i]]);
+            }
+            break;
+        }
+    }
+}
+
+// QueryRange: uma corrida se sobrepõe a [from, to] se está ativa em from ou se começa em (from, to]
+void RideIndex::QueryRange(double from, double to, std::vector<int>& rides) {
+    if(to < from) {
+        rides.clear();
+        return;
+    }
+    QueryPoint(from, rides);
+    int first = std::upper_bound(this->starts.begin(), this->starts.end(), from) - this->starts.begin();
+    for(int i = first; i < (int)this->starts.size() && this->starts[i] <= to; i++) {
+        rides.push_back(this->ids[i]);
+    }
+}
+
+// CountActive: começaram até t menos as que terminaram antes de t
+int RideIndex::CountActive(double t) {
+    return CountOverlapping(t, t);
+}
+
+int RideIndex::CountOverlapping(double from, double to) {
+    if(to < from) {
+        return 0;
+    }
+    int started = std::upper_bound(this->starts.begin(), this->starts.end(), to) - this->starts.begin();
+    int finished = std::lower_bound(this->ends.begin(), this->ends.end(), from) - this->ends.begin();
+    return started - finished;
+}
+
+int RideIndex::GetMaxConcurrent() {
+    return this->max_concurrent;
+}
+
+double RideIndex::GetMaxConcurrentTime() {
+    return this->max_concurrent_time;
+}
+
+int RideIndex::GetRideAmount() {
+    return this->ids.size();
+}
+
+//-------------------------------------------------------------------------------
+// CONTROLE DE MEMÓRIA
+//-------------------------------------------------------------------------------
+
+int RideIndex::GetMemoryUsage() {
+    return sizeof(RideIndex) + sizeof(int)*(this->ids.size() + this->by_start.size() + this->by_end.size())
+         + sizeof(double)*(this->starts.size() + this->ends.size() + this->end_of.size()) + sizeof(Node)*this->nodes.size();
+}
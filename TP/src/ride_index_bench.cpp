@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include "ride_index.hpp"
+
+// Ferramenta de medição e conferência do RideIndex com corridas sorteadas (início uniforme, duração de 5 a 60):
+//   - conferência: em um conjunto menor (-c corridas), cada consulta pontual, de janela e de contagem e o pico de
+//     simultaneidade são comparados com a varredura de todas as corridas;
+//   - medição: em n corridas (-n, 10^7 por padrão), tempo e memória da construção e latência média das consultas.
+// Uso: ride_index_bench.out [-n corridas] [-q consultas] [-w janela] [-c corridas_conferidas]
+
+struct Rides {
+    std::vector<double> starts, ends;
+};
+
+static void Generate(int amount, unsigned seed, Rides& rides, double& horizon) {
+    std::mt19937 random(seed);
+    horizon = amount*0.01;
+    std::uniform_real_distribution<double> start(0.0, horizon);
+    std::uniform_real_distribution<double> duration(5.0, 60.0);
+    rides.starts.resize(amount);
+    rides.ends.resize(amount);
+    for(int i = 0; i < amount; i++) {
+        rides.starts[i] = start(random);
+        rides.ends[i] = rides.starts[i] + duration(random);
+    }
+}
+
+static void Fill(RideIndex& index, Rides& rides) {
+    index.Clear();
+    for(size_t i = 0; i < rides.starts.size(); i++) {
+        index.Add(i, rides.starts[i], rides.ends[i]);
+    }
+    index.Build();
+}
+
+static double Seconds(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// Check: compara cada consulta com a varredura completa; retorna false na primeira divergência
+static bool Check(int amount, int queries, double window) {
+    Rides rides;
+    double horizon;
+    Generate(amount, 11, rides, horizon);
+    RideIndex index;
+    Fill(index, rides);
+
+    std::mt19937 random(12);
+    std::uniform_real_distribution<double> time(-100.0, horizon + 100.0);
+    std::vector<int> found, expected;
+    for(int q = 0; q < queries; q++) {
+        double from = time(random);
+        double to = from + window;
+
+        expected.clear();
+        for(int i = 0; i < amount; i++) {
+            if(rides.starts[i] <= from && from <= rides.ends[i]) {
+                expected.push_back(i);
+            }
+        }
+        index.QueryPoint(from, found);
+        std::sort(found.begin(), found.end());
+        if(found != expected || index.CountActive(from) != (int)expected.size()) {
+            std::cerr << "Point query diverged at t = " << from << "." << std::endl;
+            return false;
+        }
+
+        expected.clear();
+        for(int i = 0; i < amount; i++) {
+            if(rides.starts[i] <= to && from <= rides.ends[i]) {
+                expected.push_back(i);
+            }
+        }
+        index.QueryRange(from, to, found);
+        std::sort(found.begin(), found.end());
+        if(found != expected || index.CountOverlapping(from, to) != (int)expected.size()) {
+            std::cerr << "Range query diverged at [" << from << ", " << to << "]." << std::endl;
+            return false;
+        }
+    }
+
+    // Pico: sempre ocorre no início de alguma corrida
+    int peak = 0;
+    for(int s = 0; s < amount; s++) {
+        int active = 0;
+        for(int i = 0; i < amount; i++) {
+            active += rides.starts[i] <= rides.starts[s] && rides.starts[s] <= rides.ends[i];
+        }
+        peak = std::max(peak, active);
+    }
+    if(index.GetMaxConcurrent() != peak) {
+        std::cerr << "Peak concurrency diverged: " << index.GetMaxConcurrent() << " != " << peak << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int amount = 10000000;
+    int queries = 100000;
+    double window = 10.0;
+    int checked = 20000;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            amount = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-q") == 0 && i + 1 < argc) {
+            queries = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            window = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            checked = atoi(argv[++i]);
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-n rides] [-q queries] [-w window] [-c checked_rides]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << std::fixed;
+    if(checked > 0) {
+        if(!Check(checked, 2000, window)) {
+            return 1;
+        }
+        std::cout << "check " << checked << " rides: ok" << std::endl;
+    }
+
+    Rides rides;
+    double horizon;
+    Generate(amount, 7, rides, horizon);
+    RideIndex index;
+    auto begin = std::chrono::steady_clock::now();
+    Fill(index, rides);
+    double build = Seconds(begin);
+    std::cout << "build " << amount << " rides: " << std::setprecision(2) << build << " s, "
+              << index.GetMemoryUsage()/(1024.0*1024.0) << " MB" << std::endl;
+
+    std::mt19937 random(8);
+    std::uniform_real_distribution<double> time(0.0, horizon);
+    std::vector<double> times(queries);
+    for(int q = 0; q < queries; q++) {
+        times[q] = time(random);
+    }
+
+    std::vector<int> found;
+    long total = 0;
+    begin = std::chrono::steady_clock::now();
+    for(int q = 0; q < queries; q++) {
+        index.QueryPoint(times[q], found);
+        total += found.size();
+    }
+    double point = Seconds(begin);
+    std::cout << "point query: " << std::setprecision(2) << point/queries*1e6 << " us, average k "
+              << std::setprecision(0) << (double)total/queries << std::endl;
+
+    total = 0;
+    begin = std::chrono::steady_clock::now();
+    for(int q = 0; q < queries; q++) {
+        index.QueryRange(times[q], times[q] + window, found);
+        total += found.size();
+    }
+    double range = Seconds(begin);
+    std::cout << "window query (" << std::setprecision(1) << window << "): " << std::setprecision(2) << range/queries*1e6
+              << " us, average k " << std::setprecision(0) << (double)total/queries << std::endl;
+
+    total = 0;
+    begin = std::chrono::steady_clock::now();
+    for(int q = 0; q < queries; q++) {
+        total += index.CountOverlapping(times[q], times[q] + window);
+    }
+    double count = Seconds(begin);
+    std::cout << "window count: " << std::setprecision(3) << count/queries*1e6 << " us (checksum " << total << ")" << std::endl;
+    std::cout << "max concurrent: " << index.GetMaxConcurrent() << std::endl;
+    return 0;
+}
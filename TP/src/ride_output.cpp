@@ -0,0 +1,223 @@
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "ride_output.hpp"
+
+static const char MAGIC[8] = {'D', 'S', 'R', 'I', 'D', 'E', 'S', '1'};
+static const uint32_t FLAG_DELTA = 1;
+static const int HEADER_SIZE = 16;
+static const int FOOTER_SIZE = 5*8 + 8;
+
+//-------------------------------------------------------------------------------
+// CODIFICAÇÃO
+//-------------------------------------------------------------------------------
+
+static void PutVarint(std::vector<unsigned char>& out, uint64_t value) {
+    while(value >= 0x80) {
+        out.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((unsigned char)value);
+}
+
+static uint64_t ZigZag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t UnZigZag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static void PutRaw(std::vector<unsigned char>& out, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+//-------------------------------------------------------------------------------
+// RIDEWRITER
+//-------------------------------------------------------------------------------
+
+RideWriter::RideWriter(const std::string& path, bool delta, size_t buffer_size) : file(path, std::ios::binary) {
+    if(!this->file) {
+        throw std::runtime_error("RideWriter: can't open " + path);
+    }
+    this->delta = delta;
+    this->buffer_size = buffer_size;
+    this->buffer.reserve(buffer_size + 64);
+    this->stop_bytes = 0;
+    this->closed = false;
+
+    uint32_t flags = delta ? FLAG_DELTA : 0;
+    uint32_t reserved = 0;
+    this->file.write(MAGIC, 8);
+    this->file.write((const char*)&flags, 4);
+    this->file.write((const char*)&reserved, 4);
+}
+
+RideWriter::~RideWriter() {
+    Close();
+}
+
+void RideWriter::Flush() {
+    this->file.write((const char*)this->buffer.data(), this->buffer.size());
+    this->buffer.clear();
+}
+
+// Write: registro fixo em memória e coordenadas das paradas no buffer da coluna de paradas
+void RideWriter::Write(int id, Ride& ride) {
+    RideRecord record;
+    record.id = id;
+    record.stop_count = ride.GetStopAmount();
+    record.start = ride.GetStart();
+    record.end = ride.GetEnd();
+    record.distance = ride.GetDistance();
+    record.efficiency = ride.GetEfficiency();
+    this->records.push_back(record);
+    this->offsets.push_back(this->stop_bytes);
+
+    size_t before = this->buffer.size();
+    int64_t last_x = 0, last_y = 0;
+    for(int i = 0; i < record.stop_count; i++) {
+        const Point2D& point = ride.GetStop(i).GetPoint();
+        if(this->delta) {
+            int64_t x = llround(point.GetX()*100.0);
+            int64_t y = llround(point.GetY()*100.0);
+            PutVarint(this->buffer, ZigZag(x - last_x));
+            PutVarint(this->buffer, ZigZag(y - last_y));
+            last_x = x;
+            last_y = y;
+        }
+        else {
+            double x = point.GetX();
+            double y = point.GetY();
+            PutRaw(this->buffer, &x, 8);
+            PutRaw(this->buffer, &y, 8);
+        }
+    }
+    this->stop_bytes += this->buffer.size() - before;
+
+    if(this->buffer.size() >= this->buffer_size) {
+        Flush();
+    }
+}
+
+// Close: as seções de registros e índice vêm depois da coluna de paradas; o rodapé diz onde cada uma começa
+void RideWriter::Close() {
+    if(this->closed) {
+        return;
+    }
+    this->closed = true;
+    Flush();
+    this->offsets.push_back(this->stop_bytes);
+
+    uint64_t footer[5];
+    footer[0] = this->records.size();
+    footer[1] = HEADER_SIZE;                                    // Coluna de paradas
+    footer[2] = this->stop_bytes;                               // Tamanho da coluna de paradas
+    footer[3] = HEADER_SIZE + this->stop_bytes;                 // Registros
+    footer[4] = footer[3] + sizeof(RideRecord)*this->records.size();    // Índice
+    this->file.write((const char*)this->records.data(), sizeof(RideRecord)*this->records.size());
+    this->file.write((const char*)this->offsets.data(), sizeof(uint64_t)*this->offsets.size());
+    this->file.write((const char*)footer, sizeof(footer));
+    this->file.write(MAGIC, 8);
+    this->file.close();
+}
+
+//-------------------------------------------------------------------------------
+// RIDEREADER
+//-------------------------------------------------------------------------------
+
+RideReader::RideReader(const std::string& path) : records_in(path, std::ios::binary), stops_in(path, std::ios::binary) {
+    if(!this->records_in || !this->stops_in) {
+        throw std::runtime_error("RideReader: can't open " + path);
+    }
+
+    // Cabeçalho
+    char magic[8];
+    uint32_t flags, reserved;
+    this->records_in.read(magic, 8);
+    this->records_in.read((char*)&flags, 4);
+    this->records_in.read((char*)&reserved, 4);
+    if(!this->records_in || memcmp(magic, MAGIC, 8) != 0) {
+        throw std::runtime_error("RideReader: not a ride file: " + path);
+    }
+    this->delta = (flags & FLAG_DELTA) != 0;
+
+    // Rodapé
+    uint64_t footer[5];
+    this->records_in.seekg(-FOOTER_SIZE, std::ios::end);
+    this->records_in.read((char*)footer, sizeof(footer));
+    this->records_in.read(magic, 8);
+    if(!this->records_in || memcmp(magic, MAGIC, 8) != 0) {
+        throw std::runtime_error("RideReader: truncated ride file: " + path);
+    }
+    this->ride_amount = footer[0];
+    this->stops_offset = footer[1];
+
+    // Índice inteiro em memória (8 bytes por corrida); registros e paradas são lidos sob demanda
+    this->offsets.resize(this->ride_amount + 1);
+    this->records_in.seekg(footer[4]);
+    this->records_in.read((char*)this->offsets.data(), sizeof(uint64_t)*this->offsets.size());
+    if(!this->records_in) {
+        throw std::runtime_error("RideReader: truncated ride index: " + path);
+    }
+
+    this->records_in.seekg(footer[3]);
+    this->stops_in.seekg(this->stops_offset);
+    this->current = 0;
+}
+
+uint64_t RideReader::GetRideAmount() {
+    return this->ride_amount;
+}
+
+bool RideReader::IsDelta() {
+    return this->delta;
+}
+
+// Next: lê o registro fixo e o trecho da coluna de paradas indicado pelo índice
+bool RideReader::Next(RideRecord& record, std::vector<double>& coords) {
+    if(this->current == this->ride_amount) {
+        return false;
+    }
+    this->records_in.read((char*)&record, sizeof(RideRecord));
+
+    uint64_t size = this->offsets[this->current + 1] - this->offsets[this->current];
+    std::vector<unsigned char> bytes(size);
+    this->stops_in.read((char*)bytes.data(), size);
+    if(!this->records_in || !this->stops_in) {
+        throw std::runtime_error("RideReader: truncated ride data.");
+    }
+    this->current++;
+
+    coords.resize(2*record.stop_count);
+    if(this->delta) {
+        const unsigned char* pos = bytes.data();
+        const unsigned char* end = pos + size;
+        int64_t last = 0;
+        for(int i = 0; i < 2*record.stop_count; i++) {
+            uint64_t value = 0;
+            int shift = 0;
+            while(pos < end && (*pos & 0x80)) {
+                value |= (uint64_t)(*pos++ & 0x7F) << shift;
+                shift += 7;
+            }
+            if(pos == end) {
+                throw std::runtime_error("RideReader: corrupted coordinates.");
+            }
+            value |= (uint64_t)(*pos++) << shift;
+
+            // x e y intercalados: cada eixo acumula com o valor anterior do mesmo eixo
+            int64_t previous = (i >= 2) ? llround(coords[i - 2]*100.0) : 0;
+            last = previous + UnZigZag(value);
+            coords[i] = last/100.0;
+        }
+    }
+    else {
+        if(size != 16*(uint64_t)record.stop_count) {
+            throw std::runtime_error("RideReader: corrupted coordinates.");
+        }
+        memcpy(coords.data(), bytes.data(), size);
+    }
+    return true;
+}
@@ -0,0 +1,391 @@
+#include <cmath>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+#include <vector>
+#include <iomanip>
+#include <iterator>
+#include "ride_stats.hpp"
+
+const double QuantileSketch::ACCURACY = 0.01;
+const double QuantileSketch::MIN_VALUE = 1e-6;
+
+// Gamma e seu logaritmo (fixos pela precisão)
+static const double GAMMA = (1 + QuantileSketch::ACCURACY)/(1 - QuantileSketch::ACCURACY);
+static const double LOG_GAMMA = log(GAMMA);
+
+//-------------------------------------------------------------------------------
+// LEITURA DE JSON (somente o necessário para os resumos gerados por WriteJSON)
+//-------------------------------------------------------------------------------
+
+struct JsonValue {
+    enum Kind { NUMBER, STRING, ARRAY, OBJECT, LITERAL } kind;
+    double number;
+    std::string text;
+    std::vector<JsonValue> items;           // elementos do vetor ou valores do objeto
+    std::vector<std::string> keys;          // chaves do objeto (mesma ordem de items)
+
+    const JsonValue* Find(const char* key) const {
+        for(size_t i = 0; i < keys.size(); i++) {
+            if(keys[i] == key) {
+                return &items[i];
+            }
+        }
+        return nullptr;
+    }
+};
+
+static void SkipSpaces(const char*& pos, const char* end) {
+    while(pos < end && (*pos == ' ' || *pos == '\n' || *pos == '\t' || *pos == '\r')) {
+        pos++;
+    }
+}
+
+static bool ParseJson(const char*& pos, const char* end, JsonValue& value) {
+    SkipSpaces(pos, end);
+    if(pos == end) {
+        return false;
+    }
+
+    if(*pos == '{' || *pos == '[') {
+        bool object = (*pos == '{');
+        char close = object ? '}' : ']';
+        value.kind = object ? JsonValue::OBJECT : JsonValue::ARRAY;
+        pos++;
+        SkipSpaces(pos, end);
+        if(pos < end && *pos == close) {
+            pos++;
+            return true;
+        }
+        while(true) {
+            if(object) {
+                JsonValue key;
+                if(!ParseJson(pos, end, key) || key.kind != JsonValue::STRING) {
+                    return false;
+                }
+                SkipSpaces(pos, end);
+                if(pos == end || *pos++ != ':') {
+                    return false;
+                }
+                value.keys.push_back(key.text);
+            }
+            value.items.push_back(JsonValue());
+            if(!ParseJson(pos, end, value.items.back())) {
+                return false;
+            }
+            SkipSpaces(pos, end);
+            if(pos == end) {
+                return false;
+            }
+            if(*pos == ',') {
+                pos++;
+                continue;
+            }
+            return *pos++ == close;
+        }
+    }
+
+    if(*pos == '"') {
+        value.kind = JsonValue::STRING;
+        for(pos++; pos < end && *pos != '"'; pos++) {
+            value.text += *pos;
+        }
+        return pos++ < end;
+    }
+
+    if(*pos == 't' || *pos == 'f' || *pos == 'n') {
+        value.kind = JsonValue::LITERAL;
+        while(pos < end && isalpha(*pos)) {
+            value.text += *pos++;
+        }
+        return true;
+    }
+
+    char* number_end;
+    std::string rest(pos, std::min<size_t>(end - pos, 64));
+    value.kind = JsonValue::NUMBER;
+    value.number = strtod(rest.c_str(), &number_end);
+    if(number_end == rest.c_str()) {
+        return false;
+    }
+    pos += number_end - rest.c_str();
+    return true;
+}
+
+static bool ReadNumber(const JsonValue& object, const char* key, double& out) {
+    const JsonValue* field = object.Find(key);
+    if(field == nullptr || field->kind != JsonValue::NUMBER) {
+        return false;
+    }
+    out = field->number;
+    return true;
+}
+
+//-------------------------------------------------------------------------------
+// QUANTILESKETCH
+//-------------------------------------------------------------------------------
+
+QuantileSketch::QuantileSketch() : zero(0), count(0), sum(0), min(0), max(0) {
+    for(int i = 0; i < BUCKETS; i++) {
+        this->positive[i] = 0;
+        this->negative[i] = 0;
+    }
+}
+
+// Bucket: chave logarítmica da magnitude, saturada no intervalo de baldes
+int QuantileSketch::Bucket(double magnitude) {
+    int key = (int)ceil(log(magnitude)/LOG_GAMMA) - MIN_KEY;
+    if(key < 0) {
+        return 0;
+    }
+    if(key >= BUCKETS) {
+        return BUCKETS - 1;
+    }
+    return key;
+}
+
+// Value: ponto do balde com erro relativo máximo a em relação a qualquer valor dentro dele
+double QuantileSketch::Value(int bucket) {
+    return 2*pow(GAMMA, bucket + MIN_KEY)/(GAMMA + 1);
+}
+
+void QuantileSketch::Add(double value) {
+    if(this->count == 0 || value < this->min) {
+        this->min = value;
+    }
+    if(this->count == 0 || value > this->max) {
+        this->max = value;
+    }
+    this->count++;
+    this->sum += value;
+
+    if(fabs(value) < MIN_VALUE) {
+        this->zero++;
+    }
+    else if(value > 0) {
+        this->positive[Bucket(value)]++;
+    }
+    else {
+        this->negative[Bucket(-value)]++;
+    }
+}
+
+void QuantileSketch::Merge(const QuantileSketch& other) {
+    if(other.count == 0) {
+        return;
+    }
+    if(this->count == 0 || other.min < this->min) {
+        this->min = other.min;
+    }
+    if(this->count == 0 || other.max > this->max) {
+        this->max = other.max;
+    }
+    this->count += other.count;
+    this->sum += other.sum;
+    this->zero += other.zero;
+    for(int i = 0; i < BUCKETS; i++) {
+        this->positive[i] += other.positive[i];
+        this->negative[i] += other.negative[i];
+    }
+}
+
+// Quantile: percorre os baldes em ordem crescente de valor (negativos de maior magnitude primeiro, zero, positivos)
+double QuantileSketch::Quantile(double q) {
+    if(this->count == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(q*(this->count - 1));
+    double result = this->max;
+    uint64_t seen = 0;
+    bool found = false;
+
+    for(int i = BUCKETS - 1; i >= 0 && !found; i--) {
+        seen += this->negative[i];
+        if(seen > rank) {
+            result = -Value(i);
+            found = true;
+        }
+    }
+    if(!found) {
+        seen += this->zero;
+        if(seen > rank) {
+            result = 0;
+            found = true;
+        }
+    }
+    for(int i = 0; i < BUCKETS && !found; i++) {
+        seen += this->positive[i];
+        if(seen > rank) {
+            result = Value(i);
+            found = true;
+        }
+    }
+
+    // O valor representativo do balde pode passar dos extremos observados
+    return std::max(this->min, std::min(this->max, result));
+}
+
+uint64_t QuantileSketch::Count() {
+    return this->count;
+}
+
+double QuantileSketch::Mean() {
+    return this->count == 0 ? 0 : this->sum/this->count;
+}
+
+double QuantileSketch::Min() {
+    return this->min;
+}
+
+double QuantileSketch::Max() {
+    return this->max;
+}
+
+// WriteJSON: resumo e baldes não vazios como pares [índice, contagem]
+void QuantileSketch::WriteJSON(std::ostream& out) {
+    out << "{\"count\": " << this->count
+        << ", \"mean\": " << Mean()
+        << ", \"min\": " << this->min
+        << ", \"max\": " << this->max
+        << ", \"p50\": " << Quantile(0.5)
+        << ", \"p90\": " << Quantile(0.9)
+        << ", \"p99\": " << Quantile(0.99)
+        << ", \"sum\": " << this->sum
+        << ", \"accuracy\": " << ACCURACY
+        << ", \"zero\": " << this->zero;
+
+    const char* names[2] = {"positive", "negative"};
+    uint64_t* stores[2] = {this->positive, this->negative};
+    for(int s = 0; s < 2; s++) {
+        out << ", \"" << names[s] << "\": [";
+        bool first = true;
+        for(int i = 0; i < BUCKETS; i++) {
+            if(stores[s][i] != 0) {
+                out << (first ? "" : ", ") << "[" << i << ", " << stores[s][i] << "]";
+                first = false;
+            }
+        }
+        out << "]";
+    }
+    out << "}";
+}
+
+bool QuantileSketch::ReadJSON(const JsonValue& value) {
+    double count, sum, min, max, zero, accuracy;
+    if(value.kind != JsonValue::OBJECT || !ReadNumber(value, "count", count) || !ReadNumber(value, "sum", sum)
+        || !ReadNumber(value, "min", min) || !ReadNumber(value, "max", max) || !ReadNumber(value, "zero", zero)
+        || !ReadNumber(value, "accuracy", accuracy) || accuracy != ACCURACY) {
+        return false;
+    }
+
+    QuantileSketch loaded;
+    loaded.count = (uint64_t)count;
+    loaded.sum = sum;
+    loaded.min = min;
+    loaded.max = max;
+    loaded.zero = (uint64_t)zero;
+
+    const char* names[2] = {"positive", "negative"};
+    uint64_t* stores[2] = {loaded.positive, loaded.negative};
+    for(int s = 0; s < 2; s++) {
+        const JsonValue* buckets = value.Find(names[s]);
+        if(buckets == nullptr || buckets->kind != JsonValue::ARRAY) {
+            return false;
+        }
+        for(size_t i = 0; i < buckets->items.size(); i++) {
+            const JsonValue& pair = buckets->items[i];
+            if(pair.kind != JsonValue::ARRAY || pair.items.size() != 2 || pair.items[0].number < 0 || pair.items[0].number >= BUCKETS) {
+                return false;
+            }
+            stores[s][(int)pair.items[0].number] = (uint64_t)pair.items[1].number;
+        }
+    }
+
+    *this = loaded;
+    return true;
+}
+
+//-------------------------------------------------------------------------------
+// RIDESTATS
+//-------------------------------------------------------------------------------
+
+RideStats::RideStats() : rides(0) { }
+
+// Add: registra eficiência, distância, duração e paradas da corrida e a espera de cada uma de suas demandas
+void RideStats::Add(Ride& ride) {
+    this->rides++;
+    this->metrics[0].Add(ride.GetEfficiency());
+    this->metrics[1].Add(ride.GetDistance());
+    this->metrics[2].Add(ride.GetDuration());
+    this->metrics[3].Add(ride.GetStopAmount());
+
+    // As coletas ocupam a primeira metade das paradas, uma por demanda
+    for(int i = 0; i < ride.GetStopAmount()/2; i++) {
+        this->metrics[4].Add(ride.GetStart() - ride.GetStop(i).GetRequestTime());
+    }
+}
+
+void RideStats::Merge(const RideStats& other) {
+    this->rides += other.rides;
+    for(int i = 0; i < METRICS; i++) {
+        this->metrics[i].Merge(other.metrics[i]);
+    }
+}
+
+uint64_t RideStats::GetRideAmount() {
+    return this->rides;
+}
+
+QuantileSketch& RideStats::GetMetric(int index) {
+    return this->metrics[index];
+}
+
+const char* RideStats::MetricName(int index) {
+    static const char* names[METRICS] = {"efficiency", "distance", "duration", "stops", "wait"};
+    return names[index];
+}
+
+// WriteJSON: números com precisão suficiente para que a leitura e combinação não percam informação
+void RideStats::WriteJSON(std::ostream& out) {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out.unsetf(std::ios::floatfield);
+    out.precision(17);
+
+    out << "{\"rides\": " << this->rides << ", \"metrics\": {";
+    for(int i = 0; i < METRICS; i++) {
+        out << (i ? ",\n" : "\n") << "  \"" << MetricName(i) << "\": ";
+        this->metrics[i].WriteJSON(out);
+    }
+    out << "\n}}" << std::endl;
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+bool RideStats::ReadJSON(std::istream& in) {
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const char* pos = text.c_str();
+    JsonValue root;
+    double rides;
+    if(!ParseJson(pos, text.c_str() + text.size(), root) || root.kind != JsonValue::OBJECT || !ReadNumber(root, "rides", rides)) {
+        return false;
+    }
+    const JsonValue* metrics = root.Find("metrics");
+    if(metrics == nullptr) {
+        return false;
+    }
+
+    RideStats* loaded = new RideStats();
+    loaded->rides = (uint64_t)rides;
+    bool ok = true;
+    for(int i = 0; i < METRICS && ok; i++) {
+        const JsonValue* metric = metrics->Find(MetricName(i));
+        ok = (metric != nullptr) && loaded->metrics[i].ReadJSON(*metric);
+    }
+    if(ok) {
+        *this = *loaded;
+    }
+    delete loaded;
+    return ok;
+}
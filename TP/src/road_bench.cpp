@@ -0,0 +1,148 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "2D_point.hpp"
+#include "road_oracle.hpp"
+
+// Ferramenta de medição: custo de Point2D::Distance com a métrica da malha (RoadOracle) para pares já consultados,
+// contra a métrica euclidiana nos mesmos pares. A malha é uma grade de lado -w com arestas de comprimento 1, gravada
+// em um arquivo temporário. Cada rodada repete -n consultas sorteadas entre P pares de pontos: com poucos pares todos
+// ficam no cache da thread; com mais pares que FRONT_SIZE, a maior parte das consultas cai nas fatias (LRU com trava).
+// Com -T, as mesmas consultas são divididas entre as threads. Cada linha é "pares euclidiana_ns malha_ns razao", em
+// nanossegundos por consulta (tempo de parede).
+// Uso: road_bench.out [-n consultas] [-w lado] [-T threads] [-s semente]
+
+// Pares de pontos consultados e ordem das consultas
+struct Workload {
+    std::vector<Point2D> from, to;
+    std::vector<int> order;
+};
+
+// Run: executa as consultas com a métrica ativa, divididas entre threads; retorna nanossegundos por consulta
+static double Run(Workload& work, int threads, double& checksum) {
+    std::vector<double> sums(threads, 0);
+    std::vector<std::thread> workers;
+    auto begin = std::chrono::steady_clock::now();
+    for(int t = 0; t < threads; t++) {
+        workers.push_back(std::thread([&work, &sums, t, threads]() {
+            double sum = 0;
+            for(size_t i = t; i < work.order.size(); i += threads) {
+                int pair = work.order[i];
+                sum += work.from[pair].Distance(work.to[pair]);
+            }
+            sums[t] = sum;
+        }));
+    }
+    for(int t = 0; t < threads; t++) {
+        workers[t].join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    checksum = 0;
+    for(int t = 0; t < threads; t++) {
+        checksum += sums[t];
+    }
+    return seconds*1e9*threads/work.order.size();
+}
+
+int main(int argc, char* argv[]) {
+    int lookups = 10000000;
+    int side = 64;
+    int threads = 1;
+    unsigned seed = 7;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            lookups = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            side = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-T") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = atoi(argv[++i]);
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-n lookups] [-w side] [-T threads] [-s seed]" << std::endl;
+            return 1;
+        }
+    }
+    if(side < 2 || threads < 1 || lookups < 1) {
+        std::cerr << "Invalid parameters." << std::endl;
+        return 1;
+    }
+
+    // Malha em grade: nó (x, y) ligado aos vizinhos à direita e acima
+    char name[] = "road_bench_XXXXXX";
+    int fd = mkstemp(name);
+    if(fd < 0) {
+        std::cerr << "Can't create the graph file." << std::endl;
+        return 1;
+    }
+    FILE* graph = fdopen(fd, "w");
+    fprintf(graph, "%d %d\n", side*side, 2*side*(side - 1));
+    for(int y = 0; y < side; y++) {
+        for(int x = 0; x < side; x++) {
+            fprintf(graph, "%d %d\n", x, y);
+        }
+    }
+    for(int y = 0; y < side; y++) {
+        for(int x = 0; x < side; x++) {
+            if(x + 1 < side) {
+                fprintf(graph, "%d %d 1\n", y*side + x, y*side + x + 1);
+            }
+            if(y + 1 < side) {
+                fprintf(graph, "%d %d 1\n", y*side + x, (y + 1)*side + x);
+            }
+        }
+    }
+    fclose(graph);
+    RoadOracle oracle(name, 1.0, 16, 1 << 16);
+    unlink(name);
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> coord(0.0, side - 1);
+    std::cout << std::fixed;
+    std::cout << "pairs euclidean road ratio" << std::endl;
+    const int pair_counts[] = {256, 65536};
+    for(int p = 0; p < 2; p++) {
+        Workload work;
+        for(int i = 0; i < pair_counts[p]; i++) {
+            work.from.push_back(Point2D(coord(random), coord(random)));
+            work.to.push_back(Point2D(coord(random), coord(random)));
+        }
+        std::uniform_int_distribution<int> pick(0, pair_counts[p] - 1);
+        for(int i = 0; i < lookups; i++) {
+            work.order.push_back(pick(random));
+        }
+
+        double checksum;
+        DistanceMetric::Use(MetricType::EUCLIDEAN);
+        double euclidean = Run(work, threads, checksum);
+
+        // Aquecimento: todos os pares calculados uma vez (e no cache de cada thread) antes da medição
+        DistanceMetric::UseRoadOracle(&oracle);
+        Workload warm = work;
+        warm.order.clear();
+        for(int i = 0; i < pair_counts[p]; i++) {
+            for(int t = 0; t < threads; t++) {
+                warm.order.push_back(i);
+            }
+        }
+        Run(warm, threads, checksum);
+        double road = Run(work, threads, checksum);
+
+        std::cout << pair_counts[p] << " " << std::setprecision(1) << euclidean << " " << road << " "
+                  << std::setprecision(2) << road/euclidean << "x" << std::endl;
+    }
+    DistanceMetric::Use(MetricType::EUCLIDEAN);
+    return 0;
+}
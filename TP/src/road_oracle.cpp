@@ -0,0 +1,293 @@
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include <cmath>
+#include <queue>
+#include <limits>
+#include "road_oracle.hpp"
+#include "distance_metric.hpp"
+
+std::atomic<int> RoadOracle::serials(0);
+
+// Cache da thread atual (ver road_oracle.hpp) e serial do oráculo que o preencheu (0: nenhum). Uma entrada zerada
+// coincide só com a consulta (0, 0, 0, 0), cuja distância é mesmo 0
+static thread_local RoadOracle::FrontEntry front_cache[RoadOracle::FRONT_SIZE];
+static thread_local int front_owner = 0;
+
+// FrontSlot: posição das coordenadas no cache da thread (mistura dos bits dos quatro doubles)
+static inline size_t FrontSlot(double ax, double ay, double bx, double by) {
+    uint64_t bits[4];
+    memcpy(&bits[0], &ax, sizeof(double));
+    memcpy(&bits[1], &ay, sizeof(double));
+    memcpy(&bits[2], &bx, sizeof(double));
+    memcpy(&bits[3], &by, sizeof(double));
+    uint64_t h = bits[0]*0x9E3779B97F4A7C15ULL ^ bits[1]*0xC2B2AE3D27D4EB4FULL ^ bits[2]*0x165667B19E3779F9ULL
+               ^ bits[3]*0xD6E8FEB86659FD93ULL;
+    return (size_t)(h >> 54) & (RoadOracle::FRONT_SIZE - 1);
+}
+
+// CellOf: célula da grade que contém a coordenada (floor da divisão, sem a chamada de biblioteca: a conversão trunca
+// em direção ao zero e o ajuste corrige os negativos não inteiros)
+static inline int32_t CellOf(double coord, double cell_size) {
+    double scaled = coord/cell_size;
+    int32_t cell = (int32_t)scaled;
+    return cell > scaled ? cell - 1 : cell;
+}
+
+//-------------------------------------------------------------------------------
+// CONSTRUTOR E DESTRUTOR
+//-------------------------------------------------------------------------------
+
+// CONSTRUTOR: lê o grafo, monta as listas de adjacência e o índice espacial dos nós
+RoadOracle::RoadOracle(const std::string& path, double cell_size, int shard_amount, size_t shard_capacity) {
+    if(cell_size <= 0 || shard_amount <= 0 || shard_capacity == 0) {
+        throw std::invalid_argument("RoadOracle: invalid cache parameters.");
+    }
+    this->cell_size = cell_size;
+    this->serial = ++serials;
+
+    std::ifstream in(path.c_str());
+    int n, m;
+    if(!(in >> n >> m) || n <= 0 || m < 0) {
+        throw std::runtime_error("RoadOracle: can't read graph " + path);
+    }
+
+    // Nós
+    this->node_x.resize(n);
+    this->node_y.resize(n);
+    for(int i = 0; i < n; i++) {
+        if(!(in >> this->node_x[i] >> this->node_y[i])) {
+            throw std::runtime_error("RoadOracle: truncated node list in " + path);
+        }
+        int32_t cx = CellOf(this->node_x[i], cell_size);
+        int32_t cy = CellOf(this->node_y[i], cell_size);
+        this->node_cells[CellKey(cx, cy)].push_back(i);
+    }
+
+    // Arestas: lidas uma vez para contar os graus e organizadas em vetores contíguos (cada aresta nos dois sentidos)
+    std::vector<int> from(m), to(m);
+    std::vector<double> len(m);
+    this->adj_begin.assign(n + 1, 0);
+    for(int i = 0; i < m; i++) {
+        if(!(in >> from[i] >> to[i] >> len[i]) || from[i] < 0 || from[i] >= n || to[i] < 0 || to[i] >= n || len[i] < 0) {
+            throw std::runtime_error("RoadOracle: invalid edge in " + path);
+        }
+        this->adj_begin[from[i] + 1]++;
+        this->adj_begin[to[i] + 1]++;
+    }
+    for(int i = 0; i < n; i++) {
+        this->adj_begin[i + 1] += this->adj_begin[i];
+    }
+    this->adj_to.resize(2*m);
+    this->adj_len.resize(2*m);
+    std::vector<int> fill(this->adj_begin.begin(), this->adj_begin.end() - 1);
+    for(int i = 0; i < m; i++) {
+        this->adj_to[fill[from[i]]] = to[i];
+        this->adj_len[fill[from[i]]++] = len[i];
+        this->adj_to[fill[to[i]]] = from[i];
+        this->adj_len[fill[to[i]]++] = len[i];
+    }
+
+    // Fatias do cache
+    size_t set_amount = 1;
+    while(set_amount*SHARD_WAYS < shard_capacity) {
+        set_amount <<= 1;
+    }
+    for(int i = 0; i < shard_amount; i++) {
+        Shard* shard = new Shard();
+        shard->sets.resize(set_amount);
+        shard->clock = 0;
+        this->shards.push_back(shard);
+    }
+}
+
+// DESTRUTOR: libera as fatias do cache
+RoadOracle::~RoadOracle() {
+    for(size_t i = 0; i < this->shards.size(); i++) {
+        delete this->shards[i];
+    }
+}
+
+//-------------------------------------------------------------------------------
+// FUNÇÕES AUXILIARES
+//-------------------------------------------------------------------------------
+
+// Hash do par de células (mistura dos quatro inteiros)
+size_t RoadOracle::CellPairHash::operator()(const CellPair& key) const {
+    uint64_t h = (uint64_t)(uint32_t)key.ax * 0x9E3779B97F4A7C15ULL;
+    h ^= (uint64_t)(uint32_t)key.ay + 0x7F4A7C159E3779B9ULL + (h << 6) + (h >> 2);
+    h ^= (uint64_t)(uint32_t)key.bx * 0xC2B2AE3D27D4EB4FULL + (h << 6) + (h >> 2);
+    h ^= (uint64_t)(uint32_t)key.by + 0x165667B19E3779F9ULL + (h << 6) + (h >> 2);
+    return (size_t)(h ^ (h >> 29));
+}
+
+int64_t RoadOracle::CellKey(int32_t cx, int32_t cy) {
+    return (int64_t)(((uint64_t)(uint32_t)cx << 32) ^ (uint32_t)cy);
+}
+
+// NearestNode: procura em anéis de células crescentes ao redor do ponto; para ao encontrar um nó cuja distância
+// não possa ser superada por células mais distantes. Se os anéis passarem a cobrir mais células que nós, varre todos os nós
+int RoadOracle::NearestNode(double x, double y) {
+    int32_t cx = CellOf(x, this->cell_size);
+    int32_t cy = CellOf(y, this->cell_size);
+    int best = -1;
+    double best_dist = std::numeric_limits<double>::max();
+
+    for(int32_t ring = 0; (size_t)(ring*2 + 1)*(ring*2 + 1) <= this->node_x.size(); ring++) {
+        for(int32_t ix = cx - ring; ix <= cx + ring; ix++) {
+            for(int32_t iy = cy - ring; iy <= cy + ring; iy++) {
+                if(ix != cx - ring && ix != cx + ring && iy != cy - ring && iy != cy + ring) {
+                    continue;   // somente a borda do anel
+                }
+                std::unordered_map<int64_t, std::vector<int> >::iterator cell = this->node_cells.find(CellKey(ix, iy));
+                if(cell == this->node_cells.end()) {
+                    continue;
+                }
+                for(size_t k = 0; k < cell->second.size(); k++) {
+                    int node = cell->second[k];
+                    double d = EuclideanMetric::Distance(x, y, this->node_x[node], this->node_y[node]);
+                    if(d < best_dist) {
+                        best_dist = d;
+                        best = node;
+                    }
+                }
+            }
+        }
+
+        // Qualquer nó fora dos anéis já visitados está a pelo menos ring*cell_size do ponto
+        if(best >= 0 && best_dist <= ring*this->cell_size) {
+            return best;
+        }
+    }
+
+    // Varredura completa
+    for(size_t node = 0; node < this->node_x.size(); node++) {
+        double d = EuclideanMetric::Distance(x, y, this->node_x[node], this->node_y[node]);
+        if(d < best_dist) {
+            best_dist = d;
+            best = (int)node;
+        }
+    }
+    return best;
+}
+
+// ShortestPath: Dijkstra a partir de from, encerrado quando to é retirado da fila
+double RoadOracle::ShortestPath(int from, int to) {
+    if(from == to) {
+        return 0;
+    }
+
+    std::vector<double> dist(this->node_x.size(), std::numeric_limits<double>::max());
+    std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int> >, std::greater<std::pair<double, int> > > frontier;
+    dist[from] = 0;
+    frontier.push(std::make_pair(0.0, from));
+
+    while(!frontier.empty()) {
+        std::pair<double, int> top = frontier.top();
+        frontier.pop();
+        if(top.second == to) {
+            return top.first;
+        }
+        if(top.first > dist[top.second]) {
+            continue;
+        }
+        for(int e = this->adj_begin[top.second]; e < this->adj_begin[top.second + 1]; e++) {
+            double candidate = top.first + this->adj_len[e];
+            if(candidate < dist[this->adj_to[e]]) {
+                dist[this->adj_to[e]] = candidate;
+                frontier.push(std::make_pair(candidate, this->adj_to[e]));
+            }
+        }
+    }
+    return -1;
+}
+
+// Compute: distância entre os centros das duas células pela malha (ou em linha reta, se não houver caminho)
+double RoadOracle::Compute(const CellPair& key) {
+    double ax = (key.ax + 0.5)*this->cell_size, ay = (key.ay + 0.5)*this->cell_size;
+    double bx = (key.bx + 0.5)*this->cell_size, by = (key.by + 0.5)*this->cell_size;
+
+    int a = NearestNode(ax, ay);
+    int b = NearestNode(bx, by);
+    double path = ShortestPath(a, b);
+    if(path < 0) {
+        return EuclideanMetric::Distance(ax, ay, bx, by);
+    }
+    return EuclideanMetric::Distance(ax, ay, this->node_x[a], this->node_y[a]) + path
+         + EuclideanMetric::Distance(this->node_x[b], this->node_y[b], bx, by);
+}
+
+//-------------------------------------------------------------------------------
+// CONSULTA
+//-------------------------------------------------------------------------------
+
+// Distance: consulta o cache da thread pelas coordenadas exatas; em caso de falta, consulta pelas células (CellDistance)
+// e guarda o resultado no cache da thread
+double RoadOracle::Distance(double ax, double ay, double bx, double by) {
+    if(front_owner != this->serial) {
+        memset(front_cache, 0, sizeof(front_cache));
+        front_owner = this->serial;
+    }
+    FrontEntry& front = front_cache[FrontSlot(ax, ay, bx, by)];
+    if(front.ax == ax && front.ay == ay && front.bx == bx && front.by == by) {
+        return front.value;
+    }
+
+    double value = CellDistance(ax, ay, bx, by);
+    front.ax = ax;
+    front.ay = ay;
+    front.bx = bx;
+    front.by = by;
+    front.value = value;
+    return value;
+}
+
+// CellDistance: alinha os pontos à grade e consulta a fatia do par; em caso de falta, calcula fora do lock (o grafo é
+// somente leitura; duas threads podem calcular o mesmo par, com o mesmo resultado) e substitui a entrada menos recente
+// do conjunto
+double RoadOracle::CellDistance(double ax, double ay, double bx, double by) {
+    CellPair key;
+    key.ax = CellOf(ax, this->cell_size);
+    key.ay = CellOf(ay, this->cell_size);
+    key.bx = CellOf(bx, this->cell_size);
+    key.by = CellOf(by, this->cell_size);
+
+    // Mesma célula: a malha não resolve distâncias menores que a grade
+    if(key.ax == key.bx && key.ay == key.by) {
+        return EuclideanMetric::Distance(ax, ay, bx, by);
+    }
+    if(key.ax > key.bx || (key.ax == key.bx && key.ay > key.by)) {
+        std::swap(key.ax, key.bx);
+        std::swap(key.ay, key.by);
+    }
+
+    size_t hash = CellPairHash()(key);
+    Shard& shard = *this->shards[hash % this->shards.size()];
+    ShardSet& set = shard.sets[(hash / this->shards.size()) & (shard.sets.size() - 1)];
+    {
+        std::lock_guard<std::mutex> guard(shard.lock);
+        for(int i = 0; i < SHARD_WAYS; i++) {
+            if(set.stamps[i] != 0 && set.keys[i] == key) {
+                set.stamps[i] = ++shard.clock;
+                return set.values[i];
+            }
+        }
+    }
+
+    double value = Compute(key);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    int oldest = 0;
+    for(int i = 0; i < SHARD_WAYS; i++) {
+        if(set.stamps[i] != 0 && set.keys[i] == key) {
+            oldest = i;     // Outra thread inseriu o mesmo par enquanto este calculava
+            break;
+        }
+        if(set.stamps[i] < set.stamps[oldest]) {
+            oldest = i;
+        }
+    }
+    set.keys[oldest] = key;
+    set.values[oldest] = value;
+    set.stamps[oldest] = ++shard.clock;
+    return value;
+}
@@ -0,0 +1,329 @@
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <vector>
+#include "event_scaler.hpp"
+#include "simulation_manager.hpp"
+#include "ride_stats.hpp"
+#include "segment_index.hpp"
+
+// Ferramenta de medição e conferência do EventScaler com cancelamentos:
+//   - conferência: sequência sorteada de agendamentos (avulsos e em lote, com sequências ordenadas longas),
+//     cancelamentos, reagendamentos e recuperações, comparada a cada passo com um std::set de (tempo, id); identificadores
+//     já recuperados ou cancelados são reusados de propósito e precisam ser recusados, mesmo com a vaga reaproveitada;
+//   - medição: fila estável de n eventos pendentes em que cada recuperação agenda um evento novo e 10% (-x) dos
+//     agendamentos cancelam um evento pendente sorteado. O mesmo roteiro roda no std::set como referência; ao fim, as
+//     vagas de identificador alocadas precisam acompanhar o pico de pendentes, não o total agendado;
+//   - atrasos no Manager: uma corrida atrasada no meio do percurso mantém início e espera, e só as paradas seguintes, o
+//     fim, o intervalo no RideIndex e os trechos no SegmentIndex mudam; um atraso antes do início desloca a corrida toda
+//     e um atraso negativo é recusado.
+// Uso: scaler_bench.out [-n pendentes] [-o operacoes] [-x fracao_cancelada] [-c passos_conferidos]
+
+typedef std::set<std::pair<double, int> > Reference;
+
+static double Seconds(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// Check: retorna false na primeira divergência entre o EventScaler e a referência
+static bool Check(int steps, unsigned seed) {
+    EventScaler scaler;
+    Reference reference;
+    std::vector<EventHandle> handles;       // Identificador de cada id (os ids nunca se repetem)
+    std::vector<double> times;              // Tempo atual de cada id, enquanto pendente
+    std::vector<int> pending;               // Ids pendentes, para sortear cancelamentos e reagendamentos
+    std::vector<int> where;                 // Posição de cada id em pending (-1 se já saiu)
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    double now = 0;
+    size_t peak = 0;
+
+    auto add = [&](int id, double time, EventHandle handle) {
+        handles.push_back(handle);
+        times.push_back(time);
+        where.push_back(pending.size());
+        pending.push_back(id);
+        reference.insert(std::make_pair(time, id));
+    };
+    auto drop = [&](int id) {
+        int last = pending.back();
+        pending[where[id]] = last;
+        where[last] = where[id];
+        pending.pop_back();
+        where[id] = -1;
+        reference.erase(std::make_pair(times[id], id));
+    };
+
+    for(int step = 0; step < steps; step++) {
+        double action = uniform(random);
+        if(action < 0.35) {
+            int id = handles.size();
+            double time = now + 100*uniform(random);
+            add(id, time, scaler.ScheduleEvent(id, time, EventType::RIDESTOP));
+        }
+        else if(action < 0.37) {
+            // Lote: uma sequência ordenada longa seguida de eventos fora de ordem
+            int amount = 1 + random() % (2*MIN_SORTED_RUN);
+            std::vector<Event> batch;
+            double time = now;
+            for(int k = 0; k < amount; k++) {
+                time = k < MIN_SORTED_RUN ? time + uniform(random) : now + 100*uniform(random);
+                batch.push_back(Event(handles.size() + k, time, EventType::RIDESTART));
+            }
+            EventHandle first = scaler.ScheduleBatch(batch.data(), amount);
+            for(int k = 0; k < amount; k++) {
+                add(batch[k].GetID(), batch[k].GetTime(), first + k);
+            }
+        }
+        else if(action < 0.47) {
+            // Cancelamento de um pendente ou de um identificador que já saiu (precisa falhar)
+            if(handles.empty()) {
+                continue;
+            }
+            int id = random() % handles.size();
+            bool expected = where[id] >= 0;
+            if(scaler.Cancel(handles[id]) != expected) {
+                std::cerr << "Cancel of id " << id << " diverged at step " << step << "." << std::endl;
+                return false;
+            }
+            if(expected) {
+                drop(id);
+            }
+        }
+        else if(action < 0.57) {
+            if(handles.empty()) {
+                continue;
+            }
+            int id = random() % handles.size();
+            bool expected = where[id] >= 0;
+            double time = now + 100*uniform(random);
+            if(scaler.Reschedule(handles[id], time) != expected) {
+                std::cerr << "Reschedule of id " << id << " diverged at step " << step << "." << std::endl;
+                return false;
+            }
+            if(expected) {
+                reference.erase(std::make_pair(times[id], id));
+                times[id] = time;
+                reference.insert(std::make_pair(time, id));
+            }
+        }
+        else if(!reference.empty()) {
+            // Recuperação: às vezes esvazia a fila inteira, para exercitar a compactação das vagas no próximo lote
+            int amount = uniform(random) < 0.01 ? reference.size() : 1;
+            for(int k = 0; k < amount; k++) {
+                std::pair<double, int> first = *reference.begin();
+                Event& event = scaler.GetNextEvent();
+                if(event.GetID() != first.second || event.GetTime() != first.first) {
+                    std::cerr << "Next event diverged at step " << step << ": got " << event.GetID() << " expected "
+                              << first.second << "." << std::endl;
+                    return false;
+                }
+                now = first.first;
+                drop(first.second);
+            }
+        }
+
+        peak = std::max(peak, reference.size());
+        if(scaler.GetSize() != (int)reference.size()) {
+            std::cerr << "Size diverged at step " << step << "." << std::endl;
+            return false;
+        }
+    }
+    std::cout << "check " << steps << " steps: ok (" << handles.size() << " events, peak " << peak << " pending, "
+              << scaler.GetSlotAmount() << " slots)" << std::endl;
+    return true;
+}
+
+// CheckDelays: corrida 0 com duas demandas (0 a 60, entregas em 50 e 60) atrasada 10 em 55, entre as entregas; corrida 1
+// (100 a 150) atrasada 5 antes do início. Retorna false na primeira divergência
+static bool CheckDelays() {
+    Manager manager(2, 1, 10, 5, 20, 0, 3);
+    RideStats stats;
+    SegmentIndex segments;
+    std::ostringstream stops;
+    manager.SetRideStats(&stats);
+    manager.SetSegmentIndex(&segments);
+    manager.SetStopLog(&stops);
+    manager.MakeDemand(0, 0, 0, 0, 50, 0);
+    manager.MakeDemand(1, 1, 1, 0, 60, 0);
+    manager.MakeDemand(2, 100, 0, 0, 50, 0);
+    manager.DelayRide(0, 55, 10);
+    manager.DelayRide(1, 90, 5);
+    try {
+        manager.DelayRide(0, 20, -5);
+        std::cerr << "Negative delay accepted." << std::endl;
+        return false;
+    }
+    catch(const std::invalid_argument&) {
+    }
+
+    while(manager.NextFinishedRide() >= 0) {
+    }
+    segments.Build();
+
+    Ride* ride = manager.GetRide(0);
+    Ride* late = manager.GetRide(1);
+    const double visits[] = {0, 1, 50, 70};
+    bool ok = ride->GetStopAmount() == 4 && ride->GetStart() == 0 && ride->GetEnd() == 70
+              && late->GetStart() == 105 && late->GetEnd() == 155;
+    for(int i = 0; ok && i < 4; i++) {
+        ok = ride->GetStop(i).GetVisitTime() == visits[i];
+    }
+
+    // Espera: 0 e -1 na corrida 0 (o início não muda), 5 na corrida 1
+    QuantileSketch& wait = stats.GetMetric(4);
+    ok = ok && wait.Count() == 3 && wait.Max() == 5 && wait.Min() == -1;
+
+    RideIndex& index = manager.GetRideIndex();
+    ok = ok && index.CountActive(65) == 1 && index.CountActive(0) == 1 && index.CountActive(102) == 0;
+
+    // Trechos da corrida 0: o atraso alonga o trecho entre as entregas
+    const double times[] = {0, 1, 1, 50, 50, 70};
+    for(int i = 0; ok && i < segments.GetEntryAmount(); i++) {
+        const SegmentEntry& entry = segments.GetEntry(i);
+        if(entry.ride == 0) {
+            ok = entry.t0 == times[2*entry.segment] && entry.t1 == times[2*entry.segment + 1];
+        }
+    }
+    if(!ok) {
+        std::cerr << "Ride delays diverged." << std::endl;
+        return false;
+    }
+    std::cout << "check delays: ok" << std::endl;
+    return true;
+}
+
+// Churn: n pendentes; cada operação recupera o próximo evento e agenda outro, e uma fração cancel dos agendamentos
+// também cancela um pendente sorteado (reposto por um agendamento extra, para a fila não encolher)
+template<typename Queue>
+static double Churn(Queue& queue, int amount, long operations, double cancel, unsigned seed, double& checksum) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<int> pending;
+    std::vector<int> where;
+    int next_id = 0;
+
+    auto schedule = [&](double time) {
+        queue.Schedule(next_id, time);
+        where.push_back(pending.size());
+        pending.push_back(next_id);
+        next_id++;
+    };
+    auto drop = [&](int id) {
+        int last = pending.back();
+        pending[where[id]] = last;
+        where[last] = where[id];
+        pending.pop_back();
+    };
+
+    for(int i = 0; i < amount; i++) {
+        schedule(1000*uniform(random));
+    }
+    auto begin = std::chrono::steady_clock::now();
+    for(long op = 0; op < operations; op++) {
+        double now;
+        int id = queue.Next(now);
+        checksum += now;
+        drop(id);
+        schedule(now + 1000*uniform(random));
+        if(uniform(random) < cancel) {
+            int victim = pending[random() % pending.size()];
+            queue.Cancel(victim);
+            drop(victim);
+            schedule(now + 1000*uniform(random));
+        }
+    }
+    return Seconds(begin);
+}
+
+// Adaptadores para o mesmo roteiro nas duas filas
+struct ScalerQueue {
+    EventScaler scaler;
+    std::vector<EventHandle> handles;
+    void Schedule(int id, double time) {
+        handles.push_back(scaler.ScheduleEvent(id, time, EventType::RIDESTOP));
+    }
+    int Next(double& time) {
+        Event& event = scaler.GetNextEvent();
+        time = event.GetTime();
+        return event.GetID();
+    }
+    void Cancel(int id) {
+        scaler.Cancel(handles[id]);
+    }
+};
+
+struct ReferenceQueue {
+    Reference events;
+    std::vector<double> times;
+    void Schedule(int id, double time) {
+        times.push_back(time);
+        events.insert(std::make_pair(time, id));
+    }
+    int Next(double& time) {
+        time = events.begin()->first;
+        int id = events.begin()->second;
+        events.erase(events.begin());
+        return id;
+    }
+    void Cancel(int id) {
+        events.erase(std::make_pair(times[id], id));
+    }
+};
+
+int main(int argc, char* argv[]) {
+    int amount = 1000000;
+    long operations = 10000000;
+    double cancel = 0.1;
+    int checked = 1000000;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            amount = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            operations = atol(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-x") == 0 && i + 1 < argc) {
+            cancel = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            checked = atoi(argv[++i]);
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-n pending] [-o operations] [-x cancel_fraction] [-c checked_steps]" << std::endl;
+            return 1;
+        }
+    }
+
+    if(checked > 0 && (!Check(checked, 31) || !CheckDelays())) {
+        return 1;
+    }
+
+    std::cout << std::fixed;
+    double scaler_sum = 0, reference_sum = 0;
+    ScalerQueue scaler;
+    double seconds = Churn(scaler, amount, operations, cancel, 5, scaler_sum);
+    std::cout << "scaler: " << std::setprecision(3) << seconds << " s, " << std::setprecision(1)
+              << seconds/operations*1e9 << " ns/op, " << scaler.handles.size() << " events scheduled, "
+              << scaler.scaler.GetSlotAmount() << " slots" << std::endl;
+    ReferenceQueue reference;
+    double reference_seconds = Churn(reference, amount, operations, cancel, 5, reference_sum);
+    std::cout << "std::set: " << std::setprecision(3) << reference_seconds << " s, " << std::setprecision(1)
+              << reference_seconds/operations*1e9 << " ns/op" << std::endl;
+
+    if(scaler_sum != reference_sum) {
+        std::cerr << "Scaler and std::set diverged." << std::endl;
+        return 1;
+    }
+    if(scaler.scaler.GetSlotAmount() > 2*amount) {
+        std::cerr << "Handle slots grew with the scheduled events." << std::endl;
+        return 1;
+    }
+    return 0;
+}
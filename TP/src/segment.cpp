@@ -1,5 +1,8 @@
+#include <type_traits>
 #include "segment.hpp"
 
+static_assert(std::is_trivially_copyable<Segment>::value, "Segment must be trivially copyable");
+
 //-------------------------------------------------------------------------------
 // CONSTRUTORES E DESTRUTOR
 //-------------------------------------------------------------------------------
@@ -11,16 +14,17 @@ Segment::Segment() {
     this->complete = false;
     this->total_distance = 0;
     this->type = SegmentType::PICKUP;
-
-    this->static_mem_usage = sizeof(SegmentType) + sizeof(double) + sizeof(bool) + sizeof(int);
 }
 
 // CONSTRUTOR PRINCIPAL: inicializa os ponteiros referenciando as paradas passadas como parâmetro e formaliza o tipo de segmento com base nas paradas
-Segment::Segment(Stop& begs, Stop& ends) {
+Segment::Segment(Stop& begs, Stop& ends) : Segment(begs, ends, begs.Distance(ends)) { }
+
+// CONSTRUTOR COM DISTÂNCIA: mesmo comportamento, usando a distância passada (Ride usa a guardada pelo grupo)
+Segment::Segment(Stop& begs, Stop& ends, double distance) {
     this->beg = &begs;
     this->end = &ends;
     this->complete = false;
-    this->total_distance = beg->Distance(*end);
+    this->total_distance = distance;
     
     // Detecta automaticamente o tipo de segmento com base no tipo das paradas
     switch(beg->GetType()) {
@@ -43,8 +47,6 @@ Segment::Segment(Stop& begs, Stop& ends) {
             }
             break;
     }
-
-    this->static_mem_usage = sizeof(SegmentType) + begs.GetMemoryUsage() + ends.GetMemoryUsage() + sizeof(double) + sizeof(bool) + sizeof(int);
 }
 
 //-------------------------------------------------------------------------------
@@ -56,41 +58,17 @@ void Segment::MarkComplete() {
     this->complete = true;
 }
 
-// Sobrecarga de operação: atualiza as paradas e os atributos de acordo
-void Segment::operator=(Segment& other) {
-    if(this->beg = nullptr) {
-        this->beg = other.beg;
-    }
-    else {
-        delete this->beg;
-        this->beg = other.beg;
-    }
-
-    if(this->end = nullptr) {
-        this->end = other.end;
-    }
-    else {
-        delete this->end;
-        this->end = other.end;
-    }
-    
-    this->total_distance = other.total_distance;
-    this->type = other.type;
-
-    this->static_mem_usage = other.static_mem_usage;
-}
-
 // Retorna o tipo do segmento
-SegmentType Segment::GetType() {
+SegmentType Segment::GetType() const {
     return this->type;
 }
 
 // Retorna a distância total do segmento
-double Segment::GetDistance() {
+double Segment::GetDistance() const {
     return this->total_distance;
 }
 
-// Retorna o uso da memória do objeto
+// Retorna o uso da memória de um segmento
 int Segment::GetMemoryUsage() {
-    return this->static_mem_usage;
+    return sizeof(Segment);
 }
\ No newline at end of file
@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include "segment_index.hpp"
+
+static_assert(std::is_trivially_copyable<SegmentEntry>::value, "SegmentEntry is saved byte by byte");
+
+static const char MAGIC[8] = {'D', 'S', 'S', 'E', 'G', 'I', 'X', '1'};
+
+//-------------------------------------------------------------------------------
+// FUNÇÕES AUXILIARES
+//-------------------------------------------------------------------------------
+
+// StrOrder: ordem STR dos itens pelos centros - fatias verticais de ~sqrt(P) nós por x e, dentro de cada fatia, por y
+static void StrOrder(const std::vector<double>& cx, const std::vector<double>& cy, std::vector<int>& order) {
+    int n = cx.size();
+    order.resize(n);
+    for(int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&cx](int a, int b) {
+        return cx[a] < cx[b];
+    });
+
+    int parents = (n + SEGMENT_NODE_CAPACITY - 1)/SEGMENT_NODE_CAPACITY;
+    int slices = (int)ceil(sqrt((double)parents));
+    int slice_size = ((parents + slices - 1)/slices)*SEGMENT_NODE_CAPACITY;
+    for(int begin = 0; begin < n; begin += slice_size) {
+        int end = std::min(n, begin + slice_size);
+        std::sort(order.begin() + begin, order.begin() + end, [&cy](int a, int b) {
+            return cy[a] < cy[b];
+        });
+    }
+}
+
+// Permute: reorganiza o trecho [first, first + order.size()) do vetor na ordem passada
+template <typename T>
+static void Permute(std::vector<T>& items, int32_t first, const std::vector<int>& order) {
+    std::vector<T> sorted(order.size());
+    for(size_t i = 0; i < order.size(); i++) {
+        sorted[i] = items[first + order[i]];
+    }
+    std::copy(sorted.begin(), sorted.end(), items.begin() + first);
+}
+
+// BoxDistance: distância do ponto à caixa (0 se dentro)
+static double BoxDistance(double min_x, double min_y, double max_x, double max_y, double x, double y) {
+    double dx = std::max(std::max(min_x - x, 0.0), x - max_x);
+    double dy = std::max(std::max(min_y - y, 0.0), y - max_y);
+    return sqrt(dx*dx + dy*dy);
+}
+
+// CrossesBox: recorte de Liang-Barsky; o trecho cruza a caixa se sobrar alguma parte dele depois do recorte
+static bool CrossesBox(const SegmentEntry& e, double min_x, double min_y, double max_x, double max_y) {
+    double from = 0, to = 1;
+    double dx = e.x1 - e.x0, dy = e.y1 - e.y0;
+    double p[4] = {-dx, dx, -dy, dy};
+    double q[4] = {e.x0 - min_x, max_x - e.x0, e.y0 - min_y, max_y - e.y0};
+    for(int i = 0; i < 4; i++) {
+        if(p[i] == 0) {
+            if(q[i] < 0) {
+                return false;
+            }
+        }
+        else if(p[i] < 0) {
+            from = std::max(from, q[i]/p[i]);
+        }
+        else {
+            to = std::min(to, q[i]/p[i]);
+        }
+    }
+    return from <= to;
+}
+
+static bool InTime(const SegmentEntry& e, double t0, double t1) {
+    return e.t1 >= t0 && e.t0 <= t1;
+}
+
+//-------------------------------------------------------------------------------
+// CONSTRUTOR
+//-------------------------------------------------------------------------------
+
+SegmentIndex::SegmentIndex() {
+    Clear();
+}
+
+void SegmentIndex::Clear() {
+    this->entries.clear();
+    this->nodes.clear();
+    this->leaf_amount = 0;
+    this->built = false;
+}
+
+//-------------------------------------------------------------------------------
+// CONSTRUÇÃO
+//-------------------------------------------------------------------------------
+
+// AddRide: a corrida percorre os segmentos em sequência a partir do início, na velocidade dos veículos; um atraso depois
+// do início alonga o trecho em que o veículo estava e desloca os seguintes
+void SegmentIndex::AddRide(int id, Ride& ride, double veh_speed) {
+    if(this->built) {
+        throw std::logic_error("SegmentIndex: can't add rides after Build.");
+    }
+    double time = ride.GetStart();
+    double traveled = 0;
+    for(int i = 0; i + 1 < ride.GetStopAmount(); i++) {
+        SegmentEntry entry;
+        const Point2D& from = ride.GetStop(i).GetPoint();
+        const Point2D& to = ride.GetStop(i + 1).GetPoint();
+        entry.x0 = from.GetX();
+        entry.y0 = from.GetY();
+        entry.x1 = to.GetX();
+        entry.y1 = to.GetY();
+        entry.t0 = time + ride.DelayBefore(traveled);
+        time += ride.GetSegment(i).GetDistance()/veh_speed;
+        traveled += ride.GetSegment(i).GetDistance();
+        entry.t1 = time + ride.DelayBefore(traveled);
+        entry.ride = id;
+        entry.segment = i;
+        this->entries.push_back(entry);
+    }
+}
+
+// Build: folhas sobre os trechos e, enquanto o nível tiver mais de um nó, um novo nível sobre ele
+void SegmentIndex::Build() {
+    this->nodes.clear();
+    if(!this->entries.empty()) {
+        Pack(0, this->entries.size(), true);
+        this->leaf_amount = this->nodes.size();
+
+        int32_t first = 0;
+        int32_t amount = this->leaf_amount;
+        while(amount > 1) {
+            Pack(first, amount, false);
+            first += amount;
+            amount = this->nodes.size() - first;
+        }
+    }
+    this->built = true;
+}
+
+// Pack: ordena o nível de baixo em STR e agrupa cada SEGMENT_NODE_CAPACITY itens consecutivos em um novo nó
+// Reordenar nós do nível de baixo é seguro: seus filhos estão em níveis ainda mais baixos, que não mudam mais
+void SegmentIndex::Pack(int32_t first, int32_t amount, bool leaves) {
+    std::vector<double> cx(amount), cy(amount);
+    for(int32_t i = 0; i < amount; i++) {
+        if(leaves) {
+            const SegmentEntry& e = this->entries[first + i];
+            cx[i] = (e.x0 + e.x1)/2;
+            cy[i] = (e.y0 + e.y1)/2;
+        }
+        else {
+            const Node& n = this->nodes[first + i];
+            cx[i] = (n.min_x + n.max_x)/2;
+            cy[i] = (n.min_y + n.max_y)/2;
+        }
+    }
+    std::vector<int> order;
+    StrOrder(cx, cy, order);
+    if(leaves) {
+        Permute(this->entries, first, order);
+    }
+    else {
+        Permute(this->nodes, first, order);
+    }
+
+    for(int32_t begin = 0; begin < amount; begin += SEGMENT_NODE_CAPACITY) {
+        Node parent;
+        parent.first = first + begin;
+        parent.amount = std::min(SEGMENT_NODE_CAPACITY, amount - begin);
+        parent.min_x = parent.min_y = parent.t0 = INFINITY;
+        parent.max_x = parent.max_y = parent.t1 = -INFINITY;
+        for(int32_t i = parent.first; i < parent.first + parent.amount; i++) {
+            if(leaves) {
+                const SegmentEntry& e = this->entries[i];
+                parent.min_x = std::min(parent.min_x, std::min(e.x0, e.x1));
+                parent.min_y = std::min(parent.min_y, std::min(e.y0, e.y1));
+                parent.max_x = std::max(parent.max_x, std::max(e.x0, e.x1));
+                parent.max_y = std::max(parent.max_y, std::max(e.y0, e.y1));
+                parent.t0 = std::min(parent.t0, e.t0);
+                parent.t1 = std::max(parent.t1, e.t1);
+            }
+            else {
+                const Node& n = this->nodes[i];
+                parent.min_x = std::min(parent.min_x, n.min_x);
+                parent.min_y = std::min(parent.min_y, n.min_y);
+                parent.max_x = std::max(parent.max_x, n.max_x);
+                parent.max_y = std::max(parent.max_y, n.max_y);
+                parent.t0 = std::min(parent.t0, n.t0);
+                parent.t1 = std::max(parent.t1, n.t1);
+            }
+        }
+        this->nodes.push_back(parent);
+    }
+}
+
+bool SegmentIndex::IsBuilt() {
+    return this->built;
+}
+
+//-------------------------------------------------------------------------------
+// CONSULTAS
+//-------------------------------------------------------------------------------
+
+// QueryBox: descida em profundidade pelos nós cuja caixa e intervalo de tempo se sobrepõem à consulta
+void SegmentIndex::QueryBox(double min_x, double min_y, double max_x, double max_y, double t0, double t1, std::vector<int>& hits) {
+    hits.clear();
+    if(this->nodes.empty()) {
+        return;
+    }
+    std::vector<int> pending(1, this->nodes.size() - 1);
+    while(!pending.empty()) {
+        const Node& node = this->nodes[pending.back()];
+        bool leaf = pending.back() < this->leaf_amount;
+        pending.pop_back();
+        if(node.max_x < min_x || node.min_x > max_x || node.max_y < min_y || node.min_y > max_y || node.t1 < t0 || node.t0 > t1) {
+            continue;
+        }
+        for(int32_t i = node.first; i < node.first + node.amount; i++) {
+            if(!leaf) {
+                pending.push_back(i);
+            }
+            else if(InTime(this->entries[i], t0, t1) && CrossesBox(this->entries[i], min_x, min_y, max_x, max_y)) {
+                hits.push_back(i);
+            }
+        }
+    }
+}
+
+// QueryNear: mesma descida, podando nós cuja caixa está a mais de radius do ponto
+void SegmentIndex::QueryNear(double x, double y, double radius, double t0, double t1, std::vector<int>& hits) {
+    hits.clear();
+    if(this->nodes.empty()) {
+        return;
+    }
+    std::vector<int> pending(1, this->nodes.size() - 1);
+    while(!pending.empty()) {
+        const Node& node = this->nodes[pending.back()];
+        bool leaf = pending.back() < this->leaf_amount;
+        pending.pop_back();
+        if(node.t1 < t0 || node.t0 > t1 || BoxDistance(node.min_x, node.min_y, node.max_x, node.max_y, x, y) > radius) {
+            continue;
+        }
+        for(int32_t i = node.first; i < node.first + node.amount; i++) {
+            if(!leaf) {
+                pending.push_back(i);
+            }
+            else if(InTime(this->entries[i], t0, t1) && Distance(this->entries[i], x, y) <= radius) {
+                hits.push_back(i);
+            }
+        }
+    }
+}
+
+// Nearest: busca pelo melhor primeiro - nós (pela distância da caixa) e trechos (pela distância exata) numa mesma fila;
+// um trecho que sai da fila é mais próximo que tudo o que ainda está nela
+void SegmentIndex::Nearest(double x, double y, int k, double t0, double t1, std::vector<int>& hits) {
+    hits.clear();
+    if(this->nodes.empty() || k <= 0) {
+        return;
+    }
+    typedef std::pair<double, int> Item;       // Distância e nó (>= 0) ou trecho (-1 - posição)
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item> > queue;
+    queue.push(Item(0, this->nodes.size() - 1));
+    while(!queue.empty() && (int)hits.size() < k) {
+        Item item = queue.top();
+        queue.pop();
+        if(item.second < 0) {
+            hits.push_back(-1 - item.second);
+            continue;
+        }
+
+        const Node& node = this->nodes[item.second];
+        bool leaf = item.second < this->leaf_amount;
+        for(int32_t i = node.first; i < node.first + node.amount; i++) {
+            if(leaf) {
+                if(InTime(this->entries[i], t0, t1)) {
+                    queue.push(Item(Distance(this->entries[i], x, y), -1 - i));
+                }
+            }
+            else {
+                const Node& child = this->nodes[i];
+                if(child.t1 >= t0 && child.t0 <= t1) {
+                    queue.push(Item(BoxDistance(child.min_x, child.min_y, child.max_x, child.max_y, x, y), i));
+                }
+            }
+        }
+    }
+}
+
+const SegmentEntry& SegmentIndex::GetEntry(int index) {
+    if(index < 0 || index >= (int)this->entries.size()) {
+        throw std::out_of_range("SegmentIndex: inaccessible entry");
+    }
+    return this->entries[index];
+}
+
+int SegmentIndex::GetEntryAmount() {
+    return this->entries.size();
+}
+
+// Distance: projeção do ponto na reta do trecho, limitada às duas extremidades
+double SegmentIndex::Distance(const SegmentEntry& entry, double x, double y) {
+    double dx = entry.x1 - entry.x0, dy = entry.y1 - entry.y0;
+    double length = dx*dx + dy*dy;
+    double t = length > 0 ? ((x - entry.x0)*dx + (y - entry.y0)*dy)/length : 0;
+    t = std::max(0.0, std::min(1.0, t));
+    double px = entry.x0 + t*dx - x, py = entry.y0 + t*dy - y;
+    return sqrt(px*px + py*py);
+}
+
+//-------------------------------------------------------------------------------
+// SERIALIZAÇÃO
+//-------------------------------------------------------------------------------
+
+// Save: cabeçalho (MAGIC, quantidades de trechos e nós, quantidade de folhas) seguido dos dois vetores
+void SegmentIndex::Save(const std::string& path) {
+    if(!this->built) {
+        throw std::logic_error("SegmentIndex: Build before Save.");
+    }
+    std::ofstream file(path, std::ios::binary);
+    uint64_t entry_amount = this->entries.size();
+    uint64_t node_amount = this->nodes.size();
+    int32_t reserved = 0;
+    file.write(MAGIC, 8);
+    file.write((const char*)&entry_amount, 8);
+    file.write((const char*)&node_amount, 8);
+    file.write((const char*)&this->leaf_amount, 4);
+    file.write((const char*)&reserved, 4);
+    file.write((const char*)this->entries.data(), sizeof(SegmentEntry)*entry_amount);
+    file.write((const char*)this->nodes.data(), sizeof(Node)*node_amount);
+    if(!file) {
+        throw std::runtime_error("SegmentIndex: can't write " + path);
+    }
+}
+
+// Load: o cabeçalho é conferido contra o tamanho do arquivo antes de qualquer alocação, e os nós contra a estrutura
+// que Build produz (folhas apontam para trechos, os demais nós para nós anteriores, raiz no fim) antes do índice ser
+// usado; um arquivo inválido deixa o índice vazio
+void SegmentIndex::Load(const std::string& path) {
+    Clear();
+    std::ifstream file(path, std::ios::binary);
+    char magic[8];
+    uint64_t entry_amount, node_amount;
+    int32_t leaf_amount, reserved;
+    file.read(magic, 8);
+    file.read((char*)&entry_amount, 8);
+    file.read((char*)&node_amount, 8);
+    file.read((char*)&leaf_amount, 4);
+    file.read((char*)&reserved, 4);
+    if(!file || memcmp(magic, MAGIC, 8) != 0) {
+        throw std::runtime_error("SegmentIndex: not a segment index: " + path);
+    }
+
+    // Tamanhos: os dois vetores precisam ocupar exatamente o resto do arquivo
+    std::streamoff header = file.tellg();
+    file.seekg(0, std::ios::end);
+    uint64_t remaining = (uint64_t)(file.tellg() - header);
+    file.seekg(header);
+    if(entry_amount > remaining/sizeof(SegmentEntry) || node_amount > remaining/sizeof(Node)
+        || entry_amount > INT32_MAX || node_amount > INT32_MAX) {
+        throw std::runtime_error("SegmentIndex: truncated segment index: " + path);
+    }
+    if(sizeof(SegmentEntry)*entry_amount + sizeof(Node)*node_amount != remaining) {
+        throw std::runtime_error("SegmentIndex: segment index size doesn't match its header: " + path);
+    }
+    if(leaf_amount < 0 || (uint64_t)leaf_amount > node_amount || (entry_amount == 0) != (node_amount == 0)
+        || (node_amount > 0 && leaf_amount == 0)) {
+        throw std::runtime_error("SegmentIndex: invalid node counts: " + path);
+    }
+
+    std::vector<SegmentEntry> entries(entry_amount);
+    std::vector<Node> nodes(node_amount);
+    file.read((char*)entries.data(), sizeof(SegmentEntry)*entry_amount);
+    file.read((char*)nodes.data(), sizeof(Node)*node_amount);
+    if(!file) {
+        throw std::runtime_error("SegmentIndex: truncated segment index: " + path);
+    }
+
+    // Filhos: trechos nas folhas e, nos demais nós, nós anteriores a ele (sem ciclos). Cada trecho e cada nó fora a raiz
+    // precisa ter exatamente um pai, então as consultas percorrem no máximo o arquivo inteiro
+    std::vector<char> entry_parent(entry_amount, 0), node_parent(node_amount, 0);
+    for(uint64_t i = 0; i < node_amount; i++) {
+        const Node& node = nodes[i];
+        bool leaf = (int64_t)i < leaf_amount;
+        int64_t limit = leaf ? (int64_t)entry_amount : (int64_t)i;
+        if(node.amount < 1 || node.amount > SEGMENT_NODE_CAPACITY || node.first < 0 || (int64_t)node.first + node.amount > limit) {
+            throw std::runtime_error("SegmentIndex: invalid node " + std::to_string(i) + ": " + path);
+        }
+        std::vector<char>& parent = leaf ? entry_parent : node_parent;
+        for(int32_t c = node.first; c < node.first + node.amount; c++) {
+            if(parent[c]++) {
+                throw std::runtime_error("SegmentIndex: node " + std::to_string(i) + " shares a child: " + path);
+            }
+        }
+    }
+    if(std::count(entry_parent.begin(), entry_parent.end(), 0) > 0
+        || (node_amount > 0 && std::count(node_parent.begin(), node_parent.end() - 1, 0) > 0)) {
+        throw std::runtime_error("SegmentIndex: unreachable segments or nodes: " + path);
+    }
+
+    this->entries.swap(entries);
+    this->nodes.swap(nodes);
+    this->leaf_amount = leaf_amount;
+    this->built = true;
+}
+
+//-------------------------------------------------------------------------------
+// CONTROLE DE MEMÓRIA
+//-------------------------------------------------------------------------------
+
+int64_t SegmentIndex::GetMemoryUsage() {
+    return sizeof(SegmentIndex) + (int64_t)sizeof(SegmentEntry)*this->entries.capacity() + (int64_t)sizeof(Node)*this->nodes.capacity();
+}
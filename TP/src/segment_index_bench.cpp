@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include "segment_index.hpp"
+
+// Ferramenta de medição e conferência do SegmentIndex com corridas sorteadas de 4 demandas (7 trechos cada), com origens
+// espalhadas por uma área de 10^4 x 10^4 e destinos a até 200 da origem:
+//   - conferência: em um índice menor (-c trechos), consultas box, near e nearest (com e sem janela de tempo) são
+//     comparadas com a varredura de todos os trechos; em nearest, as distâncias dos k resultados precisam ser as k menores
+//     (a menos de arredondamento). As consultas box também são conferidas em corridas de coordenadas inteiras com todos
+//     os trechos verticais ou horizontais (alguns de comprimento zero) e caixas de cantos inteiros (algumas de largura
+//     ou altura zero), que exercitam os casos de borda do recorte: a varredura usa um teste independente (extremo
+//     dentro da caixa ou cruzamento com um dos lados, por orientação), exato para coordenadas inteiras;
+//   - medição: em n trechos (-n, 10^7 por padrão), tempo e memória da construção e latência média das consultas.
+// Uso: segment_index_bench.out [-n trechos] [-q consultas] [-c trechos_conferidos]
+
+static const int RIDE_DEMANDS = 4;
+static const double AREA = 10000.0;
+
+// Fill: acrescenta corridas até o índice ter amount trechos (aproximadamente) e o constrói
+static void Fill(SegmentIndex& index, int amount, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> place(0.0, AREA);
+    std::uniform_real_distribution<double> spread(-20.0, 20.0);
+    std::uniform_real_distribution<double> trip(-200.0, 200.0);
+    std::uniform_real_distribution<double> when(0.0, 1000.0);
+    DemandGroup group(RIDE_DEMANDS);
+    int rides = (amount + 2*RIDE_DEMANDS - 2)/(2*RIDE_DEMANDS - 1);
+    for(int r = 0; r < rides; r++) {
+        double ox = place(random), oy = place(random), t = when(random);
+        double dx = ox + trip(random), dy = oy + trip(random);
+        group.Clear();
+        for(int d = 0; d < RIDE_DEMANDS; d++) {
+            Demand demand(r*RIDE_DEMANDS + d, t + d, ox + spread(random), oy + spread(random), dx + spread(random), dy + spread(random));
+            group.Insert(demand);
+        }
+        Ride ride(group, 0);
+        index.AddRide(r, ride, 10.0);
+    }
+    index.Build();
+}
+
+// FillAxis: corridas de 2 demandas com coordenadas inteiras em [0, side], todos os trechos paralelos aos eixos:
+// coleta (a, b) -> (a, e) vertical, deslocamento (a, e) -> (c, e) horizontal e entrega (c, e) -> (c, f) vertical
+static void FillAxis(SegmentIndex& index, int rides, int side, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> coord(0, side);
+    DemandGroup group(2);
+    for(int r = 0; r < rides; r++) {
+        double a = coord(random), b = coord(random), c = coord(random), e = coord(random), f = coord(random);
+        group.Clear();
+        Demand first(2*r, r, a, b, c, e);
+        Demand second(2*r + 1, r, a, e, c, f);
+        group.Insert(first);
+        group.Insert(second);
+        Ride ride(group, 0);
+        index.AddRide(r, ride, 1.0);
+    }
+    index.Build();
+}
+
+static double Seconds(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+static bool InTime(const SegmentEntry& e, double t0, double t1) {
+    return e.t1 >= t0 && e.t0 <= t1;
+}
+
+// Orientation: sinal do produto vetorial (b - a) x (c - a)
+static int Orientation(double ax, double ay, double bx, double by, double cx, double cy) {
+    double cross = (bx - ax)*(cy - ay) - (by - ay)*(cx - ax);
+    return (cross > 0) - (cross < 0);
+}
+
+// Between: c está no retângulo de a e b (para pontos colineares, sobre o segmento)
+static bool Between(double ax, double ay, double bx, double by, double cx, double cy) {
+    return std::min(ax, bx) <= cx && cx <= std::max(ax, bx) && std::min(ay, by) <= cy && cy <= std::max(ay, by);
+}
+
+// Touch: os segmentos ab e cd têm algum ponto em comum (incluindo extremos e sobreposição colinear)
+static bool Touch(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy) {
+    int o1 = Orientation(ax, ay, bx, by, cx, cy), o2 = Orientation(ax, ay, bx, by, dx, dy);
+    int o3 = Orientation(cx, cy, dx, dy, ax, ay), o4 = Orientation(cx, cy, dx, dy, bx, by);
+    if(o1 != o2 && o3 != o4 && o1*o2 <= 0 && o3*o4 <= 0 && (o1 != 0 || o2 != 0)) {
+        return true;
+    }
+    return (o1 == 0 && Between(ax, ay, bx, by, cx, cy)) || (o2 == 0 && Between(ax, ay, bx, by, dx, dy))
+        || (o3 == 0 && Between(cx, cy, dx, dy, ax, ay)) || (o4 == 0 && Between(cx, cy, dx, dy, bx, by));
+}
+
+// BoxHit: o trecho cruza a caixa fechada se um extremo está dentro dela ou se ele toca um dos quatro lados
+static bool BoxHit(const SegmentEntry& e, double min_x, double min_y, double max_x, double max_y) {
+    if((min_x <= e.x0 && e.x0 <= max_x && min_y <= e.y0 && e.y0 <= max_y)
+        || (min_x <= e.x1 && e.x1 <= max_x && min_y <= e.y1 && e.y1 <= max_y)) {
+        return true;
+    }
+    return Touch(e.x0, e.y0, e.x1, e.y1, min_x, min_y, max_x, min_y) || Touch(e.x0, e.y0, e.x1, e.y1, max_x, min_y, max_x, max_y)
+        || Touch(e.x0, e.y0, e.x1, e.y1, max_x, max_y, min_x, max_y) || Touch(e.x0, e.y0, e.x1, e.y1, min_x, max_y, min_x, min_y);
+}
+
+// CheckBox: uma consulta box contra a varredura completa
+static bool CheckBox(SegmentIndex& index, double min_x, double min_y, double max_x, double max_y, double t0, double t1) {
+    std::vector<int> found, expected;
+    for(int i = 0; i < index.GetEntryAmount(); i++) {
+        const SegmentEntry& e = index.GetEntry(i);
+        if(InTime(e, t0, t1) && BoxHit(e, min_x, min_y, max_x, max_y)) {
+            expected.push_back(i);
+        }
+    }
+    index.QueryBox(min_x, min_y, max_x, max_y, t0, t1, found);
+    std::sort(found.begin(), found.end());
+    if(found != expected) {
+        std::cerr << "Box query diverged at (" << min_x << ", " << min_y << ", " << max_x << ", " << max_y << ")." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// CheckAxis: consultas box nas corridas de trechos paralelos aos eixos; retorna false na primeira divergência
+static bool CheckAxis(int rides, int queries) {
+    const int side = 100;
+    SegmentIndex index;
+    FillAxis(index, rides, side, 23);
+
+    std::mt19937 random(24);
+    std::uniform_int_distribution<int> corner(-5, side + 5);
+    std::uniform_int_distribution<int> extent(0, 20);
+    std::uniform_int_distribution<int> when(0, rides);
+    for(int q = 0; q < queries; q++) {
+        double min_x = corner(random), min_y = corner(random);
+        double max_x = min_x + (q % 4 == 1 ? 0 : extent(random)), max_y = min_y + (q % 4 == 2 ? 0 : extent(random));
+        double t0 = -INFINITY, t1 = INFINITY;
+        if(q % 2 == 1) {
+            t0 = when(random);
+            t1 = t0 + rides/10;
+        }
+        if(!CheckBox(index, min_x, min_y, max_x, max_y, t0, t1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Check: box, near e nearest contra a varredura completa; retorna false na primeira divergência
+static bool Check(int amount, int queries) {
+    SegmentIndex index;
+    Fill(index, amount, 21);
+    int n = index.GetEntryAmount();
+
+    std::mt19937 random(22);
+    std::uniform_real_distribution<double> place(0.0, AREA);
+    std::uniform_real_distribution<double> radius(10.0, 400.0);
+    std::uniform_real_distribution<double> when(0.0, 2000.0);
+    std::vector<int> found, expected;
+    for(int q = 0; q < queries; q++) {
+        double x = place(random), y = place(random), r = radius(random);
+        double t0 = -INFINITY, t1 = INFINITY;
+        if(q % 2 == 1) {
+            t0 = when(random);
+            t1 = t0 + 200;
+        }
+
+        if(!CheckBox(index, x - r, y - r/2, x + r/2, y + r, t0, t1)) {
+            return false;
+        }
+
+        expected.clear();
+        for(int i = 0; i < n; i++) {
+            const SegmentEntry& e = index.GetEntry(i);
+            if(InTime(e, t0, t1) && SegmentIndex::Distance(e, x, y) <= r) {
+                expected.push_back(i);
+            }
+        }
+        index.QueryNear(x, y, r, t0, t1, found);
+        std::sort(found.begin(), found.end());
+        if(found != expected) {
+            std::cerr << "Near query diverged at (" << x << ", " << y << ", " << r << ")." << std::endl;
+            return false;
+        }
+
+        // Nearest: as distâncias em ordem precisam coincidir. Empates podem trocar os trechos e, entre trechos que dividem
+        // uma parada, a projeção e a distância à caixa diferem no último bit, então a comparação tem tolerância relativa
+        int k = 1 + q % 16;
+        std::vector<double> all;
+        for(int i = 0; i < n; i++) {
+            const SegmentEntry& e = index.GetEntry(i);
+            if(InTime(e, t0, t1)) {
+                all.push_back(SegmentIndex::Distance(e, x, y));
+            }
+        }
+        std::sort(all.begin(), all.end());
+        all.resize(std::min<size_t>(k, all.size()));
+        index.Nearest(x, y, k, t0, t1, found);
+        bool same = found.size() == all.size();
+        for(size_t i = 0; same && i < found.size(); i++) {
+            const SegmentEntry& e = index.GetEntry(found[i]);
+            same = InTime(e, t0, t1) && fabs(SegmentIndex::Distance(e, x, y) - all[i]) <= 1e-12*all[i];
+        }
+        if(!same) {
+            std::cerr << "Nearest query diverged at (" << x << ", " << y << ", k = " << k << ")." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int amount = 10000000;
+    int queries = 100000;
+    int checked = 50000;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            amount = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-q") == 0 && i + 1 < argc) {
+            queries = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            checked = atoi(argv[++i]);
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-n segments] [-q queries] [-c checked_segments]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << std::fixed;
+    if(checked > 0) {
+        if(!Check(checked, 1000) || !CheckAxis(checked/3, 5000)) {
+            return 1;
+        }
+        std::cout << "check " << checked << " segments (and " << checked/3 << " axis-parallel rides): ok" << std::endl;
+    }
+
+    SegmentIndex index;
+    auto begin = std::chrono::steady_clock::now();
+    Fill(index, amount, 7);
+    double build = Seconds(begin);
+    std::cout << "build " << index.GetEntryAmount() << " segments (with ride creation): " << std::setprecision(2) << build
+              << " s, " << index.GetMemoryUsage()/(1024.0*1024.0) << " MB" << std::endl;
+
+    std::mt19937 random(8);
+    std::uniform_real_distribution<double> place(0.0, AREA);
+    std::vector<double> xs(queries), ys(queries);
+    for(int q = 0; q < queries; q++) {
+        xs[q] = place(random);
+        ys[q] = place(random);
+    }
+
+    std::vector<int> hits;
+    long total = 0;
+    begin = std::chrono::steady_clock::now();
+    for(int q = 0; q < queries; q++) {
+        index.QueryBox(xs[q] - 5, ys[q] - 5, xs[q] + 5, ys[q] + 5, -INFINITY, INFINITY, hits);
+        total += hits.size();
+    }
+    std::cout << "box query (10x10): " << std::setprecision(2) << Seconds(begin)/queries*1e6 << " us, average hits "
+              << (double)total/queries << std::endl;
+
+    total = 0;
+    begin = std::chrono::steady_clock::now();
+    for(int q = 0; q < queries; q++) {
+        index.QueryNear(xs[q], ys[q], 5, -INFINITY, INFINITY, hits);
+        total += hits.size();
+    }
+    std::cout << "near query (radius 5): " << std::setprecision(2) << Seconds(begin)/queries*1e6 << " us, average hits "
+              << (double)total/queries << std::endl;
+
+    begin = std::chrono::steady_clock::now();
+    for(int q = 0; q < queries; q++) {
+        index.Nearest(xs[q], ys[q], 5, -INFINITY, INFINITY, hits);
+    }
+    std::cout << "nearest query (k 5): " << std::setprecision(2) << Seconds(begin)/queries*1e6 << " us" << std::endl;
+    return 0;
+}
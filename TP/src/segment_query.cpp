@@ -0,0 +1,70 @@
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <stdexcept>
+#include "segment_index.hpp"
+
+// Ferramenta de consulta: responde consultas espaciais sobre o índice de trechos gravado com -S, sem reexecutar a simulação
+// Uso: segment_query.out <índice> box <x0> <y0> <x1> <y1> [<t0> <t1>]
+//      segment_query.out <índice> near <x> <y> <raio> [<t0> <t1>]
+//      segment_query.out <índice> nearest <x> <y> <k> [<t0> <t1>]
+// Cada trecho encontrado é impresso como "corrida segmento x0 y0 x1 y1 t0 t1"
+
+static void Usage(const char* program) {
+    std::cerr << "Usage: " << program << " <segment_index> box x0 y0 x1 y1 [t0 t1]" << std::endl
+              << "       " << program << " <segment_index> near x y radius [t0 t1]" << std::endl
+              << "       " << program << " <segment_index> nearest x y k [t0 t1]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 3) {
+        Usage(argv[0]);
+        return 1;
+    }
+    const char* query = argv[2];
+    int arguments = strcmp(query, "box") == 0 ? 4 : 3;
+    if((strcmp(query, "box") != 0 && strcmp(query, "near") != 0 && strcmp(query, "nearest") != 0)
+        || (argc != 3 + arguments && argc != 5 + arguments)) {
+        Usage(argv[0]);
+        return 1;
+    }
+    double values[4];
+    for(int i = 0; i < arguments; i++) {
+        values[i] = atof(argv[3 + i]);
+    }
+    double t0 = -INFINITY, t1 = INFINITY;
+    if(argc == 5 + arguments) {
+        t0 = atof(argv[3 + arguments]);
+        t1 = atof(argv[4 + arguments]);
+    }
+
+    try {
+        SegmentIndex index;
+        index.Load(argv[1]);
+
+        std::vector<int> hits;
+        if(strcmp(query, "box") == 0) {
+            index.QueryBox(values[0], values[1], values[2], values[3], t0, t1, hits);
+        }
+        else if(strcmp(query, "near") == 0) {
+            index.QueryNear(values[0], values[1], values[2], t0, t1, hits);
+        }
+        else {
+            index.Nearest(values[0], values[1], (int)values[2], t0, t1, hits);
+        }
+
+        std::cout << std::fixed << std::setprecision(2);
+        for(size_t i = 0; i < hits.size(); i++) {
+            const SegmentEntry& e = index.GetEntry(hits[i]);
+            std::cout << e.ride << " " << e.segment << " " << e.x0 << " " << e.y0 << " " << e.x1 << " " << e.y1
+                      << " " << e.t0 << " " << e.t1 << "\n";
+        }
+    }
+    catch(std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
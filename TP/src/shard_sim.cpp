@@ -0,0 +1,284 @@
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "simulation_manager.hpp"
+#include "shm_ring.hpp"
+
+// Simulação particionada em processos: o lançador lê a entrada (mesmo formato de tp2.out) e reparte as demandas entre
+// n processos de trabalho, cada um com o próprio Manager, por buffers circulares em memória compartilhada. Cada
+// trabalhador devolve as corridas já formatadas em ordem de RIDEEND, e o lançador intercala as n saídas na ordem global
+// de (fim, partição), então a saída é determinística para os mesmos n, critério e largura.
+// Partições (demandas de partições diferentes nunca são agrupadas):
+//   - time:  janelas de tempo de solicitação de w unidades, distribuídas em rodízio entre os processos;
+//   - space: faixas de w unidades na coordenada x da origem, distribuídas em rodízio entre os processos.
+// Com -r, a entrada é lida para a memória e executada com 1 a n processos; a saída impressa é a de n processos e o
+// relatório "processos segundos aceleração corridas" de cada execução é gravado no arquivo.
+// Se um trabalhador termina sem fechar a saída (morto por um sinal, por exemplo), o lançador detecta na espera, encerra
+// os demais e a execução falha; se o lançador morre, os trabalhadores recebem SIGKILL.
+// Uso: shard_sim.out -n <processos> [-k time|space] [-w largura] [-r relatório] < entrada > saída
+
+static const size_t RING_BYTES = 1 << 20;  // Capacidade de cada buffer circular (entrada e saída de cada trabalhador)
+
+// Parâmetros de simulação da primeira linha da entrada
+struct Parameters {
+    int eta;
+    double gamma;
+    double delta;
+    double alpha;
+    double beta;
+    float lambda;
+};
+
+// Cabeçalho de cada corrida no buffer de saída de um trabalhador, seguido da linha já formatada
+struct RideHeader {
+    double end;
+    uint32_t length;
+};
+
+// ShardOf: janela ou faixa da demanda, em rodízio entre os processos
+static int ShardOf(const Demand& demand, int processes, bool by_space, double width) {
+    double key = by_space ? demand.GetOrigin().GetX() : demand.GetTime();
+    long cell = (long)std::floor(key / width);
+    int shard = (int)(cell % processes);
+    return shard < 0 ? shard + processes : shard;
+}
+
+// RunWorker (processo filho): simula as demandas recebidas e devolve as corridas em ordem de conclusão.
+// Em caso de erro, fecha a saída e esvazia a entrada, para o lançador não ficar bloqueado
+static int RunWorker(const Parameters& params, ShmRing& in, ShmRing& out) {
+    int status = 0;
+    try {
+        // Total de demandas desconhecido (0): o último grupo é fechado ao iniciar a simulação
+        Manager manager(params.eta, params.gamma, params.delta, params.alpha, params.beta, params.lambda, 0);
+        Demand demand;
+        while(in.Read(&demand, sizeof(Demand))) {
+            manager.MakeDemand(demand.GetID(), demand.GetTime(), demand.GetOrigin().GetX(), demand.GetOrigin().GetY(),
+                               demand.GetDestination().GetX(), demand.GetDestination().GetY());
+        }
+
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(2);
+        int index_ride;
+        while((index_ride = manager.NextFinishedRide()) >= 0) {
+            Ride* ride = manager.GetRide(index_ride);
+            line.str("");
+            line << ride->GetEnd()
+                 << " "
+                 << ride->GetDistance()
+                 << " "
+                 << ride->GetStopAmount();
+            ride->PrintStops(line);
+            line << "\n";
+
+            std::string text = line.str();
+            RideHeader header = {ride->GetEnd(), (uint32_t)text.size()};
+            out.Write(&header, sizeof(RideHeader));
+            out.Write(text.data(), text.size());
+        }
+    }
+    catch(const std::exception& e) {
+        std::cerr << "Worker " << getpid() << ": " << e.what() << std::endl;
+        status = 1;
+    }
+    out.Close();
+    Demand discarded;
+    while(in.Read(&discarded, sizeof(Demand))) {
+    }
+    return status;
+}
+
+// Exchange: distribui as demandas entre os processes trabalhadores e imprime as corridas intercaladas em out; retorna as
+// corridas impressas. Lança runtime_error se um trabalhador terminar sem fechar a saída ou devolver uma corrida cortada
+static long Exchange(int amount, const std::vector<Demand>* demands, int processes, bool by_space, double width,
+                     std::vector<ShmRing*>& inputs, std::vector<ShmRing*>& outputs, std::ostream& out) {
+    // Distribuição das demandas, na ordem da entrada
+    for(int i = 0; i < amount && processes > 0; i++) {
+        Demand demand;
+        if(demands != nullptr) {
+            demand = (*demands)[i];
+        }
+        else {
+            int id;
+            double time;
+            double ox, oy, dx, dy;
+            std::cin >> id >> time >> ox >> oy >> dx >> dy;
+            demand = Demand(id, time, ox, oy, dx, dy);
+        }
+        inputs[ShardOf(demand, processes, by_space, width)]->Write(&demand, sizeof(Demand));
+    }
+    for(int i = 0; i < processes; i++) {
+        inputs[i]->Close();
+    }
+
+    // Intercalação: min-heap de (fim, partição) sobre a próxima corrida de cada trabalhador
+    typedef std::pair<double, int> Head;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head> > heads;
+    std::vector<std::string> lines(processes);
+    auto advance = [&](int shard) {
+        RideHeader header;
+        if(outputs[shard]->Read(&header, sizeof(RideHeader))) {
+            lines[shard].resize(header.length);
+            if(!outputs[shard]->Read(&lines[shard][0], header.length)) {
+                throw std::runtime_error("Worker " + std::to_string(shard) + " closed its output inside a ride.");
+            }
+            heads.push(Head(header.end, shard));
+        }
+    };
+    for(int i = 0; i < processes; i++) {
+        advance(i);
+    }
+    long rides = 0;
+    while(!heads.empty()) {
+        int shard = heads.top().second;
+        heads.pop();
+        out << lines[shard];
+        rides++;
+        advance(shard);
+    }
+    out.flush();
+    return rides;
+}
+
+// RunShards: executa a simulação com processes trabalhadores e imprime as corridas intercaladas em out.
+// As demandas vêm de demands, se não for nulo, ou da entrada padrão. Retorna as corridas impressas (-1 em caso de erro)
+static long RunShards(const Parameters& params, int amount, const std::vector<Demand>* demands,
+                      int processes, bool by_space, double width, std::ostream& out) {
+    std::vector<ShmRing*> inputs, outputs;
+    for(int i = 0; i < processes; i++) {
+        inputs.push_back(new ShmRing(RING_BYTES));
+        outputs.push_back(new ShmRing(RING_BYTES));
+    }
+
+    // Trabalhadores: a saída pendente é descarregada antes, para não ser repetida pelos filhos
+    out.flush();
+    std::cout.flush();
+    std::vector<pid_t> workers;
+    pid_t launcher = getpid();
+    for(int i = 0; i < processes; i++) {
+        pid_t pid = fork();
+        if(pid < 0) {
+            std::cerr << "Can't start worker " << i << "." << std::endl;
+            processes = i;
+            break;
+        }
+        if(pid == 0) {
+            // O lançador pode ter morrido antes de prctl valer
+            if(prctl(PR_SET_PDEATHSIG, SIGKILL) != 0 || getppid() != launcher) {
+                _exit(1);
+            }
+            _exit(RunWorker(params, *inputs[i], *outputs[i]));
+        }
+        inputs[i]->Watch(pid);
+        outputs[i]->Watch(pid);
+        workers.push_back(pid);
+    }
+
+    bool failed = processes < (int)inputs.size();
+    long rides = 0;
+    try {
+        rides = Exchange(amount, demands, processes, by_space, width, inputs, outputs, out);
+    }
+    catch(const std::exception& e) {
+        // Os demais trabalhadores podem estar bloqueados escrevendo para um lançador que não lê mais
+        std::cerr << e.what() << std::endl;
+        for(size_t i = 0; i < workers.size(); i++) {
+            kill(workers[i], SIGKILL);
+        }
+        failed = true;
+    }
+
+    for(size_t i = 0; i < workers.size(); i++) {
+        int status;
+        if(waitpid(workers[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed = true;
+        }
+    }
+    for(size_t i = 0; i < inputs.size(); i++) {
+        delete inputs[i];
+        delete outputs[i];
+    }
+    return failed ? -1 : rides;
+}
+
+int main(int argc, char* argv[]) {
+    int processes = 1;
+    bool by_space = false;
+    double width = 100;
+    const char* report_path = nullptr;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            processes = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-k") == 0 && i + 1 < argc && (strcmp(argv[i + 1], "time") == 0 || strcmp(argv[i + 1], "space") == 0)) {
+            by_space = strcmp(argv[++i], "space") == 0;
+        }
+        else if(strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            width = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            report_path = argv[++i];
+        }
+        else {
+            processes = 0;
+            break;
+        }
+    }
+    if(processes < 1 || !(width > 0)) {
+        std::cerr << "Usage: " << argv[0] << " -n processes [-k time|space] [-w width] [-r report_file]" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    Parameters params;
+    int demand_amount;
+    std::cin >> params.eta >> params.gamma >> params.delta >> params.alpha >> params.beta >> params.lambda >> demand_amount;
+
+    if(report_path == nullptr) {
+        return RunShards(params, demand_amount, nullptr, processes, by_space, width, std::cout) < 0 ? 1 : 0;
+    }
+
+    // Relatório de escala: a mesma entrada (já em memória) com 1 a n processos; só a última execução é impressa
+    std::ofstream report(report_path);
+    if(!report) {
+        std::cerr << "Can't open report file: " << report_path << std::endl;
+        return 1;
+    }
+    std::vector<Demand> demands(demand_amount);
+    for(int i = 0; i < demand_amount; i++) {
+        int id;
+        double time;
+        double ox, oy, dx, dy;
+        std::cin >> id >> time >> ox >> oy >> dx >> dy;
+        demands[i] = Demand(id, time, ox, oy, dx, dy);
+    }
+
+    std::ostringstream discarded;
+    report << "processes seconds speedup rides" << std::endl;
+    report << std::fixed;
+    double base = 0;
+    for(int p = 1; p <= processes; p++) {
+        discarded.str("");
+        auto start = std::chrono::steady_clock::now();
+        long rides = RunShards(params, demand_amount, &demands, p, by_space, width, p == processes ? std::cout : discarded);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if(rides < 0) {
+            return 1;
+        }
+        if(p == 1) {
+            base = seconds;
+        }
+        report << p << " " << std::setprecision(3) << seconds << " " << std::setprecision(2) << base/seconds
+               << " " << rides << std::endl;
+    }
+    return 0;
+}
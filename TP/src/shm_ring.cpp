@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "shm_ring.hpp"
+
+// Os contadores são usados por processos diferentes: só funciona se as operações não dependerem de travas internas
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "ShmRing needs lock-free atomics.");
+
+static const int SPIN_LIMIT = 256;     // Voltas de espera ativa antes de ceder o processador
+
+//-------------------------------------------------------------------------------
+// CONSTRUTOR E DESTRUTOR
+//-------------------------------------------------------------------------------
+
+// Construtor: cria o segmento com nome único, mapeia e remove o nome
+ShmRing::ShmRing(size_t capacity) {
+    static std::atomic<int> serials(0);
+    this->capacity = 1;
+    this->peer = 0;
+    while(this->capacity < capacity) {
+        this->capacity <<= 1;
+    }
+    this->mapped = sizeof(Header) + this->capacity;
+
+    std::string name = "/dispatch_ring_" + std::to_string(getpid()) + "_" + std::to_string(serials.fetch_add(1));
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if(fd < 0) {
+        throw std::runtime_error("ShmRing: can't create shared memory " + name);
+    }
+    shm_unlink(name.c_str());
+    if(ftruncate(fd, this->mapped) != 0) {
+        close(fd);
+        throw std::runtime_error("ShmRing: can't resize shared memory " + name);
+    }
+    void* memory = mmap(nullptr, this->mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(memory == MAP_FAILED) {
+        throw std::runtime_error("ShmRing: can't map shared memory " + name);
+    }
+
+    this->header = new(memory) Header();
+    this->header->head.store(0);
+    this->header->tail.store(0);
+    this->header->closed.store(0);
+    this->data = static_cast<unsigned char*>(memory) + sizeof(Header);
+}
+
+ShmRing::~ShmRing() {
+    munmap(this->header, this->mapped);
+}
+
+//-------------------------------------------------------------------------------
+// OPERAÇÕES
+//-------------------------------------------------------------------------------
+
+void ShmRing::Watch(pid_t peer) {
+    this->peer = peer;
+}
+
+// Wait: espera ativa curta; depois disso, cede o processador a cada volta e confere o filho observado. Retorna true se
+// ele terminou: quem espera ainda confere o buffer mais uma vez, pois o filho pode ter escrito e fechado logo antes de
+// sair. WNOWAIT deixa o filho sem recolher, para quem o criou ainda obter o estado de saída com waitpid
+bool ShmRing::Wait(int& spins) {
+    if(spins < SPIN_LIMIT) {
+        spins++;
+        return false;
+    }
+    sched_yield();
+    if(this->peer > 0) {
+        siginfo_t info;
+        info.si_pid = 0;
+        return waitid(P_PID, this->peer, &info, WEXITED | WNOHANG | WNOWAIT) == 0 && info.si_pid != 0;
+    }
+    return false;
+}
+
+// PeerEnded: erro de quem esperava pelo filho observado
+static std::runtime_error PeerEnded(pid_t peer) {
+    return std::runtime_error("ShmRing: process " + std::to_string(peer) + " ended without closing the ring");
+}
+
+// Write: copia o que couber no espaço livre (em até dois trechos, por causa da volta) e só então publica a nova posição
+void ShmRing::Write(const void* bytes, size_t size) {
+    const unsigned char* source = static_cast<const unsigned char*>(bytes);
+    uint64_t tail = this->header->tail.load(std::memory_order_relaxed);
+    int spins = 0;
+    bool ended = false;
+    while(size > 0) {
+        uint64_t space = this->capacity - (tail - this->header->head.load(std::memory_order_acquire));
+        if(space == 0) {
+            if(ended) {
+                throw PeerEnded(this->peer);
+            }
+            ended = Wait(spins);
+            continue;
+        }
+        spins = 0;
+
+        uint64_t amount = std::min<uint64_t>(space, size);
+        uint64_t offset = tail & (this->capacity - 1);
+        uint64_t first = std::min(amount, this->capacity - offset);
+        memcpy(this->data + offset, source, first);
+        memcpy(this->data, source + first, amount - first);
+
+        tail += amount;
+        source += amount;
+        size -= amount;
+        this->header->tail.store(tail, std::memory_order_release);
+    }
+}
+
+void ShmRing::Close() {
+    this->header->closed.store(1, std::memory_order_release);
+}
+
+// Read: consome à medida que os bytes são publicados; o fechamento só encerra a leitura quando não resta nada escrito
+bool ShmRing::Read(void* bytes, size_t size) {
+    unsigned char* target = static_cast<unsigned char*>(bytes);
+    uint64_t head = this->header->head.load(std::memory_order_relaxed);
+    int spins = 0;
+    bool ended = false;
+    while(size > 0) {
+        uint64_t available = this->header->tail.load(std::memory_order_acquire) - head;
+        if(available == 0) {
+            if(this->header->closed.load(std::memory_order_acquire) &&
+               this->header->tail.load(std::memory_order_acquire) == head) {
+                return false;
+            }
+            if(ended) {
+                throw PeerEnded(this->peer);
+            }
+            ended = Wait(spins);
+            continue;
+        }
+        spins = 0;
+
+        uint64_t amount = std::min<uint64_t>(available, size);
+        uint64_t offset = head & (this->capacity - 1);
+        uint64_t first = std::min(amount, this->capacity - offset);
+        memcpy(target, this->data + offset, first);
+        memcpy(target + first, this->data, amount - first);
+
+        head += amount;
+        target += amount;
+        size -= amount;
+        this->header->head.store(head, std::memory_order_release);
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#include <cstring>
+#include <thread>
+#include "sim_snapshot.hpp"
+
+static_assert(sizeof(SimSnapshot) % 8 == 0, "SimSnapshot must be made of whole 64-bit words.");
+
+SnapshotBoard::SnapshotBoard() : sequence(0) {
+    for(int i = 0; i < WORDS; i++) {
+        this->words[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+// Publish: a barreira de release depois da sequência ímpar impede que as palavras novas sejam vistas antes dela
+void SnapshotBoard::Publish(const SimSnapshot& snapshot) {
+    uint64_t copy[WORDS];
+    memcpy(copy, &snapshot, sizeof(SimSnapshot));
+
+    uint64_t sequence = this->sequence.load(std::memory_order_relaxed);
+    this->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for(int i = 0; i < WORDS; i++) {
+        this->words[i].store(copy[i], std::memory_order_relaxed);
+    }
+    this->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// Read: a barreira de acquire antes da segunda leitura da sequência garante que, se ela não mudou, a cópia é de uma única publicação
+bool SnapshotBoard::Read(SimSnapshot& snapshot) {
+    uint64_t copy[WORDS];
+    while(1) {
+        uint64_t before = this->sequence.load(std::memory_order_acquire);
+        if(before == 0) {
+            return false;
+        }
+        if(before & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        for(int i = 0; i < WORDS; i++) {
+            copy[i] = this->words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(this->sequence.load(std::memory_order_relaxed) == before) {
+            memcpy(&snapshot, copy, sizeof(SimSnapshot));
+            return true;
+        }
+    }
+}
@@ -1,4 +1,9 @@
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <sstream>
 #include "simulation_manager.hpp"
+#include "fixed_capacity.hpp"
 #include "eff_error.hpp"
 
 //-------------------------------------------------------------------------------
@@ -12,15 +17,40 @@ void Manager::UpdateMemory() {
     }
 }
 
-// CreateDemandGroup: cria um novo grupo de demandas, insere-a no vetor de grupos e retorna o ponteiro para o novo grupo
-DemandGroup* Manager::CreateDemandGroup() {
-    if(this->group_count == MAX_GROUPS) {
-        // Número máximo de grupos atingido
-        throw std::out_of_range("Max demand groups reached. Can't create a new group.");
+// GrowSlots: dobra a capacidade dos vetores de grupos e de corridas até comportar needed posições
+void Manager::GrowSlots(int needed) {
+    if(needed <= this->slot_capacity) {
+        return;
     }
 
+    int new_capacity = this->slot_capacity;
+    while(new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    DemandGroup** new_groups = new DemandGroup*[new_capacity];
+    Ride** new_rides = new Ride*[new_capacity];
+    for(int i = 0; i < new_capacity; i++) {
+        new_groups[i] = (i < this->slot_capacity) ? this->demand_groups[i] : nullptr;
+        new_rides[i] = (i < this->slot_capacity) ? this->rides[i] : nullptr;
+    }
+    delete[] this->demand_groups;
+    delete[] this->rides;
+    this->demand_groups = new_groups;
+    this->rides = new_rides;
+
+    // Update de memória: as posições além da capacidade inicial contam como memória extra
+    this->extra_mem_usage += (sizeof(DemandGroup*) + sizeof(Ride*))*(new_capacity - this->slot_capacity);
+    UpdateMemory();
+    this->slot_capacity = new_capacity;
+}
+
+// CreateDemandGroup: cria um novo grupo de demandas da classe, insere-o no vetor de grupos e retorna o ponteiro para o novo grupo (que passa a ser o aberto da classe)
+DemandGroup* Manager::CreateDemandGroup(int service_class) {
+    GrowSlots(this->group_count + 1);
+
     // Criação do grupo
-    this->demand_groups[group_count] = new DemandGroup(this->veh_capacity);
+    this->demand_groups[group_count] = NewDemandGroup(this->classes[service_class].capacity);
+    this->classes[service_class].open_group = group_count;
     this->group_count++;
 
     // Update de memória
@@ -30,24 +60,28 @@ DemandGroup* Manager::CreateDemandGroup() {
     return demand_groups[this->group_count - 1];
 }
 
-// MakeRide: cria uma nova corrida baseada no grupo passado como parâmetro e a insere no vetor de corridas
-bool Manager::MakeRide(DemandGroup* group) {
-    if(ride_count == MAX_GROUPS) {
-        // Número máximo de corridas atingido
-        throw std::out_of_range("Can't create a new ride: max number of rides reached.");
-    }
+// MakeRide: cria uma nova corrida baseada no grupo passado como parâmetro (da classe passada) e a insere no vetor de corridas
+bool Manager::MakeRide(DemandGroup* group, int service_class) {
+    TraceSpan span("MakeRide", SpanKind::SAMPLED);
+    GrowSlots(this->ride_count + 1);
 
     try {
         // Criação da corrida
-        this->rides[ride_count] = new Ride(*group, this->min_efficiency);
+        this->rides[ride_count] = NewRide(*group, this->classes[service_class].lambda);
+        if((int)this->ride_classes.size() <= ride_count) {
+            this->ride_classes.resize(ride_count + 1);
+        }
+        this->ride_classes[ride_count] = service_class;
         this->rides[ride_count]->CalculateDuration(this->veh_speed);
         double ride_start = this->rides[ride_count]->GetStart();
         double ride_end = ride_start + this->rides[ride_count]->GetDuration();
 
-        // Agendamento dos eventos
-        this->scaler.ScheduleEvent(ride_count, ride_start, EventType::RIDESTART);
-        this->scaler.ScheduleEvent(ride_count, ride_end, EventType::RIDEEND);
+        // Os eventos são agendados em lote no início da simulação (ver ScheduleRides)
+        LogRide(group, true, ride_start, ride_end);
+        RecordRide(ride_count);
         ride_count++;
+        this->ride_index_ready = false;
+        span.SetArg("ride", ride_count - 1);
 
         // Update de memória
         this->extra_mem_usage += rides[ride_count-1]->GetMemoryUsage();
@@ -56,25 +90,238 @@ bool Manager::MakeRide(DemandGroup* group) {
         return true;
     }
     catch(const low_efficiency& e) {
+        span.SetArg("ride", -1);
+        LogRide(group, false, group->Get(0)->GetTime(), group->Get(0)->GetTime());
+        RecordRide(-1);
         return false;
     }
 }
 
-// CheckEfficiency: confere se a criação de uma corrida com o grupo passado como parâmetro satisfaria o critério de eficiência mínima. Retorna true se sim, false caso não
-bool Manager::CheckEfficiency(DemandGroup& group) {
-    try {
-        Ride* aux_ride = new Ride(group, this->min_efficiency);
+// LogRide: registra no trace (se ativo) a definição de uma corrida a partir do grupo mais recente
+void Manager::LogRide(DemandGroup* group, bool created, double start, double end) {
+    if(this->trace == nullptr) {
+        return;
+    }
 
-        // Update de memória máxima auxiliar usada
-        this->extra_mem_usage += aux_ride->GetMemoryUsage();
+    int* ids = new int[group->Size()];
+    for(int i = 0; i < group->Size(); i++) {
+        ids[i] = group->Get(i)->GetID();
+    }
+    this->trace->LogRide(this->ride_count, this->group_count - 1, created, start, end, ids, group->Size());
+    delete[] ids;
+}
+
+// VisitStop: avança a corrida para a próxima parada; em cada entrega, imprime o passageiro com seus tempos de coleta e entrega
+void Manager::VisitStop(int index_ride) {
+    Ride* ride = this->rides[index_ride];
+    int index = ride->VisitNextStop(this->veh_speed);
+    int demands = ride->GetStopAmount()/2;
+    if(index >= demands) {
+        // A coleta da mesma demanda está na mesma posição da primeira metade das paradas
+        Stop& stop = ride->GetStop(index);
+        Stop& pickup = ride->GetStop(index - demands);
+        *this->stop_out << stop.GetDemandID()
+                        << " "
+                        << stop.GetRequestTime()
+                        << " "
+                        << pickup.GetVisitTime()
+                        << " "
+                        << stop.GetVisitTime()
+                        << "\n";
+    }
+}
+
+// ApplyCancel (durante simulação): a demanda sai da corrida se ela ainda não começou - o fim é reagendado para a nova
+// duração; se era a única demanda, os dois eventos da corrida são desagendados
+void Manager::ApplyCancel(int change) {
+    int demand_id = this->changes[change].target;
+    if(this->demand_rides.empty()) {
+        for(int i = 0; i < this->ride_count; i++) {
+            for(int p = 0; p < this->rides[i]->GetStopAmount()/2; p++) {
+                this->demand_rides[this->rides[i]->GetStop(p).GetDemandID()] = i;
+            }
+        }
+    }
+
+    std::unordered_map<int, int>::iterator found = this->demand_rides.find(demand_id);
+    if(found == this->demand_rides.end()) {
+        return;
+    }
+    int index_ride = found->second;
+    Ride* ride = this->rides[index_ride];
+    if(ride->HasStarted() || ride->IsCancelled()) {
+        this->late_changes++;
+        return;
+    }
+    this->demand_rides.erase(found);
+
+    if(ride->GetStopAmount() == 2) {
+        ride->Cancel();
+        this->cancelled_rides++;
+        this->scaler.Cancel(this->start_handles[index_ride]);
+        this->scaler.Cancel(this->end_handles[index_ride]);
+    }
+    else {
+        ride->DropDemand(demand_id);
+        ride->CalculateDuration(this->veh_speed);
+        this->scaler.Reschedule(this->end_handles[index_ride], ride->GetEnd());
+    }
+    this->ride_index_ready = false;
+}
+
+// ApplyDelay (durante simulação): desloca o fim (e o início ou as próximas paradas, conforme o andamento) da corrida
+void Manager::ApplyDelay(int change) {
+    int index_ride = this->changes[change].target;
+    double delay = this->changes[change].delay;
+    if(index_ride < 0 || index_ride >= this->ride_count || this->rides[index_ride]->IsCancelled()) {
+        this->late_changes++;
+        return;
+    }
+
+    // RIDEEND já recuperado: a corrida terminou e não muda mais
+    Ride* ride = this->rides[index_ride];
+    if(!this->scaler.Reschedule(this->end_handles[index_ride], ride->GetEnd() + delay)) {
+        this->late_changes++;
+        return;
+    }
+    bool started = ride->HasStarted();
+    ride->Postpone(delay, this->global_time, this->veh_speed);
+    if(!started) {
+        this->scaler.Reschedule(this->start_handles[index_ride], ride->GetStart());
+    }
+    else if(this->stop_out != nullptr) {
+        // Só a próxima parada fica agendada (se já foi recuperada, a nova é agendada com o atraso)
+        this->scaler.Reschedule(this->stop_handles[index_ride], ride->NextStopTime(this->veh_speed));
+    }
+    this->ride_index_ready = false;
+}
+
+// FlushBatch: resolve a janela atual; cada grupo encontrado vira um grupo de demandas e uma corrida, em ordem de tempo
+void Manager::FlushBatch() {
+    std::vector<std::vector<int> > groups;
+    this->batch->Solve(groups);
+
+    for(size_t g = 0; g < groups.size(); g++) {
+        // O grupo inicial criado no construtor é aproveitado enquanto estiver vazio
+        DemandGroup* group = this->demand_groups[this->group_count - 1];
+        if(group->Size() != 0) {
+            group = CreateDemandGroup();
+        }
+
+        for(size_t k = 0; k < groups[g].size(); k++) {
+            Demand& demand = this->batch->GetPending(groups[g][k]);
+            group->Insert(demand);
+            this->extra_mem_usage += Demand::GetMemoryUsage();
+            if(this->trace != nullptr) {
+                this->trace->LogDecision(TraceRecordType::INSERTED, demand.GetID(), this->group_count - 1, demand.GetTime());
+            }
+        }
         UpdateMemory();
-        this->extra_mem_usage -= aux_ride->GetMemoryUsage();
+        MakeRide(group);
+    }
 
-        delete aux_ride;
-        return true;
+    this->batch->Clear();
+}
+
+// CloseDemands: conclui o grupo ainda aberto quando o total de demandas não foi informado (0) ou não foi atingido
+void Manager::CloseDemands() {
+    if(this->demand_count == 0 || this->demand_count == this->demand_amount) {
+        return;
     }
-    catch(const low_efficiency& e) {
-        return false;
+    if(this->batch != nullptr) {
+        FlushBatch();
+    }
+    else {
+        CloseOpenGroups();
+    }
+
+    // A partir daqui o total de demandas é conhecido
+    this->demand_amount = this->demand_count;
+}
+
+// OpenGroup: grupo aberto da classe. Com uma só classe é sempre o mais recente, como a re-simulação e o modo em lote supõem
+int Manager::OpenGroup(int service_class) {
+    if(this->classes.size() == 1) {
+        return this->group_count - 1;
+    }
+    return this->classes[service_class].open_group;
+}
+
+// CloseOpenGroups: cria as corridas dos grupos ainda abertos (um por classe, em ordem de classe)
+void Manager::CloseOpenGroups() {
+    for(int c = 0; c < (int)this->classes.size(); c++) {
+        int group = OpenGroup(c);
+        if(group >= 0 && this->demand_groups[group]->Size() > 0) {
+            MakeRide(this->demand_groups[group], c);
+        }
+        this->classes[c].open_group = -1;
+    }
+}
+
+// ScheduleRides: agenda o início e o fim de todas as corridas em dois lotes por classe. Os inícios já saem em ordem (os grupos são
+// fechados em ordem de tempo dentro de cada classe) e formam uma única sequência ordenada na fila da classe; os fins são quase ordenados
+void Manager::ScheduleRides() {
+    if(this->ride_count == 0) {
+        return;
+    }
+
+    this->start_handles.assign(this->ride_count, -1);
+    this->end_handles.assign(this->ride_count, -1);
+    this->stop_handles.assign(this->ride_count, -1);
+
+    Event* batch = new Event[this->ride_count];
+    for(int c = 0; c < (int)this->classes.size(); c++) {
+        // Corridas canceladas ficam de fora; os identificadores de cada lote seguem a ordem do lote
+        std::vector<int> active;
+        active.reserve(this->ride_count);
+        for(int i = 0; i < this->ride_count; i++) {
+            if(!this->rides[i]->IsCancelled() && GetRideClass(i) == c) {
+                active.push_back(i);
+            }
+        }
+        int amount = active.size();
+        if(amount == 0) {
+            continue;
+        }
+
+        for(int k = 0; k < amount; k++) {
+            batch[k] = Event(active[k], this->rides[active[k]]->GetStart(), EventType::RIDESTART);
+        }
+        EventHandle first = this->scaler.ScheduleBatch(c, batch, amount);
+        for(int k = 0; k < amount; k++) {
+            this->start_handles[active[k]] = this->scaler.BatchHandle(first, k);
+        }
+
+        for(int k = 0; k < amount; k++) {
+            batch[k] = Event(active[k], this->rides[active[k]]->GetEnd(), EventType::RIDEEND);
+        }
+        first = this->scaler.ScheduleBatch(c, batch, amount);
+        for(int k = 0; k < amount; k++) {
+            this->end_handles[active[k]] = this->scaler.BatchHandle(first, k);
+        }
+    }
+    delete[] batch;
+}
+
+// CheckEfficiency: confere se a criação de uma corrida com o grupo passado como parâmetro satisfaria o critério de eficiência mínima. Retorna true se sim, false caso não
+// A eficiência é calculada pelo próprio grupo (mesma conta de Ride), sem construir uma corrida auxiliar
+bool Manager::CheckEfficiency(DemandGroup& group, float lambda) {
+    TraceSpan span("CheckEfficiency", SpanKind::SAMPLED);
+    double efficiency = group.Efficiency();
+    if(this->recording) {
+        this->checked[this->demand_count - 1] = 1;
+        this->checked_efficiency[this->demand_count - 1] = efficiency;
+    }
+    bool accepted = !(efficiency < lambda);
+    span.SetArg("accepted", accepted);
+    return accepted;
+}
+
+// RecordRide: associa o grupo mais recente à corrida criada com ele (-1 se a criação falhou), para a re-simulação
+void Manager::RecordRide(int index_ride) {
+    if(this->recording) {
+        this->group_rides.resize(this->group_count, -1);
+        this->group_rides[this->group_count - 1] = index_ride;
     }
 }
 
@@ -92,9 +339,12 @@ Manager::Manager(int eta, double gamma, double delta, double alpha, double beta,
     this->destin_max_distance = beta;
     this->min_efficiency = lambda;
     this->demand_amount = demands;
+    ServiceClass standard = {eta, delta, alpha, beta, lambda, INFINITY, -1, 0};
+    this->classes.push_back(standard);
 
     // Objetos de simulação e variáveis de controle
     this->global_time = 0;
+    this->slot_capacity = MAX_GROUPS;
     this->demand_groups = new DemandGroup*[MAX_GROUPS];
     this->group_count = 0;
     this->rides = new Ride*[MAX_GROUPS];
@@ -103,22 +353,43 @@ Manager::Manager(int eta, double gamma, double delta, double alpha, double beta,
         this->demand_groups[i] = nullptr;
         this->rides[i] = nullptr;
     }
-    CreateDemandGroup();
     this->demand_count = 0;
+    this->trace = nullptr;
+    this->stats = nullptr;
+    this->segment_index = nullptr;
+    this->batch = nullptr;
+    this->stop_out = nullptr;
+    this->scheduled = false;
+    this->event_threads = 1;
+    this->recording = false;
+    this->ride_index_ready = false;
+    this->late_changes = 0;
+    this->snapshots = nullptr;
+    this->snapshot_version = 0;
+    this->snapshot_period = 1;
+    this->snapshot_interval = 0;
+    this->snapshot_events = 0;
+    this->started_rides = 0;
+    this->finished_rides = 0;
+    this->cancelled_rides = 0;
 
     // Controle de memória
-    this->static_mem_usage = 4*sizeof(int) + 4*sizeof(double) + sizeof(float) + this->scaler.GetMemoryUsage() + sizeof(DemandGroup**)+ sizeof(Ride**) + sizeof(DemandGroup*)*MAX_GROUPS + sizeof(Ride*)*MAX_GROUPS;
+    this->static_mem_usage = 5*sizeof(int) + 4*sizeof(double) + sizeof(float) + this->scaler.GetMemoryUsage() + sizeof(DemandGroup**)+ sizeof(Ride**) + sizeof(DemandGroup*)*MAX_GROUPS + sizeof(Ride*)*MAX_GROUPS;
     this->extra_mem_usage = 0;
+    this->max_extra_mem_usage = 0;
+
+    CreateDemandGroup();
 }
 
 // DESTRUTOR: libera memória alocada para os grupos de demandas e corridas
 Manager::~Manager() {
-    for(int i = 0; i < MAX_GROUPS; i++) {
+    for(int i = 0; i < this->slot_capacity; i++) {
         delete this->demand_groups[i];
         delete this->rides[i];
     }
     delete[] this->demand_groups;
     delete[] this->rides;
+    delete this->batch;
 }
 
 //-------------------------------------------------------------------------------
@@ -126,49 +397,113 @@ Manager::~Manager() {
 //-------------------------------------------------------------------------------
 
 // MakeDemand (pré-simulação): Cria uma nova demanda com os parâmetros passados e a insere no grupo de demandas seguindo as restrições de compartilhamento. Retorna o grupo em que a demanda foi inserida ou -1 se não foi possível inserir em nenhum grupo.
-int Manager::MakeDemand(int id, double t, double ox, double oy, double dx, double dy) {
+int Manager::MakeDemand(int id, double t, double ox, double oy, double dx, double dy, int service_class) {
+    Demand demand(id, t, ox, oy, dx, dy, service_class);
+    return ProcessDemand(demand);
+}
+
+// MakeDemands (pré-simulação): processa um lote de demandas lidas diretamente de vetores por coluna (do chamador), sem
+// cópia intermediária, em ordem e até a primeira recusada. Retorna quantas foram aceitas (as aceitas continuam valendo)
+int Manager::MakeDemands(int amount, const int* ids, const double* times, const double* ox, const double* oy, const double* dx, const double* dy) {
+    for(int i = 0; i < amount; i++) {
+        Demand demand(ids[i], times[i], ox[i], oy[i], dx[i], dy[i]);
+        if(ProcessDemand(demand) < 0) {
+            return i;
+        }
+    }
+    return amount;
+}
+
+// ProcessDemand: aplica os critérios de compartilhamento à demanda (ver MakeDemand); os grupos guardam cópias, então a demanda pode ser temporária
+int Manager::ProcessDemand(Demand& demand) {
+    TraceSpan span("MakeDemand", SpanKind::SAMPLED);
     this->demand_count++;
+    int id = demand.GetID();
+    span.SetArg("demand", id);
+    double t = demand.GetTime();
+    int service_class = demand.GetClass();
+    if(service_class < 0 || service_class >= (int)this->classes.size()) {
+        this->demand_count--;
+        return -1;
+    }
+    ServiceClass& params = this->classes[service_class];
 
-    // Caso trivial: primeira demanda da simulação
-    if(this->group_count == 1 && this->demand_groups[0]->Size() == 0) {
-        Demand* first_demand = new Demand(id, t, ox, oy, dx, dy);
-        this->demand_groups[0]->Insert(*first_demand);
-        return 0;
+    // Modo em lote: a demanda espera na janela; quando ela não couber mais, a janela é resolvida por inteiro
+    if(this->batch != nullptr) {
+        if(!this->batch->Fits(demand)) {
+            FlushBatch();
+        }
+        this->batch->Add(demand);
+        if(this->demand_count == this->demand_amount) {
+            FlushBatch();
+        }
+        return this->group_count - 1;
+    }
+
+    // Registro para a re-simulação: a checagem de eficiência desta demanda é preenchida em CheckEfficiency
+    if(this->recording) {
+        this->checked.push_back(0);
+        this->checked_efficiency.push_back(0);
+    }
+
+    // Caso trivial: primeira demanda da simulação (ou da classe)
+    int open_group = OpenGroup(service_class);
+    if(open_group < 0 || this->demand_groups[open_group]->Size() == 0) {
+        if(open_group < 0) {
+            CreateDemandGroup(service_class);
+            open_group = this->group_count - 1;
+        }
+        this->demand_groups[open_group]->Insert(demand);
+        if(this->trace != nullptr) {
+            this->trace->LogDecision(TraceRecordType::INSERTED, id, open_group, t);
+        }
+        if(this->demand_count == this->demand_amount && this->classes.size() > 1) {
+            CloseOpenGroups();
+        }
+        return open_group;
     }
 
-    // Criação da demanda e recuperação da primeira demanda no grupo mais recente ainda não fechado
-    Demand* new_demand = new Demand(id, t, ox, oy, dx, dy);                     // nova demanda
-    DemandGroup* current_group = this->demand_groups[this->group_count - 1];    // grupo mais recente
+    // Criação da demanda e recuperação da primeira demanda no grupo aberto da classe
+    Demand* new_demand = &demand;                                               // nova demanda
+    DemandGroup* current_group = this->demand_groups[open_group];               // grupo aberto
     Demand* dem_in_place = current_group->Get(0);                               // demanda de comparação
     int time_diff = new_demand->GetTime() - dem_in_place->GetTime();            // diferença de tempo entre ambas
 
     // Update da memória
-    this->extra_mem_usage += new_demand->GetMemoryUsage();
+    this->extra_mem_usage += Demand::GetMemoryUsage();
     UpdateMemory();
 
     // Início da checagem de critérios de compatibilidade
     bool compatible = true;    // sairá do if como false se não for compatível com o grupo atual (por qualquer critério)
+    TraceRecordType decision = TraceRecordType::INSERTED;   // motivo da decisão (registrado no trace)
     
     // Checagem de tamanho do grupo atual
     if(current_group->IsFull()) {
         compatible = false;
+        decision = TraceRecordType::REJECT_CAPACITY;
     }
 
     // Checagem de tempo
-    if(compatible && abs(time_diff) > this->delta) {
+    if(compatible && abs(time_diff) > params.delta) {
         compatible = false;
+        decision = TraceRecordType::REJECT_TIME;
     }
 
     // Checagem de distância entre origens e destinos
     if(compatible) {
-        for(int i = 0; i < current_group->Size(); i++) {
-            double orig_dist = current_group->Get(i)->OriginDistance(*new_demand);
-            double dest_dist = current_group->Get(i)->DestinationDistance(*new_demand);
+        switch(current_group->CheckDistances(*new_demand, params.alpha, params.beta)) {
+            case DistanceCheck::ORIGIN_TOO_FAR:
+                compatible = false;
+                decision = TraceRecordType::REJECT_ALPHA;
+                break;
 
-            if(orig_dist > this->origin_max_distance || dest_dist > this->destin_max_distance) {
+            case DistanceCheck::DESTINATION_TOO_FAR:
                 compatible = false;
+                decision = TraceRecordType::REJECT_BETA;
+                break;
+
+            case DistanceCheck::COMPATIBLE:
                 break;
-            }
         }
     }
 
@@ -178,35 +513,312 @@ int Manager::MakeDemand(int id, double t, double ox, double oy, double dx, doubl
         current_group->Insert(*new_demand);
 
         // Se a adição da nova demanda fez o critério de eficiência ficar abaixo do mínimo, ela é removida do grupo atual, é dada como incompatível e é feita a definição da corrida com o grupo atual
-        if(!CheckEfficiency(*current_group)) {
+        if(!CheckEfficiency(*current_group, params.lambda)) {
             current_group->Remove();
             compatible = false;
+            decision = TraceRecordType::REJECT_LAMBDA;
         }
     }
 
+    if(this->trace != nullptr) {
+        this->trace->LogDecision(decision, id, open_group, t);
+    }
+
     // Caso a demanda seja incompatível com o grupo por qualquer critério, finaliza a definição da corrida do grupo atual e cria um novo grupo para inseri-la
     if(!compatible) {
         try {
-            MakeRide(current_group);
-            DemandGroup* new_group = CreateDemandGroup();
+            MakeRide(current_group, service_class);
+            DemandGroup* new_group = CreateDemandGroup(service_class);
             new_group->Insert(*new_demand);
+            if(this->trace != nullptr) {
+                this->trace->LogDecision(TraceRecordType::INSERTED, id, this->group_count - 1, t);
+            }
         }
         catch(const std::out_of_range& e) {
             return -1;
         }
     }
 
-    // Se esta é a úlima demanda, concluir a definição da corrida de seu grupo (não haverão outras inseridas)
+    // Se esta é a úlima demanda, concluir a definição das corridas dos grupos abertos (não haverão outras inseridas)
+    int result = compatible ? open_group : this->group_count - 1;
     if(this->demand_count == this->demand_amount) {
-        DemandGroup* last_group = this->demand_groups[this->group_count - 1];
-        MakeRide(last_group);
+        CloseOpenGroups();
     }
 
-    return this->group_count - 1;
+    return result;
 }
 
 // StartSimulation (durante simulação): começa a executar a simulação, recupera todos os eventos agendados e conclui as corridas. Imprime as informações de cada corrida à medida que são concluídas
 void Manager::StartSimulation(std::ostream& out) {
+    TraceSpan span("StartSimulation");
+    // Com o registro de paradas, cada evento pode agendar outro no meio da rodada: somente o laço serial preserva a ordem
+    // O mesmo vale para cancelamentos e atrasos, que mexem em outras corridas e no escalonador
+    if(this->event_threads > 1 && this->stop_out == nullptr && this->changes.empty()) {
+        StartParallelSimulation(out);
+        return;
+    }
+
+    int index_ride;
+    while((index_ride = NextFinishedRide()) >= 0) {
+        Ride* ride = this->rides[index_ride];
+
+        // Imprimindo status da corrida
+        out << ride->GetEnd()
+            << " "
+            << ride->GetDistance()
+            << " "
+            << ride->GetStopAmount();
+        ride->PrintStops(out);
+        out << std::endl;
+    }
+}
+
+// StartSimulation (durante simulação): mesma simulação, com as corridas gravadas em binário à medida que são concluídas
+void Manager::StartSimulation(RideWriter& writer) {
+    TraceSpan span("StartSimulation");
+    int index_ride;
+    while((index_ride = NextFinishedRide()) >= 0) {
+        writer.Write(index_ride, *this->rides[index_ride]);
+    }
+}
+
+// StartParallelSimulation (durante simulação): retira os eventos em rodadas de até EVENT_CHUNK, na ordem do escalonador.
+// Cada evento só toca a própria corrida, então as threads dividem a rodada por corrida (a mesma thread vê o início e o fim
+// de uma corrida na ordem certa) e já formatam a linha de cada RIDEEND. Em seguida as linhas, as estatísticas e a memória
+// são consolidadas na ordem dos eventos, e a saída é a mesma do laço serial. As threads de trabalho são criadas uma vez por
+// simulação e esperam cada rodada em uma variável de condição
+void Manager::StartParallelSimulation(std::ostream& out) {
+    if(!this->scheduled) {
+        CloseDemands();
+        ScheduleRides();
+        this->scheduled = true;
+    }
+
+    int threads = this->event_threads;
+    std::vector<Event> chunk;
+    std::vector<std::string> lines(EVENT_CHUNK);
+    chunk.reserve(EVENT_CHUNK);
+
+    auto worker = [&](int part) {
+        TraceSpan span("SimulateChunk");
+        std::ostringstream line;
+        line.flags(out.flags());
+        line.precision(out.precision());
+        for(size_t i = 0; i < chunk.size(); i++) {
+            int index_ride = chunk[i].GetID();
+            if(index_ride % threads != part) {
+                continue;
+            }
+
+            Ride* ride = this->rides[index_ride];
+            if(chunk[i].GetType() == EventType::RIDESTART) {
+                ride->Start();
+            }
+            else if(chunk[i].GetType() == EventType::RIDEEND) {
+                ride->MarkDone();
+                line.str("");
+                line << ride->GetEnd()
+                     << " "
+                     << ride->GetDistance()
+                     << " "
+                     << ride->GetStopAmount();
+                ride->PrintStops(line);
+                line << "\n";
+                lines[i] = line.str();
+            }
+        }
+    };
+
+    // Pool: a thread da simulação faz a parte 0 de cada rodada; as demais partes ficam com threads fixas que acordam
+    // quando round muda e avisam em finished quando pending chega a zero
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    int round = 0;
+    int pending = 0;
+    bool done = false;
+    auto pool_worker = [&](int part) {
+        int seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while(1) {
+            wake.wait(lock, [&]() { return done || round != seen; });
+            if(done) {
+                return;
+            }
+            seen = round;
+            lock.unlock();
+            worker(part);
+            lock.lock();
+            if(--pending == 0) {
+                finished.notify_one();
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for(int part = 1; part < threads; part++) {
+        pool.push_back(std::thread(pool_worker, part));
+    }
+
+    while(this->scaler.GetSize() > 0) {
+        // Rodada: próximos eventos em ordem de tempo
+        chunk.clear();
+        while((int)chunk.size() < EVENT_CHUNK && this->scaler.GetSize() > 0) {
+            chunk.push_back(this->scaler.GetNextEvent());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            round++;
+            pending = threads - 1;
+        }
+        wake.notify_all();
+        worker(0);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [&]() { return pending == 0; });
+        }
+
+        // Consolidação na ordem dos eventos
+        for(size_t i = 0; i < chunk.size(); i++) {
+            this->global_time = chunk[i].GetTime();
+            this->extra_mem_usage += Event::GetMemoryUsage();
+            if(chunk[i].GetType() == EventType::RIDESTART) {
+                this->started_rides++;
+                CheckServiceLevel(chunk[i].GetID());
+            }
+            else if(chunk[i].GetType() == EventType::RIDEEND) {
+                this->finished_rides++;
+                out << lines[i];
+                if(this->stats != nullptr) {
+                    this->stats->Add(*this->rides[chunk[i].GetID()]);
+                }
+                if(this->segment_index != nullptr) {
+                    this->segment_index->AddRide(chunk[i].GetID(), *this->rides[chunk[i].GetID()], this->veh_speed);
+                }
+            }
+            TickSnapshot();
+        }
+        UpdateMemory();
+        out.flush();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    wake.notify_all();
+    for(size_t i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+    if(this->snapshots != nullptr) {
+        PublishSnapshot();
+    }
+}
+
+// SetEventThreads: quantidade de threads de StartSimulation (1 mantém o laço serial)
+void Manager::SetEventThreads(int threads) {
+    this->event_threads = threads < 1 ? 1 : threads;
+}
+
+// AddServiceClass (pré-simulação): a classe agrupa só as próprias demandas, com os critérios passados; sem SLA e com
+// prioridade 0 até SetServiceLevel. Deve ser chamada antes da primeira demanda e de qualquer cancelamento ou atraso
+int Manager::AddServiceClass(int eta, double delta, double alpha, double beta, float lambda) {
+    if(this->demand_count > 0 || this->scaler.GetSize() > 0) {
+        throw std::logic_error("Service classes must be added before the first demand.");
+    }
+    if(this->batch != nullptr || this->recording) {
+        throw std::logic_error("Service classes are not supported with batch mode or incremental reruns.");
+    }
+    ServiceClass added = {eta, delta, alpha, beta, lambda, INFINITY, -1, 0};
+    this->classes.push_back(added);
+    this->scaler.AddClass(0);
+    return this->classes.size() - 1;
+}
+
+// SetServiceLevel: max_wait vale para a espera prevista de cada passageiro até a coleta, conferida no início da corrida
+void Manager::SetServiceLevel(int service_class, double max_wait, int priority) {
+    this->classes.at(service_class).max_wait = max_wait;
+    this->scaler.SetPriority(service_class, priority);
+}
+
+int Manager::GetClassAmount() {
+    return this->classes.size();
+}
+
+int Manager::GetRideClass(int ride) {
+    return this->classes.size() == 1 ? 0 : this->ride_classes[ride];
+}
+
+int Manager::GetSlaBreaches(int service_class) {
+    return this->classes.at(service_class).sla_breaches;
+}
+
+// CheckServiceLevel (durante simulação): conta a corrida que começa se algum passageiro esperar mais que o SLA da classe
+void Manager::CheckServiceLevel(int index_ride) {
+    ServiceClass& service = this->classes[GetRideClass(index_ride)];
+    if(service.max_wait < INFINITY && this->rides[index_ride]->MaxWait(this->veh_speed) > service.max_wait) {
+        service.sla_breaches++;
+    }
+}
+
+// SetSnapshotBoard: publica um retrato imediatamente e, durante a simulação, a cada events eventos ou a cada milliseconds ms.
+// O relógio só é consultado a cada SNAPSHOT_CLOCK_EVENTS eventos, para não pesar no laço de eventos (nullptr desativa)
+void Manager::SetSnapshotBoard(SnapshotBoard* board, int events, double milliseconds) {
+    this->snapshots = board;
+    this->snapshot_period = events < 1 ? 1 : events;
+    this->snapshot_interval = milliseconds > 0 ? milliseconds : 0;
+    if(board != nullptr) {
+        PublishSnapshot();
+    }
+}
+
+// TickSnapshot (durante simulação): chamado uma vez por evento processado
+void Manager::TickSnapshot() {
+    if(this->snapshots == nullptr) {
+        return;
+    }
+    this->snapshot_events++;
+    if(this->snapshot_events >= this->snapshot_period) {
+        PublishSnapshot();
+    }
+    else if(this->snapshot_interval > 0 && this->snapshot_events % SNAPSHOT_CLOCK_EVENTS == 0) {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - this->snapshot_clock;
+        if(elapsed.count() >= this->snapshot_interval) {
+            PublishSnapshot();
+        }
+    }
+}
+
+// PublishSnapshot: monta o retrato com os contadores atuais e o publica no quadro
+void Manager::PublishSnapshot() {
+    SimSnapshot snapshot;
+    snapshot.version = ++this->snapshot_version;
+    snapshot.global_time = this->global_time;
+    snapshot.demands = this->demand_count;
+    snapshot.groups = this->group_count;
+    snapshot.rides = this->ride_count;
+    snapshot.waiting_rides = this->scheduled ? this->ride_count - this->started_rides - this->cancelled_rides : this->ride_count;
+    snapshot.active_rides = this->started_rides - this->finished_rides;
+    snapshot.finished_rides = this->finished_rides;
+    snapshot.cancelled_rides = this->cancelled_rides;
+    snapshot.pending_events = this->scaler.GetSize();
+    snapshot.memory = this->extra_mem_usage;
+    snapshot.max_memory = this->max_extra_mem_usage;
+    this->snapshots->Publish(snapshot);
+
+    this->snapshot_events = 0;
+    if(this->snapshot_interval > 0) {
+        this->snapshot_clock = std::chrono::steady_clock::now();
+    }
+}
+
+// NextFinishedRide (durante simulação): processa eventos até a conclusão de uma corrida e retorna seu índice, ou -1 quando não há mais eventos. Na primeira chamada, fecha as demandas pendentes e agenda as corridas
+int Manager::NextFinishedRide() {
+    if(!this->scheduled) {
+        CloseDemands();
+        ScheduleRides();
+        this->scheduled = true;
+    }
+
     while(1) {
         try {
             // Recuperação do evento
@@ -214,7 +826,7 @@ void Manager::StartSimulation(std::ostream& out) {
             this->global_time = ev.GetTime();
 
             // Atualização da memória
-            this->extra_mem_usage += ev.GetMemoryUsage();
+            this->extra_mem_usage += Event::GetMemoryUsage();
             UpdateMemory();
 
             // Processamento do evento
@@ -224,34 +836,358 @@ void Manager::StartSimulation(std::ostream& out) {
                     int index_ride = ev.GetID();
                     Ride* ride = this->rides[index_ride];
                     ride->Start();
+                    this->started_rides++;
+                    CheckServiceLevel(index_ride);
+
+                    // Registro de paradas: só a próxima parada de cada corrida fica agendada; a última é visitada no RIDEEND
+                    if(this->stop_out != nullptr) {
+                        VisitStop(index_ride);
+                        if(ride->GetRemainingStops() > 1) {
+                            this->stop_handles[index_ride] = this->scaler.ScheduleEvent(GetRideClass(index_ride), index_ride, ride->NextStopTime(this->veh_speed), EventType::RIDESTOP);
+                        }
+                    }
+
+                    break;
+                }
+
+                case EventType::RIDESTOP: {
+                    // A parada pode já ter sido visitada pelo RIDEEND se o último trecho tiver comprimento zero
+                    int index_ride = ev.GetID();
+                    Ride* ride = this->rides[index_ride];
+                    if(ride->GetRemainingStops() == 0) {
+                        break;
+                    }
+
+                    VisitStop(index_ride);
+                    if(ride->GetRemainingStops() > 1) {
+                        this->stop_handles[index_ride] = this->scaler.ScheduleEvent(GetRideClass(index_ride), index_ride, ride->NextStopTime(this->veh_speed), EventType::RIDESTOP);
+                    }
 
                     break;
                 }
 
+                case EventType::DEMANDCANCEL: {
+                    ApplyCancel(ev.GetID());
+                    break;
+                }
+
+                case EventType::RIDEDELAY: {
+                    ApplyDelay(ev.GetID());
+                    break;
+                }
+
                 case EventType::RIDEEND: {
                     // Recuperação da corrida associada ao evento
                     int index_ride = ev.GetID();
                     Ride* ride = this->rides[index_ride];
+                    if(this->stop_out != nullptr) {
+                        while(ride->GetRemainingStops() > 0) {
+                            VisitStop(index_ride);
+                        }
+                    }
                     ride->MarkDone();
 
-                    // Imprimindo status da corrida
-                    out << ride->GetEnd()
-                        << " "
-                        << ride->GetDistance()
-                        << " "
-                        << ride->GetStopAmount();
-                    ride->PrintStops(out);
-                    out << std::endl;
+                    if(this->stats != nullptr) {
+                        this->stats->Add(*ride);
+                    }
+                    if(this->segment_index != nullptr) {
+                        this->segment_index->AddRide(index_ride, *ride, this->veh_speed);
+                    }
 
-                    break;
+                    this->finished_rides++;
+                    TickSnapshot();
+                    return index_ride;
                 }
             }
+            TickSnapshot();
         }
         catch(const std::runtime_error& e) {
-            // Fim dos eventos
-            return;
+            // Fim dos eventos: o último retrato mostra o estado final
+            if(this->snapshots != nullptr) {
+                PublishSnapshot();
+            }
+            return -1;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------
+// RE-SIMULAÇÃO INCREMENTAL
+//-------------------------------------------------------------------------------
+
+// EnableResimulation: passa a guardar, para cada demanda, a eficiência avaliada na checagem de lambda (chamar antes da primeira demanda)
+void Manager::EnableResimulation() {
+    this->recording = true;
+}
+
+// ResetSimulation: descarta eventos pendentes e volta as corridas ao estado inicial, para que a próxima simulação comece do zero
+void Manager::ResetSimulation() {
+    this->scaler.Clear();
+    for(int i = 0; i < this->ride_count; i++) {
+        this->rides[i]->Reset();
+    }
+    this->global_time = 0;
+    this->scheduled = false;
+    this->ride_index_ready = false;
+    this->started_rides = 0;
+    this->finished_rides = 0;
+    this->cancelled_rides = 0;
+    for(size_t c = 0; c < this->classes.size(); c++) {
+        this->classes[c].sla_breaches = 0;
+    }
+}
+
+// ChangeSpeed: gamma não participa do agrupamento; só as durações e os eventos mudam
+void Manager::ChangeSpeed(double gamma) {
+    if(!this->changes.empty()) {
+        throw std::logic_error("Reruns are not supported with cancellations or delays.");
+    }
+    this->veh_speed = gamma;
+    for(int i = 0; i < this->ride_count; i++) {
+        this->rides[i]->CalculateDuration(gamma);
+    }
+    ResetSimulation();
+}
+
+// ChangeMinEfficiency: refaz o agrupamento somente onde alguma checagem de eficiência muda de resultado com o novo lambda.
+// Como os grupos são trechos contíguos das demandas, um grupo sem checagem invertida é reaproveitado (com sua corrida) e,
+// a partir de uma inversão, as demandas são reprocessadas até um grupo novo começar na mesma demanda que um grupo da
+// execução base: daí em diante o estado é idêntico e os grupos base voltam a ser reaproveitados. Retorna quantas demandas
+// foram reprocessadas
+int Manager::ChangeMinEfficiency(float lambda) {
+    if(this->batch != nullptr) {
+        throw std::logic_error("Incremental lambda change is not supported in batch mode.");
+    }
+    if(!this->changes.empty()) {
+        throw std::logic_error("Reruns are not supported with cancellations or delays.");
+    }
+    if(!this->recording) {
+        throw std::logic_error("Resimulation was not enabled before the demands.");
+    }
+    if(this->classes.size() > 1) {
+        throw std::logic_error("Incremental lambda change is not supported with service classes.");
+    }
+
+    float old_lambda = this->min_efficiency;
+    this->min_efficiency = lambda;
+    this->classes[0].lambda = lambda;
+    ResetSimulation();
+    if(this->demand_count == 0) {
+        return 0;
+    }
+
+    // Execução base: demandas em ordem (concatenação dos grupos), início de cada grupo e registros
+    int old_group_count = this->group_count;
+    int old_ride_count = this->ride_count;
+    DemandGroup** old_groups = this->demand_groups;
+    Ride** old_rides = this->rides;
+    std::vector<Demand> demands;
+    std::vector<int> starts(old_group_count + 1);
+    for(int g = 0; g < old_group_count; g++) {
+        starts[g] = demands.size();
+        for(int i = 0; i < old_groups[g]->Size(); i++) {
+            demands.push_back(*old_groups[g]->Get(i));
         }
     }
+    int amount = demands.size();
+    starts[old_group_count] = amount;
+    std::vector<int> group_at(amount, -1);
+    for(int g = 0; g < old_group_count; g++) {
+        group_at[starts[g]] = g;
+    }
+    std::vector<char> old_checked;
+    std::vector<double> old_efficiency;
+    std::vector<int> old_group_rides;
+    old_checked.swap(this->checked);
+    old_efficiency.swap(this->checked_efficiency);
+    old_group_rides.swap(this->group_rides);
+    old_group_rides.resize(old_group_count, -1);
+    std::vector<char> group_kept(old_group_count, 0);
+    std::vector<char> ride_kept(old_ride_count, 0);
+
+    // Novo estado, preenchido grupo a grupo
+    this->demand_groups = new DemandGroup*[this->slot_capacity];
+    this->rides = new Ride*[this->slot_capacity];
+    for(int i = 0; i < this->slot_capacity; i++) {
+        this->demand_groups[i] = nullptr;
+        this->rides[i] = nullptr;
+    }
+    this->group_count = 0;
+    this->ride_count = 0;
+    this->demand_count = 0;
+    this->demand_amount = amount;
+
+    int regrouped = 0;
+    bool opened = false;    // Marca se o grupo mais recente já foi aberto pelo reprocessamento com a primeira demanda do grupo base g
+    int g = 0;
+    while(g < old_group_count) {
+        int s = starts[g];
+        int e = starts[g + 1];
+
+        // Inversão em alguma checagem contra o grupo g (inclusive a da demanda que abriu o grupo seguinte)
+        bool flipped = false;
+        for(int k = s + 1; k <= e && k < amount && !flipped; k++) {
+            flipped = old_checked[k] && ((old_efficiency[k] < old_lambda) != (old_efficiency[k] < lambda));
+        }
+
+        if(!flipped) {
+            // Reaproveitamento do grupo base (substitui o grupo aberto pelo reprocessamento, se houver)
+            if(opened) {
+                delete this->demand_groups[this->group_count - 1];
+                this->demand_groups[this->group_count - 1] = old_groups[g];
+            }
+            else {
+                GrowSlots(this->group_count + 1);
+                this->demand_groups[this->group_count++] = old_groups[g];
+            }
+            group_kept[g] = 1;
+            for(int k = opened ? s + 1 : s; k < e; k++) {
+                this->checked.push_back(old_checked[k]);
+                this->checked_efficiency.push_back(old_efficiency[k]);
+                this->demand_count++;
+            }
+            opened = false;
+
+            // A corrida base continua válida se sua eficiência também atingir o novo lambda
+            int r = old_group_rides[g];
+            if(r >= 0 && !(old_rides[r]->GetEfficiency() < lambda)) {
+                GrowSlots(this->ride_count + 1);
+                this->rides[this->ride_count] = old_rides[r];
+                ride_kept[r] = 1;
+                RecordRide(this->ride_count);
+                this->ride_count++;
+            }
+            else {
+                MakeRide(this->demand_groups[this->group_count - 1]);
+            }
+            g++;
+            continue;
+        }
+
+        // Reprocessamento a partir da primeira demanda do grupo g
+        if(!opened) {
+            CreateDemandGroup()->Insert(demands[s]);
+            this->checked.push_back(old_checked[s]);
+            this->checked_efficiency.push_back(old_efficiency[s]);
+            this->demand_count++;
+        }
+        opened = false;
+        g = old_group_count;
+        for(int k = s + 1; k < amount; k++) {
+            int groups_before = this->group_count;
+            ProcessDemand(demands[k]);
+            regrouped++;
+
+            // Ressincronização: um grupo novo começando junto com um grupo base (que não seja o último)
+            if(this->group_count > groups_before && group_at[k] >= 0 && k + 1 < amount) {
+                g = group_at[k];
+                opened = true;
+                break;
+            }
+        }
+    }
+
+    // Objetos base que não foram reaproveitados
+    for(int i = 0; i < old_group_count; i++) {
+        if(!group_kept[i]) {
+            delete old_groups[i];
+        }
+    }
+    for(int i = 0; i < old_ride_count; i++) {
+        if(!ride_kept[i]) {
+            delete old_rides[i];
+        }
+    }
+    delete[] old_groups;
+    delete[] old_rides;
+
+    return regrouped;
+}
+
+// GetRide: corrida pelo índice retornado por NextFinishedRide
+Ride* Manager::GetRide(int index) {
+    if(index < 0 || index >= this->ride_count) {
+        throw std::out_of_range("Manager: inaccessible ride");
+    }
+    return this->rides[index];
+}
+
+// CancelDemand: o pedido vira um evento DEMANDCANCEL, processado na ordem do tempo junto com os eventos das corridas
+void Manager::CancelDemand(int demand_id, double time) {
+    RideChange change;
+    change.target = demand_id;
+    change.delay = 0;
+    this->changes.push_back(change);
+    if(this->trace != nullptr) {
+        this->trace->LogChange(this->changes.size() - 1, demand_id, time, EventType::DEMANDCANCEL);
+    }
+    this->scaler.ScheduleEvent(0, this->changes.size() - 1, time, EventType::DEMANDCANCEL);
+}
+
+// DelayRide: atrasos negativos adiantariam eventos para antes do tempo atual da simulação e são recusados
+void Manager::DelayRide(int ride, double time, double delay) {
+    if(!(delay >= 0)) {
+        throw std::invalid_argument("Manager: ride delays can't be negative.");
+    }
+    RideChange change;
+    change.target = ride;
+    change.delay = delay;
+    this->changes.push_back(change);
+    if(this->trace != nullptr) {
+        this->trace->LogChange(this->changes.size() - 1, ride, time, EventType::RIDEDELAY);
+    }
+    this->scaler.ScheduleEvent(0, this->changes.size() - 1, time, EventType::RIDEDELAY);
+}
+
+int Manager::GetLateChanges() {
+    return this->late_changes;
+}
+
+// GetRideIndex: fecha as demandas pendentes (como no início da simulação) e reconstrói o índice se alguma corrida ou duração mudou
+RideIndex& Manager::GetRideIndex() {
+    if(!this->ride_index_ready) {
+        CloseDemands();
+        this->ride_index.Clear();
+        for(int i = 0; i < this->ride_count; i++) {
+            if(this->rides[i]->IsCancelled()) {
+                continue;
+            }
+            this->ride_index.Add(i, this->rides[i]->GetStart(), this->rides[i]->GetEnd());
+        }
+        this->ride_index.Build();
+        this->ride_index_ready = true;
+    }
+    return this->ride_index;
+}
+
+// SetTraceLog: passa a registrar no trace as decisões de agrupamento, as corridas e os eventos do escalonador
+void Manager::SetTraceLog(TraceLog* trace) {
+    this->trace = trace;
+    this->scaler.SetTraceLog(trace);
+}
+
+// SetStopLog: com a saída passada, cada corrida tem no máximo um RIDESTOP pendente (o da sua próxima parada)
+void Manager::SetStopLog(std::ostream* out) {
+    this->stop_out = out;
+}
+
+// EnableBatchMode: janela de no máximo min(delta, max_delay) resolvida com threads de trabalho
+void Manager::EnableBatchMode(double max_delay, int threads) {
+    if(this->classes.size() > 1) {
+        throw std::logic_error("Batch mode is not supported with service classes.");
+    }
+    delete this->batch;
+    this->batch = new BatchGrouper(this->veh_capacity, this->delta, this->origin_max_distance, this->destin_max_distance, this->min_efficiency, max_delay, threads);
+}
+
+// SetRideStats: passa a alimentar o agregador passado a cada RIDEEND
+void Manager::SetRideStats(RideStats* stats) {
+    this->stats = stats;
+}
+
+// SetSegmentIndex: os trechos entram na ordem de conclusão das corridas
+void Manager::SetSegmentIndex(SegmentIndex* index) {
+    this->segment_index = index;
 }
 
 //-------------------------------------------------------------------------------
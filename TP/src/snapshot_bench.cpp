@@ -0,0 +1,131 @@
+#include <atomic>
+#include <cstring>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <time.h>
+#include "simulation_manager.hpp"
+
+// Ferramenta de medição: custo dos retratos (SetSnapshotBoard) para a thread da simulação, com 0, 1 e 16 leitores
+// lendo o quadro sem parar. A entrada (mesmo formato de tp2.out) é lida para a memória e simulada uma vez sem retratos
+// e uma vez para cada quantidade de leitores; só o laço de eventos é medido, em tempo de CPU da thread da simulação
+// (com menos núcleos que leitores, o tempo de parede mediria a divisão do processador, não o custo). Cada linha é
+// "leitores segundos custo publicações leituras", com o custo relativo à execução sem retratos ("off").
+// Uso: snapshot_bench.out [-e eventos] [-i ms] [-r leitores]... < entrada
+
+// Entrada lida para a memória, em colunas
+struct Input {
+    int eta;
+    double gamma, delta, alpha, beta;
+    float lambda;
+    std::vector<int> ids;
+    std::vector<double> times, ox, oy, dx, dy;
+};
+
+// ThreadSeconds: tempo de CPU da thread atual
+static double ThreadSeconds() {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec*1e-9;
+}
+
+// Simulate: executa a simulação completa e retorna os segundos de CPU gastos no laço de eventos
+static double Simulate(Input& input, SnapshotBoard* board, int events, double milliseconds) {
+    Manager manager(input.eta, input.gamma, input.delta, input.alpha, input.beta, input.lambda, input.ids.size());
+    manager.MakeDemands(input.ids.size(), input.ids.data(), input.times.data(), input.ox.data(), input.oy.data(),
+                        input.dx.data(), input.dy.data());
+    if(board != nullptr) {
+        manager.SetSnapshotBoard(board, events, milliseconds);
+    }
+
+    double start = ThreadSeconds();
+    while(manager.NextFinishedRide() >= 0) {
+    }
+    return ThreadSeconds() - start;
+}
+
+int main(int argc, char* argv[]) {
+    int events = 1024;
+    double milliseconds = 0;
+    std::vector<int> reader_counts;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            events = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            milliseconds = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            reader_counts.push_back(atoi(argv[++i]));
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-e events] [-i milliseconds] [-r readers]..." << std::endl;
+            return 1;
+        }
+    }
+    if(reader_counts.empty()) {
+        reader_counts = {0, 1, 16};
+    }
+
+    Input input;
+    int amount;
+    std::cin >> input.eta >> input.gamma >> input.delta >> input.alpha >> input.beta >> input.lambda >> amount;
+    for(int i = 0; i < amount; i++) {
+        int id;
+        double time, ox, oy, dx, dy;
+        std::cin >> id >> time >> ox >> oy >> dx >> dy;
+        input.ids.push_back(id);
+        input.times.push_back(time);
+        input.ox.push_back(ox);
+        input.oy.push_back(oy);
+        input.dx.push_back(dx);
+        input.dy.push_back(dy);
+    }
+
+    std::cout << std::fixed;
+    std::cout << "readers seconds cost publications reads" << std::endl;
+    double base = Simulate(input, nullptr, events, milliseconds);
+    std::cout << "off " << std::setprecision(4) << base << " 0.00% 0 0" << std::endl;
+
+    for(size_t r = 0; r < reader_counts.size(); r++) {
+        // Leitores: leem sem parar e conferem que as versões nunca voltam
+        SnapshotBoard board;
+        std::atomic<bool> done(false);
+        std::atomic<long> reads(0);
+        std::atomic<bool> consistent(true);
+        std::vector<std::thread> readers;
+        for(int k = 0; k < reader_counts[r]; k++) {
+            readers.push_back(std::thread([&]() {
+                SimSnapshot snapshot;
+                uint64_t last = 0;
+                long local = 0;
+                while(!done.load(std::memory_order_relaxed)) {
+                    if(board.Read(snapshot)) {
+                        if(snapshot.version < last || snapshot.finished_rides > snapshot.rides) {
+                            consistent.store(false);
+                        }
+                        last = snapshot.version;
+                        local++;
+                    }
+                }
+                reads.fetch_add(local);
+            }));
+        }
+
+        double seconds = Simulate(input, &board, events, milliseconds);
+        done.store(true);
+        for(size_t k = 0; k < readers.size(); k++) {
+            readers[k].join();
+        }
+
+        SimSnapshot last;
+        board.Read(last);
+        std::cout << reader_counts[r] << " " << std::setprecision(4) << seconds << " "
+                  << std::setprecision(2) << (seconds/base - 1)*100 << "% " << last.version << " " << reads.load() << std::endl;
+        if(!consistent.load()) {
+            std::cerr << "Inconsistent snapshot read with " << reader_counts[r] << " readers." << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
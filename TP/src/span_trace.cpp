@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include "span_trace.hpp"
+
+std::atomic<SpanTrace*> SpanTrace::active(nullptr);
+std::atomic<int> SpanTrace::serials(0);
+
+// Estado da thread atual; owner diferente do serial do trace ativo indica buffer de outra instância (ou nenhum).
+// A referência ao buffer mantém ele vivo até a thread devolvê-lo, ao terminar ou ao trocar de trace
+struct ThreadSlot {
+    SpanTrace::ThreadState state;
+    std::shared_ptr<SpanBuffer> held;
+
+    ~ThreadSlot() {
+        if(this->held) {
+            this->held->Release();
+        }
+    }
+};
+static thread_local ThreadSlot thread_slot = {{-1, nullptr, 0, 0, false}, nullptr};
+
+//-------------------------------------------------------------------------------
+// BUFFER CIRCULAR
+//-------------------------------------------------------------------------------
+
+SpanBuffer::SpanBuffer(int thread, size_t capacity) : head(0), released(false) {
+    size_t size = 1;
+    while(size < capacity) {
+        size <<= 1;
+    }
+    this->slots.resize(size);
+    this->mask = size - 1;
+    this->thread = thread;
+}
+
+// Push: escreve no slot e só então publica a nova posição
+void SpanBuffer::Push(const SpanRecord& record) {
+    uint64_t position = this->head.load(std::memory_order_relaxed);
+    this->slots[position & this->mask] = record;
+    this->head.store(position + 1, std::memory_order_release);
+}
+
+// Collect: os últimos slots.size() spans publicados, do mais antigo ao mais recente
+// Feito depois que os spans da thread terminaram (ver SpanTrace::Write)
+uint64_t SpanBuffer::Collect(std::vector<SpanRecord>& out) {
+    uint64_t end = this->head.load(std::memory_order_acquire);
+    uint64_t begin = end > this->slots.size() ? end - this->slots.size() : 0;
+    for(uint64_t i = begin; i < end; i++) {
+        out.push_back(this->slots[i & this->mask]);
+    }
+    return begin;
+}
+
+// Release: os spans já publicados continuam no buffer (a próxima dona escreve em seguida)
+void SpanBuffer::Release() {
+    this->released.store(true, std::memory_order_release);
+}
+
+bool SpanBuffer::Acquire() {
+    bool expected = true;
+    return this->released.compare_exchange_strong(expected, false, std::memory_order_acquire);
+}
+
+int SpanBuffer::GetThread() {
+    return this->thread;
+}
+
+//-------------------------------------------------------------------------------
+// CONSTRUTOR E DESTRUTOR
+//-------------------------------------------------------------------------------
+
+SpanTrace::SpanTrace(const std::string& path, int sample_period, size_t buffer_capacity) {
+    this->path = path;
+    this->sample_period = std::max(sample_period, 1);
+    this->buffer_capacity = std::max<size_t>(buffer_capacity, 1);
+    this->serial = serials.fetch_add(1);
+    this->origin = std::chrono::steady_clock::now();
+}
+
+SpanTrace::~SpanTrace() {
+    SpanTrace* self = this;
+    active.compare_exchange_strong(self, nullptr);
+}
+
+//-------------------------------------------------------------------------------
+// REGISTRO
+//-------------------------------------------------------------------------------
+
+void SpanTrace::Start(SpanTrace* trace) {
+    active.store(trace, std::memory_order_release);
+}
+
+// State: na primeira vez que uma thread registra um span neste trace, assume o buffer de uma thread que já terminou
+// ou, se não houver, cria um
+SpanTrace::ThreadState& SpanTrace::State() {
+    ThreadSlot& slot = thread_slot;
+    SpanTrace::ThreadState& state = slot.state;
+    if(state.owner != this->serial) {
+        if(slot.held) {
+            slot.held->Release();
+        }
+        std::lock_guard<std::mutex> guard(this->lock);
+        slot.held = nullptr;
+        for(size_t i = 0; i < this->buffers.size() && !slot.held; i++) {
+            if(this->buffers[i]->Acquire()) {
+                slot.held = this->buffers[i];
+            }
+        }
+        if(!slot.held) {
+            this->buffers.push_back(std::make_shared<SpanBuffer>(this->buffers.size(), this->buffer_capacity));
+            slot.held = this->buffers.back();
+        }
+        state.owner = this->serial;
+        state.buffer = slot.held.get();
+        state.countdown = 1;
+        state.sampled_depth = 0;
+        state.sampled_on = false;
+    }
+    return state;
+}
+
+uint64_t SpanTrace::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->origin).count();
+}
+
+int SpanTrace::GetSamplePeriod() {
+    return this->sample_period;
+}
+
+// Begin: decide se o span é registrado (fases sempre; amostrados pelo contador da thread ou pelo span que os contém)
+void TraceSpan::Begin(SpanTrace* trace) {
+    this->state = &trace->State();
+    bool recorded = true;
+    if(this->kind == SpanKind::SAMPLED) {
+        if(this->state->sampled_depth == 0) {
+            if(--this->state->countdown == 0) {
+                this->state->countdown = trace->GetSamplePeriod();
+                this->state->sampled_on = true;
+            }
+            else {
+                this->state->sampled_on = false;
+            }
+        }
+        this->state->sampled_depth++;
+        recorded = this->state->sampled_on;
+    }
+    if(recorded) {
+        this->trace = trace;
+        this->record.start = trace->Now();
+    }
+}
+
+void TraceSpan::End() {
+    if(this->trace != nullptr) {
+        this->record.duration = this->trace->Now() - this->record.start;
+        this->state->buffer->Push(this->record);
+    }
+    if(this->kind == SpanKind::SAMPLED) {
+        this->state->sampled_depth--;
+    }
+}
+
+//-------------------------------------------------------------------------------
+// ESCRITA
+//-------------------------------------------------------------------------------
+
+// Write: eventos "X" (início e duração em microssegundos) por thread, precedidos do nome de cada thread.
+// Deve ser chamado depois que as threads de trabalho terminaram seus spans (a thread principal pode continuar)
+void SpanTrace::Write() {
+    std::ofstream file(this->path);
+    if(!file) {
+        throw std::runtime_error("SpanTrace: can't open " + this->path);
+    }
+
+    std::lock_guard<std::mutex> guard(this->lock);
+    std::vector<std::vector<SpanRecord> > spans(this->buffers.size());
+    uint64_t dropped = 0;
+    for(size_t i = 0; i < this->buffers.size(); i++) {
+        dropped += this->buffers[i]->Collect(spans[i]);
+    }
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"sample_period\":" << this->sample_period
+         << ",\"dropped_spans\":" << dropped << "},\"traceEvents\":[";
+    bool first = true;
+    for(size_t i = 0; i < this->buffers.size(); i++) {
+        int thread = this->buffers[i]->GetThread();
+        file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread
+             << ",\"args\":{\"name\":\"";
+        if(thread == 0) {
+            file << "main";
+        }
+        else {
+            file << "worker " << thread;
+        }
+        file << "\"}}";
+        first = false;
+
+        for(size_t k = 0; k < spans[i].size(); k++) {
+            SpanRecord& span = spans[i][k];
+            file << ",\n{\"name\":\"" << span.name << "\",\"cat\":\"dispatch\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+                 << ",\"ts\":" << span.start/1000.0 << ",\"dur\":" << span.duration/1000.0;
+            if(span.arg_name != nullptr) {
+                file << ",\"args\":{\"" << span.arg_name << "\":" << span.arg << "}";
+            }
+            file << "}";
+        }
+    }
+    file << "\n]}\n";
+}
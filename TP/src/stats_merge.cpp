@@ -0,0 +1,28 @@
+#include <fstream>
+#include "ride_stats.hpp"
+
+// Ferramenta de combinação: soma os resumos JSON de várias execuções (gerados com -s) em um único resumo
+// Uso: stats_merge.out <resumo> [<resumo> ...] > combinado.json
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <stats_file> [<stats_file> ...]" << std::endl;
+        return 1;
+    }
+
+    RideStats* merged = new RideStats();
+    RideStats* part = new RideStats();
+    for(int i = 1; i < argc; i++) {
+        std::ifstream in(argv[i]);
+        if(!in || !part->ReadJSON(in)) {
+            std::cerr << "Can't read stats: " << argv[i] << std::endl;
+            return 1;
+        }
+        merged->Merge(*part);
+    }
+
+    merged->WriteJSON(std::cout);
+    delete part;
+    delete merged;
+    return 0;
+}
@@ -1,8 +1,16 @@
+#include <type_traits>
 #include "stop.hpp"
 
+static_assert(std::is_trivially_copyable<Stop>::value, "Stop must be trivially copyable");
+
+// CONSTRUTOR PADRÃO: parada de coleta sem demanda associada
+Stop::Stop() : type(StopType::PICKUP), demand_id(-1), request_time(-1), visit_time(-1) { }
+
 // CONSTRUTOR: inicializa a parada com base na demanda e tipo (coleta ou desembarque) passados
-Stop::Stop(Demand& demand, StopType type) {
+Stop::Stop(const Demand& demand, StopType type) {
     this->demand_id = demand.GetID();
+    this->request_time = demand.GetTime();
+    this->visit_time = -1;
 
     switch(type) {
         case StopType::DROPOFF:
@@ -15,26 +23,44 @@ Stop::Stop(Demand& demand, StopType type) {
             this->stop = demand.GetOrigin();
             break;
     }
-
-    this->static_mem_usage = 2*sizeof(int) + sizeof(StopType) + sizeof(Point2D*);
 }
 
 // GetPoint: Retorna referência para o ponto da parada
-Point2D& Stop::GetPoint() {
+const Point2D& Stop::GetPoint() const {
     return this->stop;
 }
 
 // GetType: Retorna o tipo desta parada
-StopType Stop::GetType() {
+StopType Stop::GetType() const {
     return this->type;
 }
 
+// GetDemandID: Retorna o id da demanda associada
+int Stop::GetDemandID() const {
+    return this->demand_id;
+}
+
+// GetRequestTime: Retorna o tempo de solicitação da demanda associada
+double Stop::GetRequestTime() const {
+    return this->request_time;
+}
+
+// MarkVisited: Registra o tempo de chegada do veículo na parada
+void Stop::MarkVisited(double time) {
+    this->visit_time = time;
+}
+
+// GetVisitTime: Retorna o tempo de chegada do veículo na parada
+double Stop::GetVisitTime() const {
+    return this->visit_time;
+}
+
 // Distance: Retorna a distância entre esta parada e outra
-double Stop::Distance(Stop& other) {
+double Stop::Distance(const Stop& other) const {
     return this->stop.Distance(other.GetPoint());
 }
 
-// GetMemoryUsage: Retorna a quantidade de memória usada pelo objeto
+// GetMemoryUsage: Retorna a quantidade de memória usada por uma parada
 int Stop::GetMemoryUsage() {
-    return this->static_mem_usage;
+    return sizeof(Stop);
 }
\ No newline at end of file
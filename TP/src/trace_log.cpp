@@ -0,0 +1,355 @@
+#include <stdexcept>
+#include <cstring>
+#include <iterator>
+#include "trace_log.hpp"
+
+static const char TRACE_MAGIC[8] = {'D', 'S', 'T', 'R', 'A', 'C', 'E', '1'};
+
+//-------------------------------------------------------------------------------
+// CODIFICAÇÃO (VARINT + DELTA)
+//-------------------------------------------------------------------------------
+
+// Escreve um inteiro sem sinal em varint (7 bits por byte, bit mais alto indica continuação)
+static void PutVarint(uint64_t value, std::vector<unsigned char>& out) {
+    while(value >= 0x80) {
+        out.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((unsigned char)value);
+}
+
+// Lê um varint; false caso os dados terminem no meio do número
+static bool GetVarint(const unsigned char*& pos, const unsigned char* end, uint64_t& value) {
+    value = 0;
+    for(int shift = 0; shift < 64; shift += 7) {
+        if(pos == end) {
+            return false;
+        }
+        unsigned char byte = *pos++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Zigzag: diferenças negativas pequenas viram inteiros sem sinal pequenos
+static uint64_t ZigZag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t UnZigZag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static uint64_t TimeBits(double time) {
+    uint64_t bits;
+    memcpy(&bits, &time, sizeof(bits));
+    return bits;
+}
+
+static double BitsTime(uint64_t bits) {
+    double time;
+    memcpy(&time, &bits, sizeof(time));
+    return time;
+}
+
+// Delta de id: diferença para o último valor do mesmo campo
+static void PutDelta(int value, int& last, std::vector<unsigned char>& out) {
+    PutVarint(ZigZag((int64_t)value - last), out);
+    last = value;
+}
+
+static bool GetDelta(const unsigned char*& pos, const unsigned char* end, int& last, int& value) {
+    uint64_t raw;
+    if(!GetVarint(pos, end, raw)) {
+        return false;
+    }
+    value = (int)(last + UnZigZag(raw));
+    last = value;
+    return true;
+}
+
+// Delta de tempo: XOR com os bits do último tempo (tempos próximos compartilham sinal, expoente e mantissa alta)
+static void PutTime(double time, uint64_t& last, std::vector<unsigned char>& out) {
+    uint64_t bits = TimeBits(time);
+    PutVarint(bits ^ last, out);
+    last = bits;
+}
+
+static bool GetTime(const unsigned char*& pos, const unsigned char* end, uint64_t& last, double& time) {
+    uint64_t raw;
+    if(!GetVarint(pos, end, raw)) {
+        return false;
+    }
+    last ^= raw;
+    time = BitsTime(last);
+    return true;
+}
+
+// Encode: formato fixo por tipo de registro
+//   SCHEDULE/NEXTEVENT: tipo, id da corrida, tipo do evento, tempo
+//   decisões:           tipo, id da demanda, grupo, tempo
+//   RIDE:               tipo, id da corrida, grupo, criada, início, fim, quantidade de demandas, ids das demandas
+//   CHANGE:             tipo, id do pedido, alvo, tipo do evento, tempo
+void TraceCodec::Encode(const TraceRecord& record, std::vector<unsigned char>& out) {
+    out.push_back((unsigned char)record.type);
+
+    switch(record.type) {
+        case TraceRecordType::SCHEDULE:
+        case TraceRecordType::NEXTEVENT:
+            PutDelta(record.id, this->last_id, out);
+            out.push_back((unsigned char)record.event_type);
+            PutTime(record.time, this->last_time, out);
+            break;
+
+        case TraceRecordType::RIDE: {
+            PutDelta(record.id, this->last_id, out);
+            PutDelta(record.group, this->last_group, out);
+            out.push_back(record.created ? 1 : 0);
+            PutTime(record.time, this->last_time, out);
+            PutTime(record.end, this->last_time, out);
+            PutVarint(record.demands.size(), out);
+            int last_demand = record.demands.empty() ? 0 : record.demands[0];
+            PutVarint(ZigZag(last_demand), out);
+            for(size_t i = 1; i < record.demands.size(); i++) {
+                PutDelta(record.demands[i], last_demand, out);
+            }
+            break;
+        }
+
+        case TraceRecordType::CHANGE:
+            PutDelta(record.id, this->last_id, out);
+            PutDelta(record.group, this->last_group, out);
+            out.push_back((unsigned char)record.event_type);
+            PutTime(record.time, this->last_time, out);
+            break;
+
+        default:
+            PutDelta(record.id, this->last_id, out);
+            PutDelta(record.group, this->last_group, out);
+            PutTime(record.time, this->last_time, out);
+            break;
+    }
+}
+
+// Decode: inverso de Encode
+bool TraceCodec::Decode(const unsigned char*& pos, const unsigned char* end, TraceRecord& record) {
+    if(pos == end) {
+        return false;
+    }
+    unsigned char type = *pos++;
+    if(type > (unsigned char)TraceRecordType::CHANGE) {
+        throw std::runtime_error("Trace: unknown record type.");
+    }
+    record.type = (TraceRecordType)type;
+    record.group = -1;
+    record.end = 0;
+    record.event_type = EventType::RIDESTART;
+    record.created = false;
+    record.demands.clear();
+
+    switch(record.type) {
+        case TraceRecordType::SCHEDULE:
+        case TraceRecordType::NEXTEVENT:
+            if(!GetDelta(pos, end, this->last_id, record.id) || pos == end) {
+                return false;
+            }
+            record.event_type = (EventType)*pos++;
+            return GetTime(pos, end, this->last_time, record.time);
+
+        case TraceRecordType::RIDE: {
+            if(!GetDelta(pos, end, this->last_id, record.id) || !GetDelta(pos, end, this->last_group, record.group) || pos == end) {
+                return false;
+            }
+            record.created = (*pos++ != 0);
+            uint64_t amount, first;
+            if(!GetTime(pos, end, this->last_time, record.time) || !GetTime(pos, end, this->last_time, record.end)
+                || !GetVarint(pos, end, amount) || !GetVarint(pos, end, first)) {
+                return false;
+            }
+            int last_demand = (int)UnZigZag(first);
+            if(amount > 0) {
+                record.demands.push_back(last_demand);
+            }
+            for(uint64_t i = 1; i < amount; i++) {
+                int demand;
+                if(!GetDelta(pos, end, last_demand, demand)) {
+                    return false;
+                }
+                record.demands.push_back(demand);
+            }
+            return true;
+        }
+
+        case TraceRecordType::CHANGE:
+            if(!GetDelta(pos, end, this->last_id, record.id) || !GetDelta(pos, end, this->last_group, record.group) || pos == end) {
+                return false;
+            }
+            record.event_type = (EventType)*pos++;
+            return GetTime(pos, end, this->last_time, record.time);
+
+        default:
+            return GetDelta(pos, end, this->last_id, record.id)
+                && GetDelta(pos, end, this->last_group, record.group)
+                && GetTime(pos, end, this->last_time, record.time);
+    }
+}
+
+//-------------------------------------------------------------------------------
+// CONSTRUTOR E DESTRUTOR
+//-------------------------------------------------------------------------------
+
+// CONSTRUTOR: abre o arquivo, escreve o cabeçalho e inicia a thread de escrita
+TraceLog::TraceLog(const std::string& path, size_t buffer_size)
+    : file(path.c_str(), std::ios::binary | std::ios::trunc), buffer_size(buffer_size), has_pending(false), closing(false) {
+    if(!this->file) {
+        throw std::runtime_error("Trace: can't open " + path);
+    }
+    this->file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    this->active.reserve(buffer_size + 64);
+    this->pending.reserve(buffer_size + 64);
+    this->flusher = std::thread(&TraceLog::FlusherLoop, this);
+}
+
+// DESTRUTOR: garante que tudo foi escrito
+TraceLog::~TraceLog() {
+    Close();
+}
+
+//-------------------------------------------------------------------------------
+// FUNÇÕES AUXILIARES
+//-------------------------------------------------------------------------------
+
+// FlusherLoop: espera buffers pendentes e escreve-os no arquivo até o fechamento
+void TraceLog::FlusherLoop() {
+    std::unique_lock<std::mutex> guard(this->lock);
+    while(true) {
+        this->cond.wait(guard, [this] { return this->has_pending || this->closing; });
+        if(this->has_pending) {
+            this->file.write((const char*)this->pending.data(), this->pending.size());
+            this->pending.clear();
+            this->has_pending = false;
+            this->cond.notify_all();
+        }
+        else if(this->closing) {
+            return;
+        }
+    }
+}
+
+// HandOff: troca o buffer ativo pelo pendente assim que a thread de escrita liberar o anterior
+void TraceLog::HandOff() {
+    std::unique_lock<std::mutex> guard(this->lock);
+    this->cond.wait(guard, [this] { return !this->has_pending; });
+    this->active.swap(this->pending);
+    this->has_pending = true;
+    this->cond.notify_all();
+}
+
+// Append: codifica o registro e entrega o buffer se estiver cheio
+void TraceLog::Append(TraceRecord& rec) {
+    this->codec.Encode(rec, this->active);
+    if(this->active.size() >= this->buffer_size) {
+        HandOff();
+    }
+}
+
+//-------------------------------------------------------------------------------
+// REGISTRO
+//-------------------------------------------------------------------------------
+
+void TraceLog::LogEvent(TraceRecordType type, int ride_id, double time, EventType event_type) {
+    this->scratch.type = type;
+    this->scratch.id = ride_id;
+    this->scratch.time = time;
+    this->scratch.event_type = event_type;
+    Append(this->scratch);
+}
+
+void TraceLog::LogDecision(TraceRecordType type, int demand_id, int group, double time) {
+    this->scratch.type = type;
+    this->scratch.id = demand_id;
+    this->scratch.group = group;
+    this->scratch.time = time;
+    Append(this->scratch);
+}
+
+void TraceLog::LogRide(int ride_id, int group, bool created, double start, double end, const int* demands, int demand_amount) {
+    this->scratch.type = TraceRecordType::RIDE;
+    this->scratch.id = ride_id;
+    this->scratch.group = group;
+    this->scratch.created = created;
+    this->scratch.time = start;
+    this->scratch.end = end;
+    this->scratch.demands.assign(demands, demands + demand_amount);
+    Append(this->scratch);
+}
+
+void TraceLog::LogChange(int change, int target, double time, EventType event_type) {
+    this->scratch.type = TraceRecordType::CHANGE;
+    this->scratch.id = change;
+    this->scratch.group = target;
+    this->scratch.time = time;
+    this->scratch.event_type = event_type;
+    Append(this->scratch);
+}
+
+// Close: entrega o último buffer, encerra a thread e fecha o arquivo (chamadas repetidas não têm efeito)
+void TraceLog::Close() {
+    if(!this->flusher.joinable()) {
+        return;
+    }
+    if(!this->active.empty()) {
+        HandOff();
+    }
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->closing = true;
+    }
+    this->cond.notify_all();
+    this->flusher.join();
+    this->file.close();
+}
+
+//-------------------------------------------------------------------------------
+// LEITURA
+//-------------------------------------------------------------------------------
+
+// ReadTrace: lê o arquivo inteiro e decodifica todos os registros. Retorna false se o arquivo não for um trace válido
+bool ReadTrace(const std::string& path, std::vector<TraceRecord>& records) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if(!in) {
+        return false;
+    }
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if(data.size() < sizeof(TRACE_MAGIC) || memcmp(data.data(), TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+        return false;
+    }
+
+    TraceCodec codec;
+    TraceRecord record;
+    const unsigned char* pos = data.data() + sizeof(TRACE_MAGIC);
+    const unsigned char* end = data.data() + data.size();
+    while(codec.Decode(pos, end, record)) {
+        records.push_back(record);
+    }
+    return true;
+}
+
+const char* TraceRecordName(TraceRecordType type) {
+    switch(type) {
+        case TraceRecordType::SCHEDULE:         return "SCHEDULE";
+        case TraceRecordType::NEXTEVENT:        return "NEXTEVENT";
+        case TraceRecordType::INSERTED:         return "INSERTED";
+        case TraceRecordType::REJECT_CAPACITY:  return "REJECT_CAPACITY";
+        case TraceRecordType::REJECT_TIME:      return "REJECT_TIME";
+        case TraceRecordType::REJECT_ALPHA:     return "REJECT_ALPHA";
+        case TraceRecordType::REJECT_BETA:      return "REJECT_BETA";
+        case TraceRecordType::REJECT_LAMBDA:    return "REJECT_LAMBDA";
+        case TraceRecordType::RIDE:             return "RIDE";
+        case TraceRecordType::CHANGE:           return "CHANGE";
+    }
+    return "?";
+}
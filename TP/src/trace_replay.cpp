@@ -0,0 +1,163 @@
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include "trace_log.hpp"
+
+// Ferramenta de replay: reconstrói a linha do tempo de decisões a partir de um trace gravado com -t, sem reexecutar a simulação
+// Uso: trace_replay.out <trace> [-r id_corrida] [-d id_demanda]
+// Com filtro, os eventos de cancelamento e atraso (cujo id é o índice do pedido de mudança) entram pelo alvo do pedido,
+// registrado em CHANGE: o cancelamento pela demanda cancelada e o atraso pela corrida atrasada
+
+static const char* EventName(EventType type) {
+    switch(type) {
+        case EventType::RIDESTART: return "RIDESTART";
+        case EventType::RIDEEND: return "RIDEEND";
+        case EventType::RIDESTOP: return "RIDESTOP";
+        case EventType::DEMANDCANCEL: return "DEMANDCANCEL";
+        case EventType::RIDEDELAY: return "RIDEDELAY";
+    }
+    return "?";
+}
+
+// Eventos de pedidos de mudança: o id é o índice do pedido, não uma corrida
+static bool IsChange(EventType type) {
+    return type == EventType::DEMANDCANCEL || type == EventType::RIDEDELAY;
+}
+
+// Imprime um registro em uma linha
+static void PrintRecord(const TraceRecord& rec) {
+    std::cout << TraceRecordName(rec.type);
+    switch(rec.type) {
+        case TraceRecordType::SCHEDULE:
+        case TraceRecordType::NEXTEVENT:
+            std::cout << (IsChange(rec.event_type) ? " change=" : " ride=") << rec.id
+                      << " event=" << EventName(rec.event_type)
+                      << " t=" << rec.time;
+            break;
+
+        case TraceRecordType::CHANGE:
+            std::cout << " change=" << rec.id
+                      << " event=" << EventName(rec.event_type)
+                      << (rec.event_type == EventType::DEMANDCANCEL ? " demand=" : " ride=") << rec.group
+                      << " t=" << rec.time;
+            break;
+
+        case TraceRecordType::RIDE:
+            std::cout << " ride=" << rec.id << " group=" << rec.group
+                      << (rec.created ? " created" : " dropped")
+                      << " start=" << rec.time << " end=" << rec.end << " demands=";
+            for(size_t i = 0; i < rec.demands.size(); i++) {
+                std::cout << (i ? "," : "") << rec.demands[i];
+            }
+            break;
+
+        default:
+            std::cout << " demand=" << rec.id << " group=" << rec.group << " t=" << rec.time;
+            break;
+    }
+    std::cout << std::endl;
+}
+
+static bool IsDecision(const TraceRecord& rec) {
+    return rec.type != TraceRecordType::SCHEDULE && rec.type != TraceRecordType::NEXTEVENT && rec.type != TraceRecordType::RIDE
+        && rec.type != TraceRecordType::CHANGE;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << std::fixed << std::setprecision(2);
+
+    // Opções
+    const char* path = nullptr;
+    int ride_filter = -1;
+    int demand_filter = -1;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            ride_filter = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            demand_filter = atoi(argv[++i]);
+        }
+        else if(path == nullptr) {
+            path = argv[i];
+        }
+        else {
+            path = nullptr;
+            break;
+        }
+    }
+    if(path == nullptr) {
+        std::cerr << "Usage: " << argv[0] << " <trace_file> [-r ride_id] [-d demand_id]" << std::endl;
+        return 1;
+    }
+
+    std::vector<TraceRecord> records;
+    if(!ReadTrace(path, records)) {
+        std::cerr << "Can't read trace: " << path << std::endl;
+        return 1;
+    }
+
+    // Sem filtro: linha do tempo completa
+    if(ride_filter < 0 && demand_filter < 0) {
+        for(size_t i = 0; i < records.size(); i++) {
+            PrintRecord(records[i]);
+        }
+        return 0;
+    }
+
+    // Primeira passada: resolve quais corridas e demandas pertencem ao filtro (corridas criadas e suas demandas) e o alvo
+    // de cada pedido de mudança
+    std::set<int> rides;
+    std::set<int> demands;
+    std::map<int, int> change_targets;
+    for(size_t i = 0; i < records.size(); i++) {
+        const TraceRecord& rec = records[i];
+        if(rec.type == TraceRecordType::CHANGE) {
+            change_targets[rec.id] = rec.group;
+        }
+        if(rec.type != TraceRecordType::RIDE || !rec.created) {
+            continue;
+        }
+
+        bool match = (rec.id == ride_filter);
+        for(size_t j = 0; !match && j < rec.demands.size(); j++) {
+            match = (rec.demands[j] == demand_filter);
+        }
+        if(match) {
+            rides.insert(rec.id);
+            demands.insert(rec.demands.begin(), rec.demands.end());
+        }
+    }
+    if(demand_filter >= 0) {
+        demands.insert(demand_filter);
+    }
+
+    // Segunda passada: imprime os registros relacionados
+    for(size_t i = 0; i < records.size(); i++) {
+        const TraceRecord& rec = records[i];
+        bool related;
+        if(IsDecision(rec)) {
+            related = demands.count(rec.id) > 0;
+        }
+        else if(rec.type == TraceRecordType::RIDE) {
+            related = rec.created && rides.count(rec.id) > 0;
+        }
+        else if(rec.type == TraceRecordType::CHANGE || IsChange(rec.event_type)) {
+            // Pedido sem CHANGE no trace (alvo desconhecido) fica de fora
+            std::map<int, int>::iterator target = change_targets.find(rec.id);
+            related = target != change_targets.end()
+                   && (rec.event_type == EventType::DEMANDCANCEL ? demands.count(target->second) : rides.count(target->second)) > 0;
+        }
+        else {
+            related = rides.count(rec.id) > 0;
+        }
+
+        if(related) {
+            PrintRecord(rec);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include "segment.hpp"
+#include "event.hpp"
+
+// Ferramenta de medição: tamanhos dos tipos de valor e ganho de serem trivialmente copiáveis.
+// Os tamanhos são comparados com réplicas dos leiautes anteriores (ponto, demanda, evento, parada e segmento com a
+// ordem original dos campos e mem_usage em cada objeto). Evento e demanda (com o ponto anterior, de cópia e atribuição
+// definidas fora de linha, como estavam em 2D_point.cpp, event.cpp e demand.cpp) também são medidos em três operações
+// do simulador:
+//   heap:   inserção e retirada de n eventos em um min-heap por tempo (o min-heap do EventScaler);
+//   grow:   crescimento por dobra de um vetor de eventos até n (cópia elemento a elemento contra memcpy);
+//   copy:   cópias repetidas de um vetor de demandas (grupos e janelas de lote guardam cópias).
+// Cada linha de medição é "operação anterior_s atual_s aceleração".
+// Uso: types_bench.out [-n elementos] [-r repeticoes]
+
+// Réplica do evento anterior: id antes do tempo (preenchimento) e mem_usage em cada objeto; construtor e getter também
+// fora de linha, como os de Event continuam em event.cpp
+class LegacyEvent {
+    public:
+        int id;
+        double time;
+        EventType type;
+        int mem_usage;
+
+        LegacyEvent() : id(-1), time(-1), type(EventType::RIDESTART), mem_usage(sizeof(LegacyEvent)) { };
+        __attribute__((noinline)) LegacyEvent(int id, double time, EventType type) : id(id), time(time), type(type), mem_usage(sizeof(LegacyEvent)) { };
+        __attribute__((noinline)) LegacyEvent(const LegacyEvent& other) {
+            this->id = other.id;
+            this->time = other.time;
+            this->type = other.type;
+            this->mem_usage = other.mem_usage;
+        }
+        __attribute__((noinline)) void operator=(const LegacyEvent& other) {
+            this->id = other.id;
+            this->time = other.time;
+            this->type = other.type;
+            this->mem_usage = other.mem_usage;
+        }
+        __attribute__((noinline)) double GetTime() const {
+            return this->time;
+        }
+};
+
+// Réplica do ponto anterior: mesmas coordenadas, com cópia e atribuição definidas fora de linha (como em 2D_point.cpp)
+class LegacyPoint2D {
+    public:
+        coord_t x;
+        coord_t y;
+
+        LegacyPoint2D() : x(0), y(0) { };
+        __attribute__((noinline)) LegacyPoint2D(const LegacyPoint2D& other) {
+            this->x = other.x;
+            this->y = other.y;
+        }
+        __attribute__((noinline)) void operator=(const LegacyPoint2D& other) {
+            this->x = other.x;
+            this->y = other.y;
+        }
+        void Set(const Point2D& point) {
+            memcpy(this, &point, sizeof(LegacyPoint2D));
+        }
+};
+
+// Réplica da demanda original: id antes do tempo (preenchimento), mem_usage no fim e cópia fora de linha
+class LegacyDemand {
+    public:
+        int id;
+        double time;
+        LegacyPoint2D origin;
+        LegacyPoint2D destination;
+        int mem_usage;
+
+        LegacyDemand() : id(-1), time(-1), mem_usage(sizeof(LegacyDemand)) { };
+        __attribute__((noinline)) LegacyDemand(const LegacyDemand& other) {
+            *this = other;
+        }
+        __attribute__((noinline)) LegacyDemand& operator=(const LegacyDemand& other) {
+            this->id = other.id;
+            this->time = other.time;
+            this->origin = other.origin;
+            this->destination = other.destination;
+            this->mem_usage = other.mem_usage;
+            return *this;
+        }
+};
+
+// Réplicas da parada e do segmento anteriores (somente leiaute: tipo no início e static_mem_usage em cada objeto)
+struct LegacyStop {
+    StopType type;
+    int demand_id;
+    double request_time;
+    double visit_time;
+    LegacyPoint2D stop;
+    int static_mem_usage;
+};
+
+struct LegacySegment {
+    SegmentType type;
+    LegacyStop* beg;
+    LegacyStop* end;
+    double total_distance;
+    bool complete;
+    int static_mem_usage;
+};
+
+static double Seconds(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// Heap: n inserções seguidas de n retiradas; retorna a soma dos tempos retirados em checksum
+template<typename E>
+static double Heap(const std::vector<double>& times, int repeats, double& checksum) {
+    auto later = [](const E& a, const E& b) { return a.GetTime() > b.GetTime(); };
+    std::vector<E> heap;
+    heap.reserve(times.size());
+    auto begin = std::chrono::steady_clock::now();
+    for(int r = 0; r < repeats; r++) {
+        for(size_t i = 0; i < times.size(); i++) {
+            heap.push_back(E(i, times[i], EventType::RIDESTART));
+            std::push_heap(heap.begin(), heap.end(), later);
+        }
+        while(!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            checksum += heap.back().GetTime();
+            heap.pop_back();
+        }
+    }
+    return Seconds(begin);
+}
+
+// Grow: dobra o vetor até n elementos, copiando elemento a elemento (anterior) ou em bloco (atual)
+static double GrowLegacy(int amount, int repeats) {
+    auto begin = std::chrono::steady_clock::now();
+    for(int r = 0; r < repeats; r++) {
+        int capacity = 1;
+        LegacyEvent* events = new LegacyEvent[capacity];
+        for(int size = 0; size < amount; size++) {
+            if(size == capacity) {
+                LegacyEvent* grown = new LegacyEvent[2*capacity];
+                for(int i = 0; i < size; i++) {
+                    grown[i] = events[i];
+                }
+                delete[] events;
+                events = grown;
+                capacity *= 2;
+            }
+            events[size] = LegacyEvent(size, size, EventType::RIDEEND);
+        }
+        delete[] events;
+    }
+    return Seconds(begin);
+}
+
+static double GrowCurrent(int amount, int repeats) {
+    auto begin = std::chrono::steady_clock::now();
+    for(int r = 0; r < repeats; r++) {
+        int capacity = 1;
+        Event* events = new Event[capacity];
+        for(int size = 0; size < amount; size++) {
+            if(size == capacity) {
+                Event* grown = new Event[2*capacity];
+                memcpy(grown, events, sizeof(Event)*size);
+                delete[] events;
+                events = grown;
+                capacity *= 2;
+            }
+            events[size] = Event(size, size, EventType::RIDEEND);
+        }
+        delete[] events;
+    }
+    return Seconds(begin);
+}
+
+// Copy: copia o vetor de demandas inteiro repeats vezes
+template<typename D>
+static double Copy(std::vector<D>& source, int repeats) {
+    std::vector<D> target(source.size());
+    auto begin = std::chrono::steady_clock::now();
+    for(int r = 0; r < repeats; r++) {
+        std::copy(source.begin(), source.end(), target.begin());
+        source[r % source.size()] = target[(r + 1) % source.size()];
+    }
+    return Seconds(begin);
+}
+
+static void Report(const char* operation, double legacy, double current) {
+    std::cout << operation << " " << std::setprecision(4) << legacy << " " << current << " "
+              << std::setprecision(2) << legacy/current << "x" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int amount = 1000000;
+    int repeats = 5;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            amount = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repeats = atoi(argv[++i]);
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [-n elements] [-r repeats]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "type legacy current" << std::endl;
+    std::cout << "Point2D " << sizeof(LegacyPoint2D) << " " << sizeof(Point2D) << std::endl;
+    std::cout << "Demand " << sizeof(LegacyDemand) << " " << sizeof(Demand) << std::endl;
+    std::cout << "Event " << sizeof(LegacyEvent) << " " << sizeof(Event) << std::endl;
+    std::cout << "Stop " << sizeof(LegacyStop) << " " << sizeof(Stop) << std::endl;
+    std::cout << "Segment " << sizeof(LegacySegment) << " " << sizeof(Segment) << std::endl;
+    std::cout << std::endl;
+
+    std::mt19937 random(3);
+    std::uniform_real_distribution<double> uniform(0.0, 1e6);
+    std::vector<double> times(amount);
+    for(int i = 0; i < amount; i++) {
+        times[i] = uniform(random);
+    }
+    std::vector<LegacyDemand> legacy_demands(amount);
+    std::vector<Demand> demands(amount);
+    for(int i = 0; i < amount; i++) {
+        demands[i] = Demand(i, times[i], uniform(random), uniform(random), uniform(random), uniform(random));
+        legacy_demands[i].id = i;
+        legacy_demands[i].time = demands[i].GetTime();
+        legacy_demands[i].origin.Set(demands[i].GetOrigin());
+        legacy_demands[i].destination.Set(demands[i].GetDestination());
+    }
+
+    std::cout << std::fixed;
+    std::cout << "operation legacy current speedup" << std::endl;
+    double legacy_sum = 0, current_sum = 0;
+    double legacy = Heap<LegacyEvent>(times, repeats, legacy_sum);
+    double current = Heap<Event>(times, repeats, current_sum);
+    Report("heap", legacy, current);
+    Report("grow", GrowLegacy(amount, repeats), GrowCurrent(amount, repeats));
+    Report("copy", Copy(legacy_demands, 20*repeats), Copy(demands, 20*repeats));
+
+    if(legacy_sum != current_sum) {
+        std::cerr << "Legacy and current heaps diverged." << std::endl;
+        return 1;
+    }
+    return 0;
+}